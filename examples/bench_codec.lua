@@ -0,0 +1,52 @@
+-- Measures the binary en- and decoding of typical service responses.
+-- Usage: uascript bench_codec.lua [iterations]
+local iterations = tonumber(arg and arg[1]) or 200
+local items = 1000
+
+local function bench(name, type, value)
+    local bin = ua.encodeBinary(value)
+    local t = os.clock()
+    for i = 1, iterations do ua.encodeBinary(value) end
+    local enc = (os.clock() - t) / iterations
+    t = os.clock()
+    for i = 1, iterations do ua.decodeBinary(type, bin) end
+    local dec = (os.clock() - t) / iterations
+    print(string.format("%-16s %7d bytes  encode %8.1f us  decode %8.1f us",
+                        name, #bin, enc * 1e6, dec * 1e6))
+end
+
+-- ReadResponse with scalar values
+local results = {}
+for i = 1, items do
+    results[i] = string.format('{"value":{"type":"Double","value":%d.5},' ..
+                               '"sourceTimestamp":"2016-05-01T12:00:00Z"}', i)
+end
+local read = ua.decodeJSON(ua.types.ReadResponse,
+    '{"responseHeader":{"requestHandle":1},"results":[' .. table.concat(results, ",") .. ']}')
+bench("ReadResponse", ua.types.ReadResponse, read)
+
+-- PublishResponse with a DataChangeNotification
+local notifications = {}
+for i = 1, items do
+    notifications[i] = string.format('{"clientHandle":%d,"value":{"value":{"type":"Int32","value":%d},' ..
+                                     '"sourceTimestamp":"2016-05-01T12:00:00Z"}}', i, i)
+end
+local publish = ua.decodeJSON(ua.types.PublishResponse,
+    '{"responseHeader":{"requestHandle":2},"subscriptionId":1,' ..
+    '"availableSequenceNumbers":[1,2,3],"notificationMessage":{"sequenceNumber":1,' ..
+    '"notificationData":[{"typeId":"i=809","body":{"monitoredItems":[' ..
+    table.concat(notifications, ",") .. ']}}]}}')
+bench("PublishResponse", ua.types.PublishResponse, publish)
+
+-- BrowseResponse with many small structures
+local refs = {}
+for i = 1, items do
+    refs[i] = string.format('{"referenceTypeId":"i=35","isForward":true,"nodeId":"ns=1;i=%d",' ..
+                            '"browseName":{"namespaceIndex":1,"name":"Node%d"},' ..
+                            '"displayName":{"locale":"en","text":"Node %d"},"nodeClass":2,' ..
+                            '"typeDefinition":"i=63"}', i, i, i)
+end
+local browse = ua.decodeJSON(ua.types.BrowseResponse,
+    '{"responseHeader":{"requestHandle":3},"results":[{"references":[' ..
+    table.concat(refs, ",") .. ']}]}')
+bench("BrowseResponse", ua.types.BrowseResponse, browse)
@@ -5,22 +5,143 @@
 
 static const struct luaL_Reg uascript_module [] = {
     {"typeof", ua_get_type},
+    {"defineType", ua_definetype},
     {"encodeBinary", ua_encodebinary},
     {"decodeBinary", ua_decodebinary},
-    {"Array", ua_array_new},
+    {"encodeBinaryMany", ua_encodebinary_many},
+    {"Encoder", ua_encoder_new},
+    {"lazyDecoding", ua_lazydecoding},
+    {"encodeJSON", ua_encodejson},
+    {"decodeJSON", ua_decodejson},
     {"Server", ua_server_new},
     {"Client", ua_client_new},
     {"GetEndpoints", ua_client_getendpoints},
+    {"allocatorStats", ua_allocator_stats},
+    {"heapLimit", ua_heap_limit},
+    {"memoryLimit", ua_heap_limit}, /* the former name */
+    {"scope", ua_scope},
+    {"copy", ua_copy},
+    {"tostring", ua_tostring_limited},
+    {"tostringLimits", ua_tostring_limits},
     {NULL, NULL} /* sentinel */
 };
 
-static void addNodeId(lua_State *L, UA_UInt32 identifier, const char *name) {
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = &UA_TYPES[UA_TYPES_NODEID];
-    data->data = UA_NodeId_new();
-    luaL_setmetatable(L, "open62541-data");
-    *((UA_NodeId*)data->data) = UA_NODEID_NUMERIC(0, identifier);
-    lua_setfield(L, -2, name);
+/* ua.nodeIds is filled on first access. The names are those of the UA_NS0ID
+   defines in any case (ua.nodeIds.HasSubtype or ua.nodeIds.HASSUBTYPE) and a
+   few short aliases for the standard folders. */
+static const ua_nodeid_name nodeid_aliases[] = {
+    {"Null", 0}, {"Root", 84}, {"Objects", 85}, {"Types", 86}, {"Views", 87},
+    {"ObjectTypes", 88}, {"VariableTypes", 89}, {"DataTypes", 90},
+    {"ReferenceTypes", 91} };
+
+static int nodeid_compare(const void *key, const void *entry) {
+    return strcmp(key, ((const ua_nodeid_name*)entry)->name);
+}
+
+static const ua_nodeid_name *
+findNodeId(const char *name, size_t len) {
+    for(size_t i = 0; i < sizeof(nodeid_aliases) / sizeof(ua_nodeid_name); i++) {
+        if(strcmp(nodeid_aliases[i].name, name) == 0)
+            return &nodeid_aliases[i];
+    }
+    char upper[128];
+    if(len >= sizeof(upper))
+        return NULL;
+    for(size_t i = 0; i <= len; i++)
+        upper[i] = (char)toupper((unsigned char)name[i]);
+    return bsearch(upper, ua_nodeid_names, ua_nodeid_namesSize,
+                   sizeof(ua_nodeid_name), nodeid_compare);
+}
+
+/* The constants are cached in the table and allocated on the heap also
+   inside a ua.scope */
+static int ua_nodeids_index(lua_State *L) {
+    size_t len;
+    const char *name = lua_tolstring(L, 2, &len);
+    const ua_nodeid_name *entry = NULL;
+    if(lua_type(L, 2) == LUA_TSTRING)
+        entry = findNodeId(name, len);
+    if(!entry) {
+        lua_pushnil(L);
+        return 1;
+    }
+    ua_arena *arena = ua_arena_current();
+    ua_arena_use(NULL);
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
+    *((UA_NodeId*)data->data) = UA_NODEID_NUMERIC(0, entry->identifier);
+    ua_arena_use(arena);
+    lua_pushvalue(L, 2);
+    lua_pushvalue(L, -2);
+    lua_rawset(L, 1);
+    return 1;
+}
+
+/* ua.types is filled on first access as well. ua.defineType adds the custom
+   types directly. */
+static int ua_types_index(lua_State *L) {
+    size_t len;
+    const char *name = lua_tolstring(L, 2, &len);
+    const UA_DataType *type = NULL;
+    if(lua_type(L, 2) == LUA_TSTRING)
+        type = ua_findtype_name(name, len);
+    if(!type) {
+        lua_pushnil(L);
+        return 1;
+    }
+    ua_arena *arena = ua_arena_current();
+    ua_arena_use(NULL);
+    ua_type_push_typetable(L, type);
+    ua_arena_use(arena);
+    lua_pushvalue(L, 2);
+    lua_pushvalue(L, -2);
+    lua_rawset(L, 1);
+    return 1;
+}
+
+static int lazyNext(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    lua_settop(L, 2);
+    if(lua_next(L, 1))
+        return 2;
+    lua_pushnil(L);
+    return 1;
+}
+
+static int lazyPairs(lua_State *L) {
+    lua_pushcfunction(L, lazyNext);
+    lua_pushvalue(L, 1);
+    lua_pushnil(L);
+    return 3;
+}
+
+/* pairs(ua.types) lists every type. The ns0 types are looked up first so
+   that the table is complete, the custom types are already in it. */
+static int ua_types_pairs(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        lua_getfield(L, 1, UA_TYPES[i].typeName);
+        lua_pop(L, 1);
+    }
+    return lazyPairs(L);
+}
+
+/* pairs(ua.nodeIds) lists the folder aliases and the names used so far */
+static int ua_nodeids_pairs(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    for(size_t i = 0; i < sizeof(nodeid_aliases) / sizeof(ua_nodeid_name); i++) {
+        lua_getfield(L, 1, nodeid_aliases[i].name);
+        lua_pop(L, 1);
+    }
+    return lazyPairs(L);
+}
+
+static void setLazyIndex(lua_State *L, lua_CFunction index, lua_CFunction pairs) {
+    lua_newtable(L);
+    lua_pushcfunction(L, index);
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, pairs);
+    lua_setfield(L, -2, "__pairs");
+    lua_setmetatable(L, -2);
 }
 
 static void addAttributeId(lua_State *L, int identifier, const char *name) {
@@ -63,6 +184,8 @@ int luaopen_ua(lua_State *L) {
     luaL_newmetatable(L, "open62541-array");
     lua_pushcfunction(L, ua_array_tostring);
     lua_setfield(L, -2, "__tostring");
+    lua_pushcfunction(L, ua_array_gc);
+    lua_setfield(L, -2, "__gc");
     lua_pushcfunction(L, ua_array_newindex);
     lua_setfield(L, -2, "__newindex");
     lua_pushcfunction(L, ua_array_len);
@@ -71,7 +194,40 @@ int luaopen_ua(lua_State *L) {
     lua_setfield(L, -2, "__pairs");
     lua_pushcfunction(L, ua_array_pairs);
     lua_setfield(L, -2, "__ipairs");
-    lua_pushcfunction(L, ua_array_index);
+    lua_newtable(L);
+    lua_pushcfunction(L, ua_array_totable);
+    lua_setfield(L, -2, "totable");
+    lua_pushcfunction(L, ua_array_fill);
+    lua_setfield(L, -2, "fill");
+    lua_pushcfunction(L, ua_array_copyfrom);
+    lua_setfield(L, -2, "copyfrom");
+    lua_pushcfunction(L, ua_array_append);
+    lua_setfield(L, -2, "append");
+    lua_pushcfunction(L, ua_array_insert);
+    lua_setfield(L, -2, "insert");
+    lua_pushcfunction(L, ua_array_remove);
+    lua_setfield(L, -2, "remove");
+    lua_pushcfunction(L, ua_array_reserve);
+    lua_setfield(L, -2, "reserve");
+    lua_pushcclosure(L, ua_array_index, 1);
+    lua_setfield(L, -2, "__index");
+    lua_pop(L, 1);
+
+    /* metatable for the binary encoder */
+    luaL_newmetatable(L, "open62541-encoder");
+    lua_pushcfunction(L, ua_encoder_gc);
+    lua_setfield(L, -2, "__gc");
+    lua_pushcfunction(L, ua_encoder_len);
+    lua_setfield(L, -2, "__len");
+    lua_newtable(L);
+    lua_pushcfunction(L, ua_encoder_write);
+    lua_setfield(L, -2, "write");
+    lua_pushcfunction(L, ua_encoder_encode);
+    lua_setfield(L, -2, "encode");
+    lua_pushcfunction(L, ua_encoder_result);
+    lua_setfield(L, -2, "result");
+    lua_pushcfunction(L, ua_encoder_reset);
+    lua_setfield(L, -2, "reset");
     lua_setfield(L, -2, "__index");
     lua_pop(L, 1);
 
@@ -82,6 +238,8 @@ int luaopen_ua(lua_State *L) {
     lua_newtable(L);
     lua_pushcfunction(L, ua_server_start);
     lua_setfield(L, -2, "start");
+    lua_pushcfunction(L, ua_server_start_background);
+    lua_setfield(L, -2, "startBackground");
     lua_pushcfunction(L, ua_server_iterate);
     lua_setfield(L, -2, "iterate");
     lua_pushcfunction(L, ua_server_stop);
@@ -90,6 +248,12 @@ int luaopen_ua(lua_State *L) {
     lua_setfield(L, -2, "addVariableNode");
     lua_pushcfunction(L, ua_server_add_methodnode);
     lua_setfield(L, -2, "addMethodNode");
+    lua_pushcfunction(L, ua_server_add_datasourcevariablenode);
+    lua_setfield(L, -2, "addDataSourceVariableNode");
+    lua_pushcfunction(L, ua_server_set_datasource);
+    lua_setfield(L, -2, "setVariableNodeDataSource");
+    lua_pushcfunction(L, ua_server_add_resolver);
+    lua_setfield(L, -2, "addDataSourceResolver");
     lua_pushcfunction(L, ua_server_add_objectnode);
     lua_setfield(L, -2, "addObjectNode");
     lua_pushcfunction(L, ua_server_add_objecttypenode);
@@ -127,41 +291,42 @@ int luaopen_ua(lua_State *L) {
     lua_setfield(L, -2, "__index");
     lua_pop(L, 1);
 
+    /* weak-keyed cache of member proxies per parent */
+    lua_newtable(L);
+    lua_newtable(L);
+    lua_pushstring(L, "k");
+    lua_setfield(L, -2, "__mode");
+    lua_setmetatable(L, -2);
+    lua_setfield(L, LUA_REGISTRYINDEX, "open62541-proxies");
+
+    /* index the data types and compile their codec programs up front, the
+       server may decode in another thread */
+    UA_initDataTypeRegistry();
+
     /* create the module */
     luaL_newlib(L, uascript_module);
 
+    /* ua.Array(type, size) creates arrays, the table holds the static array
+       functions */
+    lua_newtable(L);
+    lua_pushcfunction(L, ua_array_fromtable);
+    lua_setfield(L, -2, "fromtable");
+    lua_newtable(L);
+    lua_pushcfunction(L, ua_array_call);
+    lua_setfield(L, -2, "__call");
+    lua_setmetatable(L, -2);
+    lua_setfield(L, -2, "Array");
+
     /* add the data types */
     lua_newtable(L);
-    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
-        ua_type_push_typetable(L, &UA_TYPES[i]);
-        lua_setfield(L, -2, UA_TYPES[i].typeName);
-    }
+    setLazyIndex(L, ua_types_index, ua_types_pairs);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, LUA_REGISTRYINDEX, "open62541-types"); /* for ua.defineType */
     lua_setfield(L, -2, "types");
 
     /* add the nodeids */
     lua_newtable(L);
-    addNodeId(L, 0, "Null");
-    /* References */
-    addNodeId(L, 31, "References");
-    addNodeId(L, 32, "NonHierarchicalReferences");
-    addNodeId(L, 33, "HierarchicalReferences");
-    addNodeId(L, 35, "Organizes");
-    addNodeId(L, 40, "HasTypeDefinition");
-    addNodeId(L, 45, "HasSubtype");
-    addNodeId(L, 46, "HasProperty");
-    addNodeId(L, 47, "HasComponent");
-    /* Object Types */
-    addNodeId(L, 58, "BaseObjectType");
-      addNodeId(L, 61, "FolderType");
-    /* Objects */
-    addNodeId(L, 84, "Root");
-    addNodeId(L, 85, "Objects");
-    addNodeId(L, 86, "Types");
-      addNodeId(L, 90, "DataTypes");
-      addNodeId(L, 88, "ObjectTypes");
-      addNodeId(L, 91, "ReferenceTypes");
-      addNodeId(L, 89, "VariableTypes");
-    addNodeId(L, 87, "Views");
+    setLazyIndex(L, ua_nodeids_index, ua_nodeids_pairs);
     lua_setfield(L, -2, "nodeIds");
 
     /* add the attribute ids */
@@ -16,15 +16,48 @@ extern "C" {
 #include "lua.h"
 //#include "compat-5.2.h"
 
+#ifdef __GNUC__
+# define LIBUA_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+# define LIBUA_THREAD_LOCAL __declspec(thread)
+#else
+# error No thread local storage keyword defined for this compiler
+#endif
+
 /* Types are a table with a single lightuserdata entry at index 1, that points
    to the UA_TYPES entry */
 
 int ua_type_tostring(lua_State *L);
 int ua_type_instantiate(lua_State *L);
 void ua_type_push_typetable(lua_State *L, const UA_DataType *type);
+int ua_definetype(lua_State *L);
+
+/* The names of the ns0 NodeIds in strcmp order (libua_nodeids.c) */
+typedef struct {
+    const char *name;
+    UA_UInt32 identifier;
+} ua_nodeid_name;
+extern const ua_nodeid_name ua_nodeid_names[];
+extern const size_t ua_nodeid_namesSize;
+
+/* Find the ns0 and custom types by name or typeId (NULL if unknown) */
+const UA_DataType * ua_findtype_name(const char *name, size_t len);
+const UA_DataType * ua_findtype_id(const UA_NodeId *id);
 
 int ua_encodebinary(lua_State *L);
 int ua_decodebinary(lua_State *L);
+int ua_encodebinary_many(lua_State *L);
+int ua_encoder_new(lua_State *L);
+int ua_encoder_gc(lua_State *L);
+int ua_encoder_len(lua_State *L);
+int ua_encoder_write(lua_State *L);
+int ua_encoder_result(lua_State *L);
+int ua_encoder_reset(lua_State *L);
+int ua_encoder_encode(lua_State *L);
+int ua_lazydecoding(lua_State *L);
+UA_Boolean ua_lazydecoding_enabled(void);
+int ua_encodejson(lua_State *L);
+int ua_decodejson(lua_State *L);
 
 /* UA userdata is always of the below type. The original userdata "owns" the
    memory and needs to garbage-collect it. All derived versions (i.e. created
@@ -34,17 +67,46 @@ int ua_decodebinary(lua_State *L);
 typedef struct {
     const UA_DataType *type;
     void *data;
+    UA_UInt32 scope; /* id of the ua.scope arena holding the data, or 0 */
 } ua_data;
 
+/* Values up to this size are stored inline in the userdata block directly
+   behind the ua_data header. Then, data points to (d+1) and the garbage
+   collection only frees the nested members. */
+#define LIBUA_INLINE_MAXSIZE 128
+
+/* Pushes a new (initialized) value of the given type */
+ua_data * ua_newdata(lua_State *L, const UA_DataType *type);
+
 int ua_gc(lua_State *L);
 int ua_index(lua_State *L);
 int ua_newindex(lua_State *L);
 int ua_tostring(lua_State *L);
+int ua_tostring_limited(lua_State *L);
+int ua_tostring_limits(lua_State *L);
 int ua_pairs(lua_State *L);
 ua_data * ua_getdata(lua_State *L, int index, const UA_DataType *type);
 int ua_get_type(lua_State *L);
-void * ua_getmember(void *parent, const UA_DataType *type, const char *membername,
-                    const UA_DataType **memberType, size_t **arraylen);
+
+/* Decodes a variant that was kept encoded by the lazy decoding in place. The
+   decoded value is allocated in the arena of the scope. */
+void ua_variant_decodelazy(lua_State *L, UA_Variant *v, UA_UInt32 scope);
+
+/* The member layout of structured types is precomputed when the module is
+   loaded. For arrays, the offset points to the length field that is directly
+   followed by the data pointer. */
+typedef struct {
+    const char *name;
+    const UA_DataType *type;
+    size_t offset;
+    size_t index;
+    UA_Boolean isArray;
+} ua_member;
+
+void ua_members_register(lua_State *L, const UA_DataType *type);
+const ua_member * ua_members(lua_State *L, const UA_DataType *type);
+const ua_member * ua_findmember(lua_State *L, const UA_DataType *type, int keyindex);
+const ua_member * ua_findmember_name(lua_State *L, const UA_DataType *type, const char *name);
 
 /* Arrays are of a special type and have a different metatable. Arrays cannot be
    created standalone, but are always part of an enclosing type. Indexing arrays
@@ -54,24 +116,95 @@ typedef struct {
     size_t *length;
     void **data;
     /* normally, arrays point to the member of ua_data value. but it can also
-       carry the data itself */
+       carry the data itself. then, the data is freed by the garbage
+       collection and capacity is the number of allocated elements. */
     size_t local_length;
     void *local_data;
+    size_t capacity;
+    UA_UInt32 scope; /* id of the ua.scope arena holding the data, or 0 */
 } ua_array;
 
+/* Pushes a new empty array that carries its own data */
+ua_array * ua_newarray(lua_State *L, const UA_DataType *type);
+
 int ua_array_tostring(lua_State *L);
+int ua_array_gc(lua_State *L);
 int ua_array_new(lua_State *L);
+int ua_array_call(lua_State *L);
+int ua_array_fromtable(lua_State *L);
 int ua_array_index(lua_State *L);
 int ua_array_len(lua_State *L);
 int ua_array_newindex(lua_State *L);
 int ua_array_append(lua_State *L);
 int ua_array_pairs(lua_State *L);
+int ua_array_totable(lua_State *L);
+int ua_array_fill(lua_State *L);
+int ua_array_copyfrom(lua_State *L);
+int ua_array_insert(lua_State *L);
+int ua_array_remove(lua_State *L);
+int ua_array_reserve(lua_State *L);
 ua_array * ua_getarray(lua_State *L, int index);
 
+/* Convert the Lua value at index into the initialized value at dst. Besides
+   ua values, plain Lua numbers, strings and tables are accepted, e.g.
+   {ns=1, s="name"} for a NodeId or a table with the member names for a
+   structure. ua_fromlua_array points to the length field of an array member
+   and accepts a ua array or a Lua sequence. */
+void ua_fromlua(lua_State *L, int index, void *dst, const UA_DataType *type);
+void ua_fromlua_array(lua_State *L, int index, void *member, const UA_DataType *type);
+
+/* Memory that is handed over to open62541 and freed there with UA_free must be
+   allocated with these functions. With UA_ENABLE_SLAB_ALLOCATOR, open62541
+   uses them as well and small blocks are served from size-class slabs. */
+void * ua_malloc(size_t size);
+void * ua_calloc(size_t num, size_t size);
+void * ua_realloc(void *ptr, size_t size);
+void ua_free(void *ptr);
+int ua_allocator_stats(lua_State *L);
+
+/* The UA heap memory is invisible to the Lua garbage collector.
+   ua_memory_step reports it as collector debt. ua_memory_check additionally
+   enforces the heap budget (ua.heapLimit) and must only be called where a Lua
+   error can be raised. */
+void ua_memory_step(lua_State *L);
+void ua_memory_check(lua_State *L);
+int ua_heap_limit(lua_State *L);
+
+/* Inside ua.scope(f), the UA values created from Lua are allocated from a bump
+   arena that is released at once when f returns. Every function that
+   allocates selects the arena it needs with ua_arena_use (NULL is the heap).
+   Values remember the id of their arena and raise an error when they are used
+   after the scope was closed. */
+typedef struct ua_arena ua_arena;
+void ua_arena_use(ua_arena *arena);
+ua_arena * ua_arena_current(void);
+ua_arena * ua_arena_innermost(void);
+ua_arena * ua_arena_find(UA_UInt32 id); /* NULL if the scope is closed */
+UA_UInt32 ua_arena_id(const ua_arena *arena);
+int ua_scope(lua_State *L);
+
+/* Message arenas hold a request (server) or response (client) decoded inside
+   open62541 that is released at once after use. They are pushed like scopes,
+   but ua_arena_innermost skips them. ua_arena_message returns the message
+   arena on top of the stack or NULL. */
+ua_arena * ua_arena_push_message(void);
+ua_arena * ua_arena_message(void);
+void ua_arena_pop(ua_arena *arena);
+int ua_copy(lua_State *L);
+
+/* Borrow arenas hold no memory. Their id marks values that point into memory
+   owned by open62541 (e.g. the input arguments of a method call), which must
+   not be used after ua_arena_pop. ua_pushborrowed pushes such a value. It is
+   never freed by the garbage collection. */
+ua_arena * ua_arena_push_borrow(void);
+ua_data * ua_pushborrowed(lua_State *L, const void *p, const UA_DataType *type,
+                          const ua_arena *borrow);
+
 /* Server */
 int ua_server_new(lua_State *L);
 int ua_server_gc(lua_State *L);
 int ua_server_start(lua_State *L);
+int ua_server_start_background(lua_State *L);
 int ua_server_iterate(lua_State *L);
 int ua_server_stop(lua_State *L);
 int ua_server_add_variablenode(lua_State *L);
@@ -80,6 +213,9 @@ int ua_server_add_objecttypenode(lua_State *L);
 int ua_server_add_referencetypenode(lua_State *L);
 int ua_server_add_reference(lua_State *L);
 int ua_server_add_methodnode(lua_State *L);
+int ua_server_add_datasourcevariablenode(lua_State *L);
+int ua_server_set_datasource(lua_State *L);
+int ua_server_add_resolver(lua_State *L);
 int ua_server_write(lua_State *L);
 int ua_server_read(lua_State *L);
 
@@ -0,0 +1,508 @@
+// This file is a part of uascript. License is MIT (see LICENSE file)
+
+#include <limits.h>
+
+#include "libua.h"
+#include "lauxlib.h"
+#include "spinlock.h"
+#include "atomic.h"
+
+/********************/
+/* Size-Class Slabs */
+/********************/
+
+/* Every heap block is preceded by a header with its size. With the slab
+   allocator, the header also holds the size class of the block. Blocks of
+   scope arenas have the same header, marked as arena block and with the
+   offset to their chunk. */
+typedef union ua_heap_header {
+    union ua_heap_header *next; /* in the slab free list */
+    struct {
+        size_t size;
+        unsigned char sizeclass;
+        UA_Boolean arena;
+        UA_UInt32 chunk; /* arena blocks: offset from the start of the chunk */
+    } info;
+    double align[2]; /* the header keeps the alignment of malloc */
+} ua_heap_header;
+
+static size_t ua_heap_size(void *ptr) {
+    return ((ua_heap_header*)ptr - 1)->info.size;
+}
+
+#ifndef UA_ENABLE_SLAB_ALLOCATOR
+
+static void * ua_heap_malloc(size_t size) {
+    ua_heap_header *h = malloc(sizeof(ua_heap_header) + size);
+    if(!h)
+        return NULL;
+    h->info.size = size;
+    h->info.arena = false;
+    return h + 1;
+}
+
+static void * ua_heap_realloc(void *ptr, size_t size) {
+    if(!ptr)
+        return ua_heap_malloc(size);
+    ua_heap_header *h = realloc((ua_heap_header*)ptr - 1, sizeof(ua_heap_header) + size);
+    if(!h)
+        return NULL;
+    h->info.size = size;
+    return h + 1;
+}
+
+static void ua_heap_free(void *ptr) {
+    if(ptr)
+        free((ua_heap_header*)ptr - 1);
+}
+
+#else
+
+/* Counters of the allocator */
+static struct {
+    size_t hits;   /* served from a slab free list */
+    size_t misses; /* the slab had to be refilled from the C library */
+    size_t large;  /* too large for a size class, passed to the C library */
+} ua_alloc_stats;
+
+/* Blocks up to LIBUA_SLAB_MAXSIZE bytes are taken from size classes. The size
+   classes are the (aligned) memSizes of the builtin data types, so that every
+   UA_new gets a block without slack. Other sizes (e.g. string contents) use
+   the next larger class. Slab chunks are never returned to the C library, freed blocks are
+   kept in the free list of their class for reuse. */
+#define LIBUA_SLAB_MAXSIZE 512
+#define LIBUA_SLAB_CHUNKSIZE 16384
+#define LIBUA_SLAB_ALIGN 8
+#define LIBUA_SLAB_LARGE 0xff
+
+typedef struct {
+    size_t size;
+    ua_heap_header *free;
+} ua_slab_class;
+
+static struct {
+    struct spinlock lock;
+    UA_Boolean initialized;
+    size_t classesSize;
+    ua_slab_class classes[LIBUA_SLAB_MAXSIZE / LIBUA_SLAB_ALIGN];
+    /* lookup from the aligned size to the size class */
+    unsigned char classof[(LIBUA_SLAB_MAXSIZE / LIBUA_SLAB_ALIGN) + 1];
+} ua_slab;
+
+static size_t ua_slab_align(size_t size) {
+    return (size + LIBUA_SLAB_ALIGN - 1) & ~(size_t)(LIBUA_SLAB_ALIGN - 1);
+}
+
+/* Call only with the lock held */
+static void ua_slab_init(void) {
+    UA_Boolean used[(LIBUA_SLAB_MAXSIZE / LIBUA_SLAB_ALIGN) + 1];
+    memset(used, 0, sizeof(used));
+    used[LIBUA_SLAB_MAXSIZE / LIBUA_SLAB_ALIGN] = true;
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        size_t size = ua_slab_align(UA_TYPES[i].memSize);
+        if(size > 0 && size <= LIBUA_SLAB_MAXSIZE)
+            used[size / LIBUA_SLAB_ALIGN] = true;
+    }
+    ua_slab.classesSize = 0;
+    for(size_t i = 1; i <= LIBUA_SLAB_MAXSIZE / LIBUA_SLAB_ALIGN; i++) {
+        if(!used[i])
+            continue;
+        ua_slab.classes[ua_slab.classesSize].size = i * LIBUA_SLAB_ALIGN;
+        ua_slab.classes[ua_slab.classesSize].free = NULL;
+        ua_slab.classesSize++;
+    }
+    /* smallest class that fits the aligned size */
+    size_t j = 0;
+    for(size_t i = 0; i <= LIBUA_SLAB_MAXSIZE / LIBUA_SLAB_ALIGN; i++) {
+        if(ua_slab.classes[j].size < i * LIBUA_SLAB_ALIGN)
+            j++;
+        ua_slab.classof[i] = (unsigned char)j;
+    }
+    ua_slab.initialized = true;
+}
+
+/* Call only with the lock held */
+static UA_Boolean ua_slab_refill(ua_slab_class *sc) {
+    size_t blocksize = sizeof(ua_heap_header) + sc->size;
+    size_t count = LIBUA_SLAB_CHUNKSIZE / blocksize;
+    unsigned char *chunk = malloc(count * blocksize);
+    if(!chunk)
+        return false;
+    for(size_t i = 0; i < count; i++) {
+        ua_heap_header *h = (ua_heap_header*)(chunk + (i * blocksize));
+        h->next = sc->free;
+        sc->free = h;
+    }
+    return true;
+}
+
+static void * ua_heap_malloc(size_t size) {
+    if(size > LIBUA_SLAB_MAXSIZE) {
+        ua_heap_header *h = malloc(sizeof(ua_heap_header) + size);
+        if(!h)
+            return NULL;
+        h->info.size = size;
+        h->info.sizeclass = LIBUA_SLAB_LARGE;
+        h->info.arena = false;
+        SPIN_LOCK(&ua_slab);
+        ua_alloc_stats.large++;
+        SPIN_UNLOCK(&ua_slab);
+        return h + 1;
+    }
+
+    SPIN_LOCK(&ua_slab);
+    if(!ua_slab.initialized)
+        ua_slab_init();
+    unsigned char sizeclass = ua_slab.classof[ua_slab_align(size) / LIBUA_SLAB_ALIGN];
+    ua_slab_class *sc = &ua_slab.classes[sizeclass];
+    if(sc->free) {
+        ua_alloc_stats.hits++;
+    } else {
+        ua_alloc_stats.misses++;
+        if(!ua_slab_refill(sc)) {
+            SPIN_UNLOCK(&ua_slab);
+            return NULL;
+        }
+    }
+    ua_heap_header *h = sc->free;
+    sc->free = h->next;
+    SPIN_UNLOCK(&ua_slab);
+    h->info.size = size;
+    h->info.sizeclass = sizeclass;
+    h->info.arena = false;
+    return h + 1;
+}
+
+static void ua_heap_free(void *ptr) {
+    if(!ptr)
+        return;
+    ua_heap_header *h = (ua_heap_header*)ptr - 1;
+    if(h->info.sizeclass == LIBUA_SLAB_LARGE) {
+        free(h);
+        return;
+    }
+    SPIN_LOCK(&ua_slab);
+    ua_slab_class *sc = &ua_slab.classes[h->info.sizeclass];
+    h->next = sc->free;
+    sc->free = h;
+    SPIN_UNLOCK(&ua_slab);
+}
+
+static void * ua_heap_realloc(void *ptr, size_t size) {
+    if(!ptr)
+        return ua_heap_malloc(size);
+    ua_heap_header *h = (ua_heap_header*)ptr - 1;
+    if(h->info.sizeclass == LIBUA_SLAB_LARGE && size > LIBUA_SLAB_MAXSIZE) {
+        h = realloc(h, sizeof(ua_heap_header) + size);
+        if(!h)
+            return NULL;
+        h->info.size = size;
+        return h + 1;
+    }
+    size_t oldsize = h->info.size;
+    if(h->info.sizeclass != LIBUA_SLAB_LARGE &&
+       size <= ua_slab.classes[h->info.sizeclass].size) {
+        h->info.size = size;
+        return ptr;
+    }
+    void *p = ua_heap_malloc(size);
+    if(!p)
+        return NULL;
+    memcpy(p, ptr, (size < oldsize) ? size : oldsize);
+    ua_heap_free(ptr);
+    return p;
+}
+
+#endif
+
+/****************/
+/* Scope Arenas */
+/****************/
+
+/* Arenas are bump allocators made of a list of chunks. Every block carries
+   a heap header in front with its size for ua_realloc and the offset to its
+   chunk, which points to the arena. Freeing a single block does nothing, the
+   chunks are released together when the scope is closed. */
+#define LIBUA_ARENA_CHUNKSIZE 65536
+#define LIBUA_ARENA_ALIGN 16
+
+typedef struct ua_arena_chunk {
+    struct ua_arena_chunk *next;
+    ua_arena *arena;
+    size_t size; /* including this header */
+    size_t used;
+} ua_arena_chunk;
+
+struct ua_arena {
+    ua_arena *parent; /* the enclosing scope */
+    UA_UInt32 id; /* 0 for message arenas */
+    UA_Boolean borrow; /* only tracks the lifetime, allocates from the heap */
+    ua_arena_chunk *chunks;
+};
+
+/* The open scopes of this thread and the arena used for allocations. The
+   callbacks of a background server do not see the scopes of the main thread
+   (the arenas are not synchronized), so these values count as released. */
+static LIBUA_THREAD_LOCAL ua_arena *ua_arena_top;
+static LIBUA_THREAD_LOCAL ua_arena *ua_arena_active;
+static UA_UInt32 ua_arena_ids;
+
+static size_t ua_arena_align(size_t size) {
+    return (size + LIBUA_ARENA_ALIGN - 1) & ~(size_t)(LIBUA_ARENA_ALIGN - 1);
+}
+
+#define LIBUA_ARENA_CHUNKHEADER ua_arena_align(sizeof(ua_arena_chunk))
+#define LIBUA_ARENA_BLOCKHEADER ua_arena_align(sizeof(ua_heap_header))
+
+static void * ua_arena_alloc(ua_arena *arena, size_t size) {
+    size_t need = LIBUA_ARENA_BLOCKHEADER + ua_arena_align(size);
+    ua_arena_chunk *c = arena->chunks;
+    if(!c || c->used + need > c->size) {
+        size_t chunksize = LIBUA_ARENA_CHUNKHEADER + need;
+        if(chunksize < LIBUA_ARENA_CHUNKSIZE)
+            chunksize = LIBUA_ARENA_CHUNKSIZE;
+        c = malloc(chunksize);
+        if(!c)
+            return NULL;
+        c->next = arena->chunks;
+        c->arena = arena;
+        c->size = chunksize;
+        c->used = LIBUA_ARENA_CHUNKHEADER;
+        arena->chunks = c;
+    }
+    unsigned char *block = (unsigned char*)c + c->used;
+    ua_heap_header *h = (ua_heap_header*)(block + LIBUA_ARENA_BLOCKHEADER) - 1;
+    h->info.size = size;
+    h->info.arena = true;
+    h->info.chunk = (UA_UInt32)c->used; /* chunks with several blocks are small */
+    c->used += need;
+    return block + LIBUA_ARENA_BLOCKHEADER;
+}
+
+/* The arena that contains the block, or NULL for heap blocks */
+static ua_arena * ua_arena_owner(const void *ptr) {
+    const ua_heap_header *h = (const ua_heap_header*)ptr - 1;
+    if(!h->info.arena)
+        return NULL;
+    return ((const ua_arena_chunk*)((uintptr_t)ptr - LIBUA_ARENA_BLOCKHEADER -
+                                    h->info.chunk))->arena;
+}
+
+ua_arena * ua_arena_current(void) {
+    return ua_arena_active;
+}
+
+/* Message and borrow arenas are internal and skipped */
+ua_arena * ua_arena_innermost(void) {
+    ua_arena *a = ua_arena_top;
+    while(a && (a->id == 0 || a->borrow))
+        a = a->parent;
+    return a;
+}
+
+ua_arena * ua_arena_message(void) {
+    return (ua_arena_top && ua_arena_top->id == 0) ? ua_arena_top : NULL;
+}
+
+void ua_arena_use(ua_arena *arena) {
+    ua_arena_active = arena;
+}
+
+ua_arena * ua_arena_find(UA_UInt32 id) {
+    for(ua_arena *a = ua_arena_top; a && id != 0; a = a->parent) {
+        if(a->id == id)
+            return a;
+    }
+    return NULL;
+}
+
+UA_UInt32 ua_arena_id(const ua_arena *arena) {
+    return arena ? arena->id : 0;
+}
+
+static ua_arena * ua_arena_push(UA_UInt32 id) {
+    ua_arena *arena = malloc(sizeof(ua_arena));
+    if(!arena)
+        return NULL;
+    arena->parent = ua_arena_top;
+    arena->id = id;
+    arena->borrow = false;
+    arena->chunks = NULL;
+    ua_arena_top = arena;
+    return arena;
+}
+
+void ua_arena_pop(ua_arena *arena) {
+    ua_arena_top = arena->parent;
+    if(ua_arena_active == arena)
+        ua_arena_active = NULL;
+    ua_arena_chunk *c = arena->chunks;
+    while(c) {
+        ua_arena_chunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    free(arena);
+}
+
+ua_arena * ua_arena_push_message(void) {
+    return ua_arena_push(0);
+}
+
+static UA_UInt32 ua_arena_newid(void) {
+    UA_UInt32 id;
+    do {
+        id = ATOM_INC(&ua_arena_ids);
+    } while(id == 0);
+    return id;
+}
+
+ua_arena * ua_arena_push_borrow(void) {
+    ua_arena *arena = ua_arena_push(ua_arena_newid());
+    if(arena)
+        arena->borrow = true;
+    return arena;
+}
+
+/* ua.scope(f, ...) calls f inside a new scope and returns its results */
+int ua_scope(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    ua_arena *active = ua_arena_active;
+    ua_arena *arena = ua_arena_push(ua_arena_newid());
+    if(!arena)
+        return luaL_error(L, "Out of memory");
+
+    int status = lua_pcall(L, lua_gettop(L) - 1, LUA_MULTRET, 0);
+
+    ua_arena_pop(arena);
+    ua_arena_active = active;
+    if(status != LUA_OK)
+        return lua_error(L);
+    return lua_gettop(L);
+}
+
+/*************/
+/* Allocator */
+/*************/
+
+/* The heap memory in use through UA_malloc and the optional budget. This is
+   the memory of the UA values and of open62541 itself (e.g. the nodestore,
+   sessions and network buffers). The debt
+   counts the heap memory allocated by this thread that was not yet reported
+   to the Lua garbage collector. */
+static size_t ua_alloc_inuse;
+static size_t ua_alloc_limit;
+static LIBUA_THREAD_LOCAL size_t ua_alloc_debt;
+
+void * ua_malloc(size_t size) {
+    if(ua_arena_active && !ua_arena_active->borrow)
+        return ua_arena_alloc(ua_arena_active, size);
+    void *p = ua_heap_malloc(size);
+    if(p) {
+        ATOM_ADD(&ua_alloc_inuse, size);
+        ua_alloc_debt += size;
+    }
+    return p;
+}
+
+void * ua_calloc(size_t num, size_t size) {
+    if(size > 0 && num > SIZE_MAX / size)
+        return NULL;
+    void *p = ua_malloc(num * size);
+    if(p)
+        memset(p, 0, num * size);
+    return p;
+}
+
+void ua_free(void *ptr) {
+    if(!ptr || ((ua_heap_header*)ptr - 1)->info.arena)
+        return;
+    ATOM_SUB(&ua_alloc_inuse, ua_heap_size(ptr));
+    ua_heap_free(ptr);
+}
+
+/* Blocks stay in the arena (or heap) they were allocated from */
+void * ua_realloc(void *ptr, size_t size) {
+    if(!ptr)
+        return ua_malloc(size);
+    ua_arena *arena = ua_arena_owner(ptr);
+    if(!arena) {
+        size_t oldsize = ua_heap_size(ptr);
+        void *p = ua_heap_realloc(ptr, size);
+        if(p) {
+            ATOM_SUB(&ua_alloc_inuse, oldsize);
+            ATOM_ADD(&ua_alloc_inuse, size);
+            if(size > oldsize)
+                ua_alloc_debt += size - oldsize;
+        }
+        return p;
+    }
+    size_t oldsize = ((ua_heap_header*)ptr - 1)->info.size;
+    if(size <= oldsize)
+        return ptr;
+    void *p = ua_arena_alloc(arena, size);
+    if(!p)
+        return NULL;
+    memcpy(p, ptr, oldsize);
+    return p;
+}
+
+/* Report the heap memory allocated since the last call to the Lua garbage
+   collector. The collector then steps as if the memory was allocated by Lua. */
+void ua_memory_step(lua_State *L) {
+    if(ua_alloc_debt < 1024)
+        return;
+    size_t kb = ua_alloc_debt / 1024;
+    ua_alloc_debt %= 1024;
+    if(lua_gc(L, LUA_GCISRUNNING, 0))
+        lua_gc(L, LUA_GCSTEP, (int)(kb < INT_MAX ? kb : INT_MAX));
+}
+
+/* Enforce the heap budget before new values are allocated. A full collection
+   is tried first. */
+void ua_memory_check(lua_State *L) {
+    ua_memory_step(L);
+    if(ua_alloc_limit == 0 || ua_alloc_inuse <= ua_alloc_limit)
+        return;
+    lua_gc(L, LUA_GCCOLLECT, 0);
+    if(ua_alloc_inuse > ua_alloc_limit)
+        luaL_error(L, "Out of memory: the ua heap budget of %I bytes is exhausted",
+                   (lua_Integer)ua_alloc_limit);
+}
+
+/* ua.heapLimit([bytes]) sets the budget for the UA heap (0 disables the
+   budget) and returns the previous one. ua.memoryLimit is the former name. */
+int ua_heap_limit(lua_State *L) {
+    lua_Integer limit = luaL_optinteger(L, 1, (lua_Integer)ua_alloc_limit);
+    luaL_argcheck(L, limit >= 0, 1, "the limit must not be negative");
+    lua_pushinteger(L, (lua_Integer)ua_alloc_limit);
+    ua_alloc_limit = (size_t)limit;
+    return 1;
+}
+
+/* ua.allocatorStats() returns the counters of the allocator */
+int ua_allocator_stats(lua_State *L) {
+#ifdef UA_ENABLE_SLAB_ALLOCATOR
+    SPIN_LOCK(&ua_slab);
+    size_t hits = ua_alloc_stats.hits;
+    size_t misses = ua_alloc_stats.misses;
+    size_t large = ua_alloc_stats.large;
+    SPIN_UNLOCK(&ua_slab);
+    UA_Boolean enabled = true;
+#else
+    size_t hits = 0, misses = 0, large = 0;
+    UA_Boolean enabled = false;
+#endif
+    lua_newtable(L);
+    lua_pushboolean(L, enabled);
+    lua_setfield(L, -2, "enabled");
+    lua_pushinteger(L, (lua_Integer)ua_alloc_inuse);
+    lua_setfield(L, -2, "inuse");
+    lua_pushinteger(L, (lua_Integer)hits);
+    lua_setfield(L, -2, "hits");
+    lua_pushinteger(L, (lua_Integer)misses);
+    lua_setfield(L, -2, "misses");
+    lua_pushinteger(L, (lua_Integer)large);
+    lua_setfield(L, -2, "large");
+    return 1;
+}
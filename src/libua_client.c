@@ -8,7 +8,10 @@ struct ua_client {
     UA_Client *client;
 };
 
+/* The client state is allocated on the heap and never in the arena of a
+   ua.scope */
 int ua_client_new(lua_State *L) {
+    ua_arena_use(NULL);
     struct ua_client *client = lua_newuserdata(L, sizeof(struct ua_client));
     client->client = UA_Client_new(UA_ClientConfig_standard, Logger_Stdout);
     luaL_setmetatable(L, "open62541-client");
@@ -24,6 +27,7 @@ int ua_client_gc(lua_State *L) {
 
 int ua_client_connect(lua_State *L) {
     struct ua_client *client = luaL_checkudata (L, 1, "open62541-client");
+    ua_arena_use(NULL);
     if(!client)
         return luaL_error(L, "Not a client object");
     if(!lua_isstring(L, 2))
@@ -35,6 +39,7 @@ int ua_client_connect(lua_State *L) {
 }
 
 int ua_client_getendpoints(lua_State *L) {
+    ua_arena_use(NULL);
     if(!lua_isstring(L, 1))
         return luaL_error(L, "Supply a connection string of the form opc.tcp://url:port");
     UA_Client *client = UA_Client_new(UA_ClientConfig_standard, Logger_Stdout);
@@ -43,13 +48,10 @@ int ua_client_getendpoints(lua_State *L) {
     UA_StatusCode retval = UA_Client_getEndpoints(client, UA_ClientConnectionTCP, lua_tostring(L, 1),
                                                   &endpointsSize, &endpoints);
     if(retval == UA_STATUSCODE_GOOD) {
-        ua_array *array = lua_newuserdata(L, sizeof(ua_array));
-        array->type = &UA_TYPES[UA_TYPES_ENDPOINTDESCRIPTION];
-        array->data = &array->local_data;
-        array->length = &array->local_length;
+        ua_array *array = ua_newarray(L, &UA_TYPES[UA_TYPES_ENDPOINTDESCRIPTION]);
         array->local_data = endpoints;
         array->local_length = endpointsSize;
-        luaL_setmetatable(L, "open62541-array");
+        array->capacity = endpointsSize;
     } else {
         lua_pushnil(L);
     }
@@ -61,6 +63,7 @@ int ua_client_getendpoints(lua_State *L) {
 
 int ua_client_disconnect(lua_State *L) {
     struct ua_client *client = luaL_checkudata (L, 1, "open62541-client");
+    ua_arena_use(NULL);
     if(!client)
         return luaL_error(L, "Not a client object");
     UA_StatusCode retval = UA_Client_disconnect(client->client);
@@ -68,12 +71,17 @@ int ua_client_disconnect(lua_State *L) {
     return 1;
 }
 
+/* Services return at most this many members of the response */
+#define LIBUA_MAXOUTPUTS 4
+
 static int
 ua_client_service(lua_State *L, const UA_DataType *requestType, const char **inputs,
                   const UA_DataType *responseType, const char **outputs) {
     struct ua_client *client = luaL_checkudata (L, 1, "open62541-client");
     if(!client)
         return luaL_error(L, "The first argument must be a client object");
+    ua_arena_use(NULL);
+    ua_memory_check(L);
 
     /* fill up the arguments before adding new elements to the stack */
     for(size_t i = 0; ; i++ ) {
@@ -82,10 +90,7 @@ ua_client_service(lua_State *L, const UA_DataType *requestType, const char **inp
         lua_pushnil(L);
     }
 
-    ua_data *request = lua_newuserdata(L, sizeof(ua_data));
-    request->data = UA_new(requestType);
-    request->type = requestType;
-    luaL_setmetatable(L, "open62541-data");
+    ua_data *request = ua_newdata(L, requestType);
 
     for(size_t i = 0; ; i++ ) {
         const char *input = inputs[i];
@@ -94,54 +99,64 @@ ua_client_service(lua_State *L, const UA_DataType *requestType, const char **inp
         if(lua_isnil(L, i+2))
             continue;
         /* get the member in the request */
-        size_t *inputlen;
-        const UA_DataType *inputType;
-        void *inputdata = ua_getmember(request->data, requestType, input, &inputType, &inputlen);
-        if(!inputlen) {
-            ua_data *data = ua_getdata(L, i+2, inputType);
-            UA_copy(data->data, inputdata, inputType);
+        const ua_member *m = ua_findmember_name(L, requestType, input);
+        const UA_DataType *inputType = m->type;
+        void *inputdata = (void*)((uintptr_t)request->data + m->offset);
+        /* plain Lua tables are converted directly into the request */
+        if(!m->isArray) {
+            ua_fromlua(L, i+2, inputdata, inputType);
         } else {
-            ua_array *array = ua_getarray(L, i+2);
-            if(!array || array->type != inputType)
+            if(!lua_istable(L, i+2) && !luaL_testudata(L, i+2, "open62541-array"))
                 return luaL_error(L, "Argument %d must be an array of type %s.",
                                   i+1, inputType->typeName);
-            UA_Array_copy(*array->data, *array->length, (void**)inputdata, inputType);
-            *inputlen = *array->length;
+            ua_fromlua_array(L, i+2, inputdata, inputType);
         }
     }
 
-    ua_data *response = lua_newuserdata(L, sizeof(ua_data));
-    response->data = UA_new(responseType);
-    response->type = responseType;
-    luaL_setmetatable(L, "open62541-data");
-    __UA_Client_Service(client->client, request->data, requestType, response->data, responseType);
-
+    /* The outputs are created first. The response is decoded into a message
+       arena, the outputs are copied to the heap and the arena is released at
+       once. No Lua error may be raised while the arena is open. */
+    ua_data *response = ua_newdata(L, responseType);
+    const ua_member *members[LIBUA_MAXOUTPUTS];
     int out = 0;
-    for(size_t i = 0; ; i++) {
-        const char *output = outputs[i];
-        if(!output)
-            break;
-        /* get the member in the response */
-        size_t *outputlen;
-        const UA_DataType *outputType;
-        void *outputdata = ua_getmember(response->data, responseType, output, &outputType, &outputlen);
-        if(!outputlen) {
-            ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-            data->data = UA_new(outputType);
-            data->type = outputType;
-            luaL_setmetatable(L, "open62541-data");
+    for(; outputs[out]; out++) {
+        const ua_member *m = ua_findmember_name(L, responseType, outputs[out]);
+        if(!m->isArray)
+            ua_newdata(L, m->type);
+        else
+            ua_newarray(L, m->type);
+        members[out] = m;
+    }
+
+    ua_arena *arena = ua_arena_push_message();
+    if(!arena)
+        return luaL_error(L, "Out of memory");
+    /* only this thread decodes lazily, not a background server */
+    UA_Boolean lazy = UA_setLazyDecoding(ua_lazydecoding_enabled());
+    __UA_Client_ServiceArena(client->client, request->data, requestType,
+                             response->data, responseType, arena);
+    UA_setLazyDecoding(lazy);
+
+    int first = lua_gettop(L) - out + 1;
+    for(int i = 0; i < out; i++) {
+        const ua_member *m = members[i];
+        const UA_DataType *outputType = m->type;
+        void *outputdata = (void*)((uintptr_t)response->data + m->offset);
+        if(!m->isArray) {
+            ua_data *data = lua_touserdata(L, first + i);
             UA_copy(outputdata, data->data, outputType);
         } else {
-            ua_array *array = lua_newuserdata(L, sizeof(ua_array));
-            array->type = outputType;
-            array->data = &array->local_data;
-            array->length = &array->local_length;
-            array->local_length = *outputlen;
-            luaL_setmetatable(L, "open62541-array");
-            UA_Array_copy(*(void**)outputdata, *outputlen, &array->local_data, outputType);
+            ua_array *array = lua_touserdata(L, first + i);
+            size_t outputlen = *(size_t*)outputdata;
+            UA_Array_copy(*(void**)((uintptr_t)outputdata + sizeof(size_t)), outputlen,
+                          &array->local_data, outputType);
+            array->local_length = outputlen;
+            array->capacity = outputlen;
         }
-        out++;
     }
+    /* the members of the response are in the arena */
+    UA_init(response->data, responseType);
+    ua_arena_pop(arena);
     return out;
 }
 
@@ -159,7 +174,7 @@ int ua_client_service_browsenext(lua_State *L) {
                              &UA_TYPES[UA_TYPES_BROWSENEXTRESPONSE], service_browsenext_output);
 }
 
-static const char *service_read_input[] = {"nodesToRead", "maxAge", "timestampsToreturn", NULL};
+static const char *service_read_input[] = {"nodesToRead", "maxAge", "timestampsToReturn", NULL};
 static const char *service_read_output[] = {"results", "responseHeader", "diagnosticInfos", NULL};
 int ua_client_service_read(lua_State *L) {
     return ua_client_service(L, &UA_TYPES[UA_TYPES_READREQUEST], service_read_input,
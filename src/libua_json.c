@@ -0,0 +1,1442 @@
+// This file is a part of uascript. License is MIT (see LICENSE file)
+
+#include <math.h>
+#include <float.h>
+#include <errno.h>
+
+#include "libua.h"
+#include "lauxlib.h"
+
+/* The JSON codec walks the member descriptors of the types directly. The
+   mapping follows the OPC UA JSON encoding loosely:
+   - numbers, booleans and strings map to their JSON counterparts. NaN and
+     the infinities are the strings "NaN", "Infinity" and "-Infinity".
+   - DateTime is an ISO 8601 string in UTC, e.g. "2016-05-01T12:00:00.0000000Z"
+   - Guid is a string, ByteString is base64
+   - NodeId and ExpandedNodeId use the text format "ns=1;s=name"
+   - Variant is {"type": "Int32", "value": v, "dimensions": [...]}
+   - ExtensionObject is {"typeId": id, "body": v} with an additional
+     "encoding": "binary" or "xml" for bodies that are not decoded
+   - structures are objects with the member names as keys */
+
+/********/
+/* Base */
+/********/
+
+static const char ua_base64_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Days since 1970-01-01 of the civil date and back */
+static int64_t
+ua_json_days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+static void
+ua_json_civil_from_days(int64_t z, int64_t *y, unsigned *m, unsigned *d) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = (int64_t)yoe + era * 400 + (*m <= 2);
+}
+
+/************/
+/* Encoding */
+/************/
+
+static void ua_json_encode(luaL_Buffer *b, const void *p, const UA_DataType *type);
+static void ua_json_encode_array(luaL_Buffer *b, const void *p, size_t len,
+                                 const UA_DataType *type);
+
+#define UA_JSON_MAXNUMBER 64
+
+#define ua_json_format(b, fmt, ...) do {                                \
+        char *out = luaL_prepbuffsize(b, UA_JSON_MAXNUMBER);            \
+        luaL_addsize(b, snprintf(out, UA_JSON_MAXNUMBER, fmt, __VA_ARGS__)); \
+    } while(0)
+
+/* the characters of a string without the quotes */
+static void
+ua_json_escape(luaL_Buffer *b, const char *s, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        switch(c) {
+        case '"': luaL_addstring(b, "\\\""); break;
+        case '\\': luaL_addstring(b, "\\\\"); break;
+        case '\n': luaL_addstring(b, "\\n"); break;
+        case '\r': luaL_addstring(b, "\\r"); break;
+        case '\t': luaL_addstring(b, "\\t"); break;
+        case '\b': luaL_addstring(b, "\\b"); break;
+        case '\f': luaL_addstring(b, "\\f"); break;
+        default:
+            if(c < 0x20)
+                ua_json_format(b, "\\u%04x", c);
+            else
+                luaL_addchar(b, c);
+        }
+    }
+}
+
+static void
+ua_json_encode_string(luaL_Buffer *b, const UA_String *s) {
+    if(!s->data) {
+        luaL_addstring(b, "null");
+        return;
+    }
+    luaL_addchar(b, '"');
+    ua_json_escape(b, (const char*)s->data, s->length);
+    luaL_addchar(b, '"');
+}
+
+static void
+ua_json_base64(luaL_Buffer *b, const UA_ByteString *s) {
+    size_t i = 0;
+    for(; i + 2 < s->length; i += 3) {
+        UA_UInt32 v = (UA_UInt32)s->data[i] << 16 | (UA_UInt32)s->data[i+1] << 8 | s->data[i+2];
+        luaL_addchar(b, ua_base64_chars[v >> 18]);
+        luaL_addchar(b, ua_base64_chars[(v >> 12) & 0x3f]);
+        luaL_addchar(b, ua_base64_chars[(v >> 6) & 0x3f]);
+        luaL_addchar(b, ua_base64_chars[v & 0x3f]);
+    }
+    if(i < s->length) {
+        UA_UInt32 v = (UA_UInt32)s->data[i] << 16;
+        if(i + 1 < s->length)
+            v |= (UA_UInt32)s->data[i+1] << 8;
+        luaL_addchar(b, ua_base64_chars[v >> 18]);
+        luaL_addchar(b, ua_base64_chars[(v >> 12) & 0x3f]);
+        luaL_addchar(b, i + 1 < s->length ? ua_base64_chars[(v >> 6) & 0x3f] : '=');
+        luaL_addchar(b, '=');
+    }
+}
+
+static void
+ua_json_encode_guid(luaL_Buffer *b, const UA_Guid *id) {
+    ua_json_format(b, "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+                   id->data1, id->data2, id->data3, id->data4[0], id->data4[1],
+                   id->data4[2], id->data4[3], id->data4[4], id->data4[5],
+                   id->data4[6], id->data4[7]);
+}
+
+static void
+ua_json_encode_datetime(luaL_Buffer *b, UA_DateTime t) {
+    /* split before the epoch is subtracted, which could overflow */
+    int64_t secs = t / UA_SEC_TO_DATETIME - UA_DATETIME_UNIX_EPOCH / UA_SEC_TO_DATETIME;
+    int64_t frac = t % UA_SEC_TO_DATETIME;
+    if(frac < 0) {
+        frac += UA_SEC_TO_DATETIME;
+        secs--;
+    }
+    int64_t days = secs / 86400;
+    int64_t daysecs = secs % 86400;
+    if(daysecs < 0) {
+        daysecs += 86400;
+        days--;
+    }
+    int64_t y;
+    unsigned m, d;
+    ua_json_civil_from_days(days, &y, &m, &d);
+    ua_json_format(b, "\"%04lld-%02u-%02uT%02u:%02u:%02u.%07uZ\"", (long long)y, m, d,
+                   (unsigned)(daysecs / 3600), (unsigned)(daysecs / 60 % 60),
+                   (unsigned)(daysecs % 60), (unsigned)frac);
+}
+
+/* the NodeId without the quotes */
+static void
+ua_json_nodeid_text(luaL_Buffer *b, const UA_NodeId *id) {
+    if(id->namespaceIndex != 0)
+        ua_json_format(b, "ns=%u;", (unsigned)id->namespaceIndex);
+    switch(id->identifierType) {
+    case UA_NODEIDTYPE_NUMERIC:
+        ua_json_format(b, "i=%u", (unsigned)id->identifier.numeric);
+        break;
+    case UA_NODEIDTYPE_STRING:
+        luaL_addstring(b, "s=");
+        ua_json_escape(b, (const char*)id->identifier.string.data,
+                       id->identifier.string.length);
+        break;
+    case UA_NODEIDTYPE_GUID:
+        luaL_addstring(b, "g=");
+        ua_json_encode_guid(b, &id->identifier.guid);
+        break;
+    default:
+        luaL_addstring(b, "b=");
+        ua_json_base64(b, &id->identifier.byteString);
+        break;
+    }
+}
+
+static void
+ua_json_encode_double(luaL_Buffer *b, double d, const char *fmt) {
+    if(isnan(d))
+        luaL_addstring(b, "\"NaN\"");
+    else if(isinf(d))
+        luaL_addstring(b, d > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+    else
+        ua_json_format(b, fmt, d);
+}
+
+/* "key": */
+static void
+ua_json_key(luaL_Buffer *b, UA_Boolean *first, const char *key) {
+    if(!*first)
+        luaL_addchar(b, ',');
+    *first = false;
+    luaL_addchar(b, '"');
+    luaL_addstring(b, key);
+    luaL_addstring(b, "\":");
+}
+
+static void
+ua_json_encode_variant(luaL_Buffer *b, const UA_Variant *v) {
+    UA_Variant_decodeLazy((UA_Variant*)(uintptr_t)v);
+    if(!v->type) {
+        luaL_addstring(b, "null");
+        return;
+    }
+    luaL_addstring(b, "{\"type\":\"");
+    luaL_addstring(b, v->type->typeName);
+    luaL_addstring(b, "\",\"value\":");
+    if(UA_Variant_isScalar(v))
+        ua_json_encode(b, v->data, v->type);
+    else
+        ua_json_encode_array(b, v->data, v->arrayLength, v->type);
+    if(v->arrayDimensionsSize > 0) {
+        luaL_addstring(b, ",\"dimensions\":");
+        ua_json_encode_array(b, v->arrayDimensions, v->arrayDimensionsSize,
+                             &UA_TYPES[UA_TYPES_UINT32]);
+    }
+    luaL_addchar(b, '}');
+}
+
+static void
+ua_json_encode_extensionobject(luaL_Buffer *b, const UA_ExtensionObject *eo) {
+    /* bodies that cannot be decoded are written encoded */
+    UA_ExtensionObject_decodeLazy((UA_ExtensionObject*)(uintptr_t)eo);
+    luaL_addstring(b, "{\"typeId\":\"");
+    if(eo->encoding >= UA_EXTENSIONOBJECT_DECODED) {
+        ua_json_nodeid_text(b, &eo->content.decoded.type->typeId);
+        luaL_addstring(b, "\",\"body\":");
+        ua_json_encode(b, eo->content.decoded.data, eo->content.decoded.type);
+    } else {
+        ua_json_nodeid_text(b, &eo->content.encoded.typeId);
+        luaL_addchar(b, '"');
+        if(eo->encoding == UA_EXTENSIONOBJECT_ENCODED_BYTESTRING) {
+            luaL_addstring(b, ",\"encoding\":\"binary\",\"body\":\"");
+            ua_json_base64(b, &eo->content.encoded.body);
+            luaL_addchar(b, '"');
+        } else if(eo->encoding == UA_EXTENSIONOBJECT_ENCODED_XML) {
+            luaL_addstring(b, ",\"encoding\":\"xml\",\"body\":");
+            ua_json_encode_string(b, &eo->content.encoded.body);
+        }
+    }
+    luaL_addchar(b, '}');
+}
+
+static void
+ua_json_encode_datavalue(luaL_Buffer *b, const UA_DataValue *v) {
+    UA_Boolean first = true;
+    luaL_addchar(b, '{');
+    if(v->hasValue) {
+        ua_json_key(b, &first, "value");
+        ua_json_encode_variant(b, &v->value);
+    }
+    if(v->hasStatus) {
+        ua_json_key(b, &first, "status");
+        ua_json_format(b, "%u", (unsigned)v->status);
+    }
+    if(v->hasSourceTimestamp) {
+        ua_json_key(b, &first, "sourceTimestamp");
+        ua_json_encode_datetime(b, v->sourceTimestamp);
+    }
+    if(v->hasSourcePicoseconds) {
+        ua_json_key(b, &first, "sourcePicoseconds");
+        ua_json_format(b, "%u", (unsigned)v->sourcePicoseconds);
+    }
+    if(v->hasServerTimestamp) {
+        ua_json_key(b, &first, "serverTimestamp");
+        ua_json_encode_datetime(b, v->serverTimestamp);
+    }
+    if(v->hasServerPicoseconds) {
+        ua_json_key(b, &first, "serverPicoseconds");
+        ua_json_format(b, "%u", (unsigned)v->serverPicoseconds);
+    }
+    luaL_addchar(b, '}');
+}
+
+static void
+ua_json_encode_diagnosticinfo(luaL_Buffer *b, const UA_DiagnosticInfo *di) {
+    UA_Boolean first = true;
+    luaL_addchar(b, '{');
+    if(di->hasSymbolicId) {
+        ua_json_key(b, &first, "symbolicId");
+        ua_json_format(b, "%d", (int)di->symbolicId);
+    }
+    if(di->hasNamespaceUri) {
+        ua_json_key(b, &first, "namespaceUri");
+        ua_json_format(b, "%d", (int)di->namespaceUri);
+    }
+    if(di->hasLocalizedText) {
+        ua_json_key(b, &first, "localizedText");
+        ua_json_format(b, "%d", (int)di->localizedText);
+    }
+    if(di->hasLocale) {
+        ua_json_key(b, &first, "locale");
+        ua_json_format(b, "%d", (int)di->locale);
+    }
+    if(di->hasAdditionalInfo) {
+        ua_json_key(b, &first, "additionalInfo");
+        ua_json_encode_string(b, &di->additionalInfo);
+    }
+    if(di->hasInnerStatusCode) {
+        ua_json_key(b, &first, "innerStatusCode");
+        ua_json_format(b, "%u", (unsigned)di->innerStatusCode);
+    }
+    if(di->hasInnerDiagnosticInfo && di->innerDiagnosticInfo) {
+        ua_json_key(b, &first, "innerDiagnosticInfo");
+        ua_json_encode_diagnosticinfo(b, di->innerDiagnosticInfo);
+    }
+    luaL_addchar(b, '}');
+}
+
+static void
+ua_json_encode_structure(luaL_Buffer *b, const void *p, const UA_DataType *type) {
+    const ua_member *members = ua_members(b->L, type);
+    if(!members)
+        luaL_error(b->L, "Cannot encode ua.types.%s to JSON", type->typeName);
+    UA_Boolean first = true;
+    luaL_addchar(b, '{');
+    for(size_t i = 0; i < type->membersSize; i++) {
+        const ua_member *m = &members[i];
+        const void *member = (const void*)((uintptr_t)p + m->offset);
+        ua_json_key(b, &first, m->name);
+        if(m->isArray)
+            ua_json_encode_array(b, *(void * const *)((uintptr_t)member + sizeof(size_t)),
+                                 *(const size_t*)member, m->type);
+        else
+            ua_json_encode(b, member, m->type);
+    }
+    luaL_addchar(b, '}');
+}
+
+static void
+ua_json_encode(luaL_Buffer *b, const void *p, const UA_DataType *type) {
+    switch(type->typeIndex) {
+    case UA_TYPES_BOOLEAN:
+        luaL_addstring(b, *(const UA_Boolean*)p ? "true" : "false");
+        return;
+    case UA_TYPES_SBYTE:
+        ua_json_format(b, "%d", (int)*(const UA_SByte*)p);
+        return;
+    case UA_TYPES_BYTE:
+        ua_json_format(b, "%u", (unsigned)*(const UA_Byte*)p);
+        return;
+    case UA_TYPES_INT16:
+        ua_json_format(b, "%d", (int)*(const UA_Int16*)p);
+        return;
+    case UA_TYPES_UINT16:
+        ua_json_format(b, "%u", (unsigned)*(const UA_UInt16*)p);
+        return;
+    case UA_TYPES_INT32:
+        ua_json_format(b, "%d", (int)*(const UA_Int32*)p);
+        return;
+    case UA_TYPES_UINT32:
+    case UA_TYPES_STATUSCODE:
+        ua_json_format(b, "%u", (unsigned)*(const UA_UInt32*)p);
+        return;
+    case UA_TYPES_INT64:
+        ua_json_format(b, "%lld", (long long)*(const UA_Int64*)p);
+        return;
+    case UA_TYPES_UINT64:
+        ua_json_format(b, "%llu", (unsigned long long)*(const UA_UInt64*)p);
+        return;
+    case UA_TYPES_FLOAT:
+        ua_json_encode_double(b, *(const UA_Float*)p, "%.9g");
+        return;
+    case UA_TYPES_DOUBLE:
+        ua_json_encode_double(b, *(const UA_Double*)p, "%.17g");
+        return;
+    case UA_TYPES_STRING:
+    case UA_TYPES_XMLELEMENT:
+        ua_json_encode_string(b, p);
+        return;
+    case UA_TYPES_BYTESTRING:
+        if(!((const UA_ByteString*)p)->data) {
+            luaL_addstring(b, "null");
+            return;
+        }
+        luaL_addchar(b, '"');
+        ua_json_base64(b, p);
+        luaL_addchar(b, '"');
+        return;
+    case UA_TYPES_DATETIME:
+        ua_json_encode_datetime(b, *(const UA_DateTime*)p);
+        return;
+    case UA_TYPES_GUID:
+        luaL_addchar(b, '"');
+        ua_json_encode_guid(b, p);
+        luaL_addchar(b, '"');
+        return;
+    case UA_TYPES_NODEID:
+        luaL_addchar(b, '"');
+        ua_json_nodeid_text(b, p);
+        luaL_addchar(b, '"');
+        return;
+    case UA_TYPES_EXPANDEDNODEID: {
+        const UA_ExpandedNodeId *id = p;
+        luaL_addchar(b, '"');
+        if(id->serverIndex != 0)
+            ua_json_format(b, "svr=%u;", (unsigned)id->serverIndex);
+        if(id->namespaceUri.data) {
+            luaL_addstring(b, "nsu=");
+            ua_json_escape(b, (const char*)id->namespaceUri.data, id->namespaceUri.length);
+            luaL_addchar(b, ';');
+        }
+        ua_json_nodeid_text(b, &id->nodeId);
+        luaL_addchar(b, '"');
+        return;
+    }
+    case UA_TYPES_LOCALIZEDTEXT: {
+        const UA_LocalizedText *lt = p;
+        luaL_addstring(b, "{\"locale\":");
+        ua_json_encode_string(b, &lt->locale);
+        luaL_addstring(b, ",\"text\":");
+        ua_json_encode_string(b, &lt->text);
+        luaL_addchar(b, '}');
+        return;
+    }
+    case UA_TYPES_VARIANT:
+        ua_json_encode_variant(b, p);
+        return;
+    case UA_TYPES_EXTENSIONOBJECT:
+        ua_json_encode_extensionobject(b, p);
+        return;
+    case UA_TYPES_DATAVALUE:
+        ua_json_encode_datavalue(b, p);
+        return;
+    case UA_TYPES_DIAGNOSTICINFO:
+        ua_json_encode_diagnosticinfo(b, p);
+        return;
+    default:
+        ua_json_encode_structure(b, p, type);
+        return;
+    }
+}
+
+static void
+ua_json_encode_array(luaL_Buffer *b, const void *p, size_t len, const UA_DataType *type) {
+    luaL_addchar(b, '[');
+    uintptr_t e = (uintptr_t)p;
+    for(size_t i = 0; i < len; i++) {
+        if(i > 0)
+            luaL_addchar(b, ',');
+        ua_json_encode(b, (const void*)e, type);
+        e += type->memSize;
+    }
+    luaL_addchar(b, ']');
+}
+
+/* ua.encodeJSON(v) returns the JSON string of a value or array */
+int ua_encodejson(lua_State *L) {
+    ua_arena_use(NULL);
+    luaL_Buffer b;
+    ua_array *array = luaL_testudata(L, 1, "open62541-array");
+    if(array) {
+        ua_getarray(L, 1); /* checks the scope */
+        ua_arena_use(ua_arena_find(array->scope)); /* for the lazy decoding */
+        luaL_buffinit(L, &b);
+        ua_json_encode_array(&b, *array->data, *array->length, array->type);
+    } else {
+        ua_data *data = ua_getdata(L, 1, NULL);
+        ua_arena_use(ua_arena_find(data->scope)); /* for the lazy decoding */
+        luaL_buffinit(L, &b);
+        ua_json_encode(&b, data->data, data->type);
+    }
+    luaL_pushresult(&b);
+    return 1;
+}
+
+/************/
+/* Decoding */
+/************/
+
+/* The decoder writes directly into initialized values. Arrays are grown in
+   place and their length always covers the elements written so far. Then,
+   the value stays valid for the garbage collection when an error is raised
+   midway. */
+typedef struct {
+    lua_State *L;
+    const char *start;
+    const char *pos; /* the Lua string is zero-terminated */
+    int depth; /* nesting of objects and arrays */
+} ua_json_reader;
+
+/* Limits the recursion so that malformed input cannot overflow the C stack */
+#define UA_JSON_MAXDEPTH 256
+
+static void ua_json_decode(ua_json_reader *r, void *dst, const UA_DataType *type);
+static void ua_json_decode_array(ua_json_reader *r, void *member, const UA_DataType *type);
+
+static void
+ua_json_error(ua_json_reader *r, const char *msg) {
+    luaL_error(r->L, "JSON error at position %d: %s", (int)(r->pos - r->start) + 1, msg);
+}
+
+static void
+ua_json_skipws(ua_json_reader *r) {
+    while(*r->pos == ' ' || *r->pos == '\t' || *r->pos == '\n' || *r->pos == '\r')
+        r->pos++;
+}
+
+static char
+ua_json_peek(ua_json_reader *r) {
+    ua_json_skipws(r);
+    return *r->pos;
+}
+
+static void
+ua_json_expect(ua_json_reader *r, char c) {
+    if(ua_json_peek(r) != c) {
+        char msg[24];
+        snprintf(msg, sizeof(msg), "'%c' expected", c);
+        ua_json_error(r, msg);
+    }
+    r->pos++;
+}
+
+static UA_Boolean
+ua_json_literal(ua_json_reader *r, const char *lit) {
+    size_t len = strlen(lit);
+    if(strncmp(r->pos, lit, len) != 0)
+        return false;
+    r->pos += len;
+    return true;
+}
+
+/* Decode the string at the current position into len bytes at out. Without
+   out, only the length is computed. */
+static size_t
+ua_json_unescape(ua_json_reader *r, char *out) {
+    const char *s = r->pos + 1;
+    size_t len = 0;
+    while(*s != '"') {
+        unsigned char c = (unsigned char)*s;
+        if(c == '\0')
+            ua_json_error(r, "unterminated string");
+        if(c != '\\') {
+            if(out)
+                out[len] = c;
+            len++;
+            s++;
+            continue;
+        }
+        s++;
+        switch(*s) {
+        case '"': case '\\': case '/':
+            c = *s;
+            break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'u': {
+            char hex[5] = {0};
+            memcpy(hex, s + 1, 4);
+            char *end;
+            unsigned long cp = strtoul(hex, &end, 16);
+            if(end != hex + 4)
+                ua_json_error(r, "invalid unicode escape");
+            s += 4;
+            if(cp >= 0xd800 && cp < 0xdc00 && s[1] == '\\' && s[2] == 'u') {
+                memcpy(hex, s + 3, 4);
+                unsigned long lo = strtoul(hex, &end, 16);
+                if(end == hex + 4 && lo >= 0xdc00 && lo < 0xe000) {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                    s += 6;
+                }
+            }
+            /* utf-8 */
+            unsigned char u[4];
+            size_t n;
+            if(cp < 0x80) {
+                u[0] = (unsigned char)cp;
+                n = 1;
+            } else if(cp < 0x800) {
+                u[0] = 0xc0 | (cp >> 6);
+                u[1] = 0x80 | (cp & 0x3f);
+                n = 2;
+            } else if(cp < 0x10000) {
+                u[0] = 0xe0 | (cp >> 12);
+                u[1] = 0x80 | ((cp >> 6) & 0x3f);
+                u[2] = 0x80 | (cp & 0x3f);
+                n = 3;
+            } else {
+                u[0] = 0xf0 | (cp >> 18);
+                u[1] = 0x80 | ((cp >> 12) & 0x3f);
+                u[2] = 0x80 | ((cp >> 6) & 0x3f);
+                u[3] = 0x80 | (cp & 0x3f);
+                n = 4;
+            }
+            if(out)
+                memcpy(&out[len], u, n);
+            len += n;
+            s++;
+            continue;
+        }
+        default:
+            ua_json_error(r, "invalid escape");
+        }
+        if(out)
+            out[len] = c;
+        len++;
+        s++;
+    }
+    if(out)
+        r->pos = s + 1;
+    return len;
+}
+
+static void
+ua_json_decode_string(ua_json_reader *r, UA_String *str) {
+    if(ua_json_peek(r) == 'n' && ua_json_literal(r, "null")) {
+        UA_String_deleteMembers(str);
+        return;
+    }
+    if(*r->pos != '"')
+        ua_json_error(r, "string expected");
+    size_t len = ua_json_unescape(r, NULL);
+    UA_String_deleteMembers(str);
+    str->data = ua_malloc(len);
+    if(!str->data)
+        luaL_error(r->L, "Out of memory");
+    str->length = len;
+    ua_json_unescape(r, (char*)str->data);
+}
+
+/* Short strings (keys, names) are decoded into a buffer on the stack */
+static size_t
+ua_json_decode_short(ua_json_reader *r, char *out, size_t size) {
+    if(ua_json_peek(r) != '"')
+        ua_json_error(r, "string expected");
+    size_t len = ua_json_unescape(r, NULL);
+    if(len >= size)
+        ua_json_error(r, "string too long");
+    ua_json_unescape(r, out);
+    out[len] = '\0';
+    return len;
+}
+
+static void
+ua_json_enter(ua_json_reader *r) {
+    if(++r->depth > UA_JSON_MAXDEPTH)
+        ua_json_error(r, "nesting too deep");
+}
+
+static void
+ua_json_skip(ua_json_reader *r) {
+    char c = ua_json_peek(r);
+    if(c == '"') {
+        ua_json_unescape(r, NULL);
+        /* move behind the string */
+        const char *s = r->pos + 1;
+        while(*s != '"') {
+            if(*s == '\\')
+                s++;
+            s++;
+        }
+        r->pos = s + 1;
+        return;
+    }
+    if(c == '{' || c == '[') {
+        char close = (c == '{') ? '}' : ']';
+        r->pos++;
+        if(ua_json_peek(r) == close) {
+            r->pos++;
+            return;
+        }
+        ua_json_enter(r);
+        while(true) {
+            if(c == '{') {
+                ua_json_skip(r);
+                ua_json_expect(r, ':');
+            }
+            ua_json_skip(r);
+            if(ua_json_peek(r) == ',') {
+                r->pos++;
+                continue;
+            }
+            ua_json_expect(r, close);
+            r->depth--;
+            return;
+        }
+    }
+    if(ua_json_literal(r, "true") || ua_json_literal(r, "false") ||
+       ua_json_literal(r, "null"))
+        return;
+    char *end;
+    strtod(r->pos, &end);
+    if(end == r->pos)
+        ua_json_error(r, "unexpected character");
+    r->pos = end;
+}
+
+/* Iterate over the keys of an object. Call with *first set to true. Returns
+   false at the end of the object. */
+static UA_Boolean
+ua_json_nextkey(ua_json_reader *r, UA_Boolean *first, char *key, size_t size) {
+    if(*first) {
+        ua_json_expect(r, '{');
+        *first = false;
+        if(ua_json_peek(r) == '}') {
+            r->pos++;
+            return false;
+        }
+    } else {
+        if(ua_json_peek(r) == '}') {
+            r->pos++;
+            return false;
+        }
+        ua_json_expect(r, ',');
+    }
+    ua_json_decode_short(r, key, size);
+    ua_json_expect(r, ':');
+    return true;
+}
+
+static UA_Boolean
+ua_json_isnull(ua_json_reader *r) {
+    return ua_json_peek(r) == 'n' && ua_json_literal(r, "null");
+}
+
+/* Integers are given as true/false, numbers or (for 64-bit) strings. Returns
+   the magnitude so that the full Int64 and UInt64 ranges can be checked. */
+static UA_UInt64
+ua_json_decode_magnitude(ua_json_reader *r, UA_Boolean *negative) {
+    *negative = false;
+    char c = ua_json_peek(r);
+    if(c == 't' && ua_json_literal(r, "true"))
+        return 1;
+    if(c == 'f' && ua_json_literal(r, "false"))
+        return 0;
+    UA_Boolean quoted = (c == '"');
+    const char *s = r->pos + quoted;
+    if(*s == '-') {
+        *negative = true;
+        s++;
+    }
+    if(*s < '0' || *s > '9')
+        ua_json_error(r, "integer expected");
+    char *end;
+    errno = 0;
+    UA_UInt64 u = strtoull(s, &end, 10);
+    if(errno == ERANGE)
+        ua_json_error(r, "integer out of range");
+    if(*end == '.' || *end == 'e' || *end == 'E') {
+        double d = strtod(s, &end);
+        if(!(d < 18446744073709551616.0))
+            ua_json_error(r, "integer out of range");
+        u = (UA_UInt64)d;
+    }
+    if(quoted) {
+        if(*end != '"')
+            ua_json_error(r, "integer expected");
+        end++;
+    }
+    if(u == 0)
+        *negative = false;
+    r->pos = end;
+    return u;
+}
+
+static UA_Int64
+ua_json_decode_int(ua_json_reader *r, UA_Int64 min, UA_Int64 max) {
+    ua_json_skipws(r);
+    const char *start = r->pos;
+    UA_Boolean negative;
+    UA_UInt64 u = ua_json_decode_magnitude(r, &negative);
+    if(u > (UA_UInt64)INT64_MAX + negative)
+        goto range;
+    UA_Int64 i = negative ? (UA_Int64)(0 - u) : (UA_Int64)u;
+    if(i >= min && i <= max)
+        return i;
+ range:
+    r->pos = start;
+    ua_json_error(r, "integer out of range");
+    return 0;
+}
+
+static UA_UInt64
+ua_json_decode_uint(ua_json_reader *r, UA_UInt64 max) {
+    ua_json_skipws(r);
+    const char *start = r->pos;
+    UA_Boolean negative;
+    UA_UInt64 u = ua_json_decode_magnitude(r, &negative);
+    if(negative || u > max) {
+        r->pos = start;
+        ua_json_error(r, "integer out of range");
+    }
+    return u;
+}
+
+static double
+ua_json_decode_double(ua_json_reader *r) {
+    if(ua_json_peek(r) == '"') {
+        if(ua_json_literal(r, "\"NaN\""))
+            return NAN;
+        if(ua_json_literal(r, "\"Infinity\""))
+            return INFINITY;
+        if(ua_json_literal(r, "\"-Infinity\""))
+            return -INFINITY;
+        ua_json_error(r, "number expected");
+    }
+    char *end;
+    double d = strtod(r->pos, &end);
+    if(end == r->pos)
+        ua_json_error(r, "number expected");
+    r->pos = end;
+    return d;
+}
+
+static UA_Float
+ua_json_decode_float(ua_json_reader *r) {
+    ua_json_skipws(r);
+    const char *start = r->pos;
+    double d = ua_json_decode_double(r);
+    if(isfinite(d) && fabs(d) > FLT_MAX) {
+        r->pos = start;
+        ua_json_error(r, "number out of range");
+    }
+    return (UA_Float)d;
+}
+
+static UA_Boolean
+ua_json_base64_decode(const UA_Byte *s, size_t len, UA_ByteString *bs) {
+    bs->data = ua_malloc(len / 4 * 3 + 3);
+    bs->length = 0;
+    if(!bs->data)
+        return false;
+    UA_UInt32 v = 0;
+    int bits = 0;
+    size_t i = 0;
+    for(; i < len && s[i] != '='; i++) {
+        const char *p = s[i] ? strchr(ua_base64_chars, s[i]) : NULL;
+        if(!p)
+            goto invalid;
+        v = (v << 6) | (UA_UInt32)(p - ua_base64_chars);
+        bits += 6;
+        if(bits >= 8) {
+            bits -= 8;
+            bs->data[bs->length++] = (UA_Byte)(v >> bits);
+        }
+    }
+    /* A single character in the last group carries no complete byte. Padding
+       fills up the last group and nothing may follow it. */
+    size_t padding = len - i;
+    if(i % 4 == 1 || padding > 2 || (padding > 0 && (i + padding) % 4 != 0))
+        goto invalid;
+    for(; i < len; i++) {
+        if(s[i] != '=')
+            goto invalid;
+    }
+    return true;
+ invalid:
+    UA_ByteString_deleteMembers(bs);
+    return false;
+}
+
+static void
+ua_json_decode_base64(ua_json_reader *r, UA_ByteString *bs) {
+    UA_String str = UA_STRING_NULL;
+    ua_json_decode_string(r, &str);
+    UA_ByteString_deleteMembers(bs);
+    if(!str.data)
+        return;
+    UA_Boolean ok = ua_json_base64_decode(str.data, str.length, bs);
+    UA_String_deleteMembers(&str);
+    if(!ok)
+        ua_json_error(r, "invalid base64");
+}
+
+static UA_Boolean
+ua_json_parse_guid(const char *s, size_t len, UA_Guid *guid) {
+    if(len != 36 || s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-')
+        return false;
+    char buf[37];
+    memcpy(buf, s, 36);
+    buf[36] = '\0';
+    guid->data1 = (UA_UInt32)strtoul(buf, NULL, 16);
+    guid->data2 = (UA_UInt16)strtoul(&buf[9], NULL, 16);
+    guid->data3 = (UA_UInt16)strtoul(&buf[14], NULL, 16);
+    UA_UInt16 data4_1 = (UA_UInt16)strtoul(&buf[19], NULL, 16);
+    guid->data4[0] = data4_1 >> 8;
+    guid->data4[1] = (UA_Byte)data4_1;
+    UA_UInt64 data4_2 = strtoull(&buf[24], NULL, 16);
+    for(size_t i = 0; i < 6; i++)
+        guid->data4[2+i] = (UA_Byte)(data4_2 >> (40 - 8 * i));
+    return true;
+}
+
+static void
+ua_json_decode_guid(ua_json_reader *r, UA_Guid *guid) {
+    char buf[40];
+    size_t len = ua_json_decode_short(r, buf, sizeof(buf));
+    if(!ua_json_parse_guid(buf, len, guid))
+        ua_json_error(r, "invalid guid");
+}
+
+static void
+ua_json_decode_datetime(ua_json_reader *r, UA_DateTime *t) {
+    static const unsigned monthdays[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    ua_json_skipws(r);
+    const char *start = r->pos;
+    char buf[40];
+    ua_json_decode_short(r, buf, sizeof(buf));
+    long long y;
+    unsigned mo, d, h, mi, s;
+    int n = 0;
+    if(sscanf(buf, "%lld-%u-%uT%u:%u:%u%n", &y, &mo, &d, &h, &mi, &s, &n) != 6 ||
+       mo < 1 || mo > 12 || d < 1 || d > monthdays[mo-1] || h > 23 || mi > 59 || s > 59 ||
+       (mo == 2 && d == 29 && (y % 4 != 0 || (y % 100 == 0 && y % 400 != 0))))
+        ua_json_error(r, "invalid DateTime");
+    const char *p = &buf[n];
+    int64_t frac = 0;
+    if(*p == '.') {
+        int64_t scale = UA_SEC_TO_DATETIME;
+        for(p++; *p >= '0' && *p <= '9'; p++) {
+            scale /= 10;
+            frac += (*p - '0') * scale;
+        }
+    }
+    if(*p != 'Z' && *p != '\0')
+        ua_json_error(r, "only UTC DateTime is supported");
+    /* the seconds since 1601 must fit into the 100 ns ticks of UA_DateTime */
+    if(y < -300000 || y > 300000)
+        goto range;
+    int64_t days = ua_json_days_from_civil(y, mo, d);
+    int64_t secs = days * 86400 + h * 3600 + mi * 60 + s +
+        UA_DATETIME_UNIX_EPOCH / UA_SEC_TO_DATETIME;
+    int64_t lo = INT64_MIN / UA_SEC_TO_DATETIME; /* rounded towards zero */
+    if(secs > (INT64_MAX - frac) / UA_SEC_TO_DATETIME || secs < lo - 1 ||
+       (secs == lo - 1 && lo * UA_SEC_TO_DATETIME < INT64_MIN + UA_SEC_TO_DATETIME - frac))
+        goto range;
+    if(secs < 0) /* the fraction counts towards zero */
+        *t = (secs + 1) * UA_SEC_TO_DATETIME + (frac - UA_SEC_TO_DATETIME);
+    else
+        *t = secs * UA_SEC_TO_DATETIME + frac;
+    return;
+ range:
+    r->pos = start;
+    ua_json_error(r, "DateTime out of range");
+}
+
+/* Decimal number up to max. Returns false for overflow or when no digits are
+   found. */
+static UA_Boolean
+ua_json_parse_index(const char *s, char **end, UA_UInt32 max, UA_UInt32 *out) {
+    if(*s < '0' || *s > '9')
+        return false;
+    errno = 0;
+    unsigned long long u = strtoull(s, end, 10);
+    if(errno == ERANGE || u > max)
+        return false;
+    *out = (UA_UInt32)u;
+    return true;
+}
+
+/* "ns=1;i=42" and the like */
+static UA_Boolean
+ua_json_parse_nodeid(const char *s, UA_NodeId *id) {
+    UA_NodeId_deleteMembers(id);
+    UA_NodeId_init(id);
+    if(strncmp(s, "ns=", 3) == 0) {
+        char *end;
+        UA_UInt32 ns;
+        if(!ua_json_parse_index(s + 3, &end, UA_UINT16_MAX, &ns) || *end != ';')
+            return false;
+        id->namespaceIndex = (UA_UInt16)ns;
+        s = end + 1;
+    }
+    if(s[0] == '\0' || s[1] != '=')
+        return false;
+    const char *v = s + 2;
+    switch(s[0]) {
+    case 'i': {
+        char *end;
+        return ua_json_parse_index(v, &end, UA_UINT32_MAX, &id->identifier.numeric) &&
+            *end == '\0';
+    }
+    case 's': {
+        size_t len = strlen(v);
+        UA_Byte *data = len ? ua_malloc(len) : UA_EMPTY_ARRAY_SENTINEL;
+        if(!data)
+            return false;
+        memcpy(data, v, len);
+        id->identifierType = UA_NODEIDTYPE_STRING;
+        id->identifier.string.length = len;
+        id->identifier.string.data = data;
+        return true;
+    }
+    case 'g':
+        id->identifierType = UA_NODEIDTYPE_GUID;
+        return ua_json_parse_guid(v, strlen(v), &id->identifier.guid);
+    case 'b':
+        id->identifierType = UA_NODEIDTYPE_BYTESTRING;
+        return ua_json_base64_decode((const UA_Byte*)v, strlen(v), &id->identifier.byteString);
+    default:
+        return false;
+    }
+}
+
+/* The text format is decoded from a zero-terminated copy */
+static char *
+ua_json_decode_text(ua_json_reader *r) {
+    if(ua_json_isnull(r))
+        return NULL;
+    if(ua_json_peek(r) != '"')
+        ua_json_error(r, "string expected");
+    size_t len = ua_json_unescape(r, NULL);
+    char *s = ua_malloc(len + 1);
+    if(!s)
+        luaL_error(r->L, "Out of memory");
+    ua_json_unescape(r, s);
+    s[len] = '\0';
+    return s;
+}
+
+static void
+ua_json_decode_nodeid(ua_json_reader *r, UA_NodeId *id) {
+    char *s = ua_json_decode_text(r);
+    if(!s)
+        return;
+    UA_Boolean ok = ua_json_parse_nodeid(s, id);
+    ua_free(s);
+    if(!ok)
+        ua_json_error(r, "invalid NodeId");
+}
+
+/* "svr=1;nsu=uri;ns=1;i=42" */
+static void
+ua_json_decode_expandednodeid(ua_json_reader *r, UA_ExpandedNodeId *id) {
+    char *s = ua_json_decode_text(r);
+    if(!s)
+        return;
+    const char *p = s;
+    UA_Boolean ok = true;
+    if(strncmp(p, "svr=", 4) == 0) {
+        char *end;
+        ok = ua_json_parse_index(p + 4, &end, UA_UINT32_MAX, &id->serverIndex);
+        p = (*end == ';') ? end + 1 : end;
+    }
+    if(ok && strncmp(p, "nsu=", 4) == 0) {
+        const char *end = strchr(p + 4, ';');
+        if(end) {
+            UA_String_deleteMembers(&id->namespaceUri);
+            size_t len = (size_t)(end - (p + 4));
+            UA_Byte *data = len ? ua_malloc(len) : UA_EMPTY_ARRAY_SENTINEL;
+            ok = (data != NULL);
+            if(ok) {
+                memcpy(data, p + 4, len);
+                id->namespaceUri.length = len;
+                id->namespaceUri.data = data;
+            }
+            p = end + 1;
+        }
+    }
+    ok = ok && ua_json_parse_nodeid(p, &id->nodeId);
+    ua_free(s);
+    if(!ok)
+        ua_json_error(r, "invalid ExpandedNodeId");
+}
+
+static void
+ua_json_decode_localizedtext(ua_json_reader *r, UA_LocalizedText *lt) {
+    char key[64];
+    UA_Boolean first = true;
+    while(ua_json_nextkey(r, &first, key, sizeof(key))) {
+        if(strcmp(key, "locale") == 0)
+            ua_json_decode_string(r, &lt->locale);
+        else if(strcmp(key, "text") == 0)
+            ua_json_decode_string(r, &lt->text);
+        else
+            ua_json_skip(r);
+    }
+}
+
+/* The value can come before the type. It is decoded after the object. */
+static void
+ua_json_decode_variant(ua_json_reader *r, UA_Variant *v) {
+    const UA_DataType *type = NULL;
+    const char *valuepos = NULL;
+    const char *dimpos = NULL;
+    char key[64];
+    UA_Boolean first = true;
+    while(ua_json_nextkey(r, &first, key, sizeof(key))) {
+        if(strcmp(key, "type") == 0) {
+            char name[128];
+            size_t len = ua_json_decode_short(r, name, sizeof(name));
+            type = ua_findtype_name(name, len);
+            if(!type)
+                ua_json_error(r, "unknown variant type");
+        } else if(strcmp(key, "value") == 0) {
+            ua_json_skipws(r);
+            valuepos = r->pos;
+            ua_json_skip(r);
+        } else if(strcmp(key, "dimensions") == 0) {
+            ua_json_skipws(r);
+            dimpos = r->pos;
+            ua_json_skip(r);
+        } else {
+            ua_json_skip(r);
+        }
+    }
+    if(!valuepos)
+        return;
+    if(!type)
+        ua_json_error(r, "variant without a type");
+    const char *end = r->pos;
+    r->pos = valuepos;
+    if(*valuepos == '[') {
+        v->type = type;
+        ua_json_decode_array(r, &v->arrayLength, type);
+    } else {
+        v->data = UA_new(type);
+        if(!v->data)
+            luaL_error(r->L, "Out of memory");
+        v->type = type;
+        ua_json_decode(r, v->data, type);
+    }
+    if(dimpos) {
+        r->pos = dimpos;
+        ua_json_decode_array(r, &v->arrayDimensionsSize, &UA_TYPES[UA_TYPES_UINT32]);
+    }
+    r->pos = end;
+}
+
+/* The typeId is needed before the body */
+static void
+ua_json_decode_extensionobject(ua_json_reader *r, UA_ExtensionObject *eo) {
+    const char *typepos = NULL;
+    const char *bodypos = NULL;
+    int encoding = UA_EXTENSIONOBJECT_DECODED;
+    char key[64];
+    UA_Boolean first = true;
+    while(ua_json_nextkey(r, &first, key, sizeof(key))) {
+        if(strcmp(key, "typeId") == 0) {
+            ua_json_skipws(r);
+            typepos = r->pos;
+            ua_json_skip(r);
+        } else if(strcmp(key, "body") == 0) {
+            ua_json_skipws(r);
+            bodypos = r->pos;
+            ua_json_skip(r);
+        } else if(strcmp(key, "encoding") == 0) {
+            char name[16];
+            ua_json_decode_short(r, name, sizeof(name));
+            if(strcmp(name, "binary") == 0)
+                encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
+            else if(strcmp(name, "xml") == 0)
+                encoding = UA_EXTENSIONOBJECT_ENCODED_XML;
+            else
+                ua_json_error(r, "unknown encoding");
+        } else {
+            ua_json_skip(r);
+        }
+    }
+    if(!typepos)
+        ua_json_error(r, "extension object without a typeId");
+    const char *end = r->pos;
+    r->pos = typepos;
+    if(!bodypos || encoding != UA_EXTENSIONOBJECT_DECODED) {
+        eo->encoding = bodypos ? encoding : UA_EXTENSIONOBJECT_ENCODED_NOBODY;
+        ua_json_decode_nodeid(r, &eo->content.encoded.typeId);
+        if(bodypos) {
+            r->pos = bodypos;
+            if(encoding == UA_EXTENSIONOBJECT_ENCODED_XML)
+                ua_json_decode_string(r, &eo->content.encoded.body);
+            else
+                ua_json_decode_base64(r, &eo->content.encoded.body);
+        }
+        r->pos = end;
+        return;
+    }
+    UA_NodeId typeId;
+    UA_NodeId_init(&typeId);
+    ua_json_decode_nodeid(r, &typeId);
+    const UA_DataType *type = ua_findtype_id(&typeId);
+    UA_NodeId_deleteMembers(&typeId);
+    if(!type)
+        ua_json_error(r, "unknown extension object type");
+    eo->content.decoded.data = UA_new(type);
+    if(!eo->content.decoded.data)
+        luaL_error(r->L, "Out of memory");
+    eo->content.decoded.type = type;
+    eo->encoding = UA_EXTENSIONOBJECT_DECODED;
+    r->pos = bodypos;
+    ua_json_decode(r, eo->content.decoded.data, type);
+    r->pos = end;
+}
+
+static void
+ua_json_decode_datavalue(ua_json_reader *r, UA_DataValue *v) {
+    char key[64];
+    UA_Boolean first = true;
+    while(ua_json_nextkey(r, &first, key, sizeof(key))) {
+        if(ua_json_isnull(r))
+            continue;
+        if(strcmp(key, "value") == 0) {
+            v->hasValue = true;
+            ua_json_decode_variant(r, &v->value);
+        } else if(strcmp(key, "status") == 0) {
+            v->hasStatus = true;
+            v->status = (UA_StatusCode)ua_json_decode_uint(r, UA_UINT32_MAX);
+        } else if(strcmp(key, "sourceTimestamp") == 0) {
+            v->hasSourceTimestamp = true;
+            ua_json_decode_datetime(r, &v->sourceTimestamp);
+        } else if(strcmp(key, "sourcePicoseconds") == 0) {
+            v->hasSourcePicoseconds = true;
+            v->sourcePicoseconds = (UA_UInt16)ua_json_decode_uint(r, UA_UINT16_MAX);
+        } else if(strcmp(key, "serverTimestamp") == 0) {
+            v->hasServerTimestamp = true;
+            ua_json_decode_datetime(r, &v->serverTimestamp);
+        } else if(strcmp(key, "serverPicoseconds") == 0) {
+            v->hasServerPicoseconds = true;
+            v->serverPicoseconds = (UA_UInt16)ua_json_decode_uint(r, UA_UINT16_MAX);
+        } else {
+            ua_json_skip(r);
+        }
+    }
+}
+
+static void
+ua_json_decode_diagnosticinfo(ua_json_reader *r, UA_DiagnosticInfo *di) {
+    char key[64];
+    UA_Boolean first = true;
+    while(ua_json_nextkey(r, &first, key, sizeof(key))) {
+        if(ua_json_isnull(r))
+            continue;
+        if(strcmp(key, "symbolicId") == 0) {
+            di->hasSymbolicId = true;
+            di->symbolicId = (UA_Int32)ua_json_decode_int(r, UA_INT32_MIN, UA_INT32_MAX);
+        } else if(strcmp(key, "namespaceUri") == 0) {
+            di->hasNamespaceUri = true;
+            di->namespaceUri = (UA_Int32)ua_json_decode_int(r, UA_INT32_MIN, UA_INT32_MAX);
+        } else if(strcmp(key, "localizedText") == 0) {
+            di->hasLocalizedText = true;
+            di->localizedText = (UA_Int32)ua_json_decode_int(r, UA_INT32_MIN, UA_INT32_MAX);
+        } else if(strcmp(key, "locale") == 0) {
+            di->hasLocale = true;
+            di->locale = (UA_Int32)ua_json_decode_int(r, UA_INT32_MIN, UA_INT32_MAX);
+        } else if(strcmp(key, "additionalInfo") == 0) {
+            di->hasAdditionalInfo = true;
+            ua_json_decode_string(r, &di->additionalInfo);
+        } else if(strcmp(key, "innerStatusCode") == 0) {
+            di->hasInnerStatusCode = true;
+            di->innerStatusCode = (UA_StatusCode)ua_json_decode_uint(r, UA_UINT32_MAX);
+        } else if(strcmp(key, "innerDiagnosticInfo") == 0 && !di->innerDiagnosticInfo) {
+            di->innerDiagnosticInfo = UA_DiagnosticInfo_new();
+            if(!di->innerDiagnosticInfo)
+                luaL_error(r->L, "Out of memory");
+            di->hasInnerDiagnosticInfo = true;
+            ua_json_decode(r, di->innerDiagnosticInfo, &UA_TYPES[UA_TYPES_DIAGNOSTICINFO]);
+        } else {
+            ua_json_skip(r);
+        }
+    }
+}
+
+static void
+ua_json_decode_structure(ua_json_reader *r, void *dst, const UA_DataType *type) {
+    const ua_member *members = ua_members(r->L, type);
+    if(!members)
+        luaL_error(r->L, "Cannot decode ua.types.%s from JSON", type->typeName);
+    char key[128];
+    UA_Boolean first = true;
+    while(ua_json_nextkey(r, &first, key, sizeof(key))) {
+        const ua_member *m = NULL;
+        for(size_t i = 0; i < type->membersSize; i++) {
+            if(strcmp(members[i].name, key) == 0) {
+                m = &members[i];
+                break;
+            }
+        }
+        if(!m) {
+            ua_json_skip(r);
+            continue;
+        }
+        void *member = (void*)((uintptr_t)dst + m->offset);
+        if(m->isArray)
+            ua_json_decode_array(r, member, m->type);
+        else
+            ua_json_decode(r, member, m->type);
+    }
+}
+
+static void
+ua_json_decode_value(ua_json_reader *r, void *dst, const UA_DataType *type) {
+    switch(type->typeIndex) {
+    case UA_TYPES_BOOLEAN:
+        *(UA_Boolean*)dst = ua_json_decode_uint(r, 1) != 0;
+        return;
+    case UA_TYPES_SBYTE:
+        *(UA_SByte*)dst = (UA_SByte)ua_json_decode_int(r, UA_SBYTE_MIN, UA_SBYTE_MAX);
+        return;
+    case UA_TYPES_BYTE:
+        *(UA_Byte*)dst = (UA_Byte)ua_json_decode_uint(r, 255);
+        return;
+    case UA_TYPES_INT16:
+        *(UA_Int16*)dst = (UA_Int16)ua_json_decode_int(r, UA_INT16_MIN, UA_INT16_MAX);
+        return;
+    case UA_TYPES_UINT16:
+        *(UA_UInt16*)dst = (UA_UInt16)ua_json_decode_uint(r, UA_UINT16_MAX);
+        return;
+    case UA_TYPES_INT32:
+        *(UA_Int32*)dst = (UA_Int32)ua_json_decode_int(r, UA_INT32_MIN, UA_INT32_MAX);
+        return;
+    case UA_TYPES_UINT32:
+    case UA_TYPES_STATUSCODE:
+        *(UA_UInt32*)dst = (UA_UInt32)ua_json_decode_uint(r, UA_UINT32_MAX);
+        return;
+    case UA_TYPES_INT64:
+        *(UA_Int64*)dst = ua_json_decode_int(r, INT64_MIN, INT64_MAX);
+        return;
+    case UA_TYPES_UINT64:
+        *(UA_UInt64*)dst = ua_json_decode_uint(r, UINT64_MAX);
+        return;
+    case UA_TYPES_FLOAT:
+        *(UA_Float*)dst = ua_json_decode_float(r);
+        return;
+    case UA_TYPES_DOUBLE:
+        *(UA_Double*)dst = ua_json_decode_double(r);
+        return;
+    case UA_TYPES_STRING:
+    case UA_TYPES_XMLELEMENT:
+        ua_json_decode_string(r, dst);
+        return;
+    case UA_TYPES_BYTESTRING:
+        ua_json_decode_base64(r, dst);
+        return;
+    case UA_TYPES_DATETIME:
+        ua_json_decode_datetime(r, dst);
+        return;
+    case UA_TYPES_GUID:
+        ua_json_decode_guid(r, dst);
+        return;
+    case UA_TYPES_NODEID:
+        ua_json_decode_nodeid(r, dst);
+        return;
+    case UA_TYPES_EXPANDEDNODEID:
+        ua_json_decode_expandednodeid(r, dst);
+        return;
+    case UA_TYPES_LOCALIZEDTEXT:
+        ua_json_decode_localizedtext(r, dst);
+        return;
+    case UA_TYPES_VARIANT:
+        ua_json_decode_variant(r, dst);
+        return;
+    case UA_TYPES_EXTENSIONOBJECT:
+        ua_json_decode_extensionobject(r, dst);
+        return;
+    case UA_TYPES_DATAVALUE:
+        ua_json_decode_datavalue(r, dst);
+        return;
+    case UA_TYPES_DIAGNOSTICINFO:
+        ua_json_decode_diagnosticinfo(r, dst);
+        return;
+    default:
+        ua_json_decode_structure(r, dst, type);
+        return;
+    }
+}
+
+/* dst is initialized. null leaves it untouched. */
+static void
+ua_json_decode(ua_json_reader *r, void *dst, const UA_DataType *type) {
+    if(ua_json_isnull(r))
+        return;
+    ua_json_enter(r);
+    ua_json_decode_value(r, dst, type);
+    r->depth--;
+}
+
+/* member points to the length field that is followed by the data pointer */
+static void
+ua_json_decode_array(ua_json_reader *r, void *member, const UA_DataType *type) {
+    size_t *length = member;
+    void **data = (void**)((uintptr_t)member + sizeof(size_t));
+    UA_Array_delete(*data, *length, type);
+    *data = NULL;
+    *length = 0;
+    if(ua_json_isnull(r))
+        return;
+    ua_json_expect(r, '[');
+    *data = UA_EMPTY_ARRAY_SENTINEL;
+    if(ua_json_peek(r) == ']') {
+        r->pos++;
+        return;
+    }
+    size_t capacity = 0;
+    while(true) {
+        if(*length == capacity) {
+            size_t newcapacity = capacity ? capacity * 2 : 8;
+            void *p = ua_realloc(capacity ? *data : NULL, newcapacity * type->memSize);
+            if(!p)
+                luaL_error(r->L, "Out of memory");
+            memset((void*)((uintptr_t)p + capacity * type->memSize), 0,
+                   (newcapacity - capacity) * type->memSize);
+            *data = p;
+            capacity = newcapacity;
+        }
+        /* count the element before it is written */
+        void *e = (void*)((uintptr_t)*data + *length * type->memSize);
+        (*length)++;
+        ua_json_decode(r, e, type);
+        if(ua_json_peek(r) == ',') {
+            r->pos++;
+            continue;
+        }
+        ua_json_expect(r, ']');
+        break;
+    }
+    if(capacity > *length) {
+        void *p = ua_realloc(*data, *length * type->memSize);
+        if(p)
+            *data = p;
+    }
+}
+
+/* ua.decodeJSON(type, str) returns a value of the type. A JSON array returns
+   an array. */
+int ua_decodejson(lua_State *L) {
+    ua_arena_use(ua_arena_innermost());
+    ua_memory_check(L);
+    lua_getfield(L, LUA_REGISTRYINDEX, "open62541-type");
+    if(!lua_getmetatable(L, 1) || !lua_rawequal(L, -1, -2))
+        return luaL_error(L, "The first argument is not a type");
+    lua_rawgeti(L, 1, 1);
+    const UA_DataType *type = lua_touserdata(L, -1);
+    size_t len;
+    const char *s = luaL_checklstring(L, 2, &len);
+
+    ua_json_reader r = { L, s, s, 0 };
+    if(ua_json_peek(&r) == '[') {
+        ua_array *array = ua_newarray(L, type);
+        ua_json_decode_array(&r, &array->local_length, type);
+        array->capacity = array->local_length;
+    } else {
+        ua_data *data = ua_newdata(L, type);
+        ua_json_decode(&r, data->data, type);
+    }
+    if(ua_json_peek(&r) != '\0' || r.pos != s + len)
+        ua_json_error(&r, "unexpected characters after the value");
+    return 1;
+}
@@ -0,0 +1,702 @@
+// This file is a part of uascript. License is MIT (see LICENSE file)
+
+#include "libua.h"
+
+/* The names of the UA_NS0ID defines (without the prefix) in strcmp order.
+   Generated from open62541.h with
+   grep '#define UA_NS0ID_' open62541.h | awk '{print $2}' | LC_ALL=C sort */
+const ua_nodeid_name ua_nodeid_names[] = {
+    {"ACKNOWLEDGEABLECONDITIONTYPE", UA_NS0ID_ACKNOWLEDGEABLECONDITIONTYPE},
+    {"ACTIVATESESSIONREQUEST", UA_NS0ID_ACTIVATESESSIONREQUEST},
+    {"ACTIVATESESSIONRESPONSE", UA_NS0ID_ACTIVATESESSIONRESPONSE},
+    {"ADDCOMMENTMETHODTYPE", UA_NS0ID_ADDCOMMENTMETHODTYPE},
+    {"ADDNODESITEM", UA_NS0ID_ADDNODESITEM},
+    {"ADDNODESREQUEST", UA_NS0ID_ADDNODESREQUEST},
+    {"ADDNODESRESPONSE", UA_NS0ID_ADDNODESRESPONSE},
+    {"ADDNODESRESULT", UA_NS0ID_ADDNODESRESULT},
+    {"ADDREFERENCESITEM", UA_NS0ID_ADDREFERENCESITEM},
+    {"ADDREFERENCESREQUEST", UA_NS0ID_ADDREFERENCESREQUEST},
+    {"ADDREFERENCESRESPONSE", UA_NS0ID_ADDREFERENCESRESPONSE},
+    {"ADDRESSSPACEFILETYPE", UA_NS0ID_ADDRESSSPACEFILETYPE},
+    {"AGGREGATECONFIGURATION", UA_NS0ID_AGGREGATECONFIGURATION},
+    {"AGGREGATECONFIGURATIONTYPE", UA_NS0ID_AGGREGATECONFIGURATIONTYPE},
+    {"AGGREGATEFILTER", UA_NS0ID_AGGREGATEFILTER},
+    {"AGGREGATEFILTERRESULT", UA_NS0ID_AGGREGATEFILTERRESULT},
+    {"AGGREGATEFUNCTIONTYPE", UA_NS0ID_AGGREGATEFUNCTIONTYPE},
+    {"AGGREGATEFUNCTION_ANNOTATIONCOUNT", UA_NS0ID_AGGREGATEFUNCTION_ANNOTATIONCOUNT},
+    {"AGGREGATEFUNCTION_AVERAGE", UA_NS0ID_AGGREGATEFUNCTION_AVERAGE},
+    {"AGGREGATEFUNCTION_COUNT", UA_NS0ID_AGGREGATEFUNCTION_COUNT},
+    {"AGGREGATEFUNCTION_DELTA", UA_NS0ID_AGGREGATEFUNCTION_DELTA},
+    {"AGGREGATEFUNCTION_DELTABOUNDS", UA_NS0ID_AGGREGATEFUNCTION_DELTABOUNDS},
+    {"AGGREGATEFUNCTION_DURATIONBAD", UA_NS0ID_AGGREGATEFUNCTION_DURATIONBAD},
+    {"AGGREGATEFUNCTION_DURATIONGOOD", UA_NS0ID_AGGREGATEFUNCTION_DURATIONGOOD},
+    {"AGGREGATEFUNCTION_DURATIONINSTATENONZERO", UA_NS0ID_AGGREGATEFUNCTION_DURATIONINSTATENONZERO},
+    {"AGGREGATEFUNCTION_DURATIONINSTATEZERO", UA_NS0ID_AGGREGATEFUNCTION_DURATIONINSTATEZERO},
+    {"AGGREGATEFUNCTION_END", UA_NS0ID_AGGREGATEFUNCTION_END},
+    {"AGGREGATEFUNCTION_ENDBOUND", UA_NS0ID_AGGREGATEFUNCTION_ENDBOUND},
+    {"AGGREGATEFUNCTION_INTERPOLATIVE", UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE},
+    {"AGGREGATEFUNCTION_MAXIMUM", UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM},
+    {"AGGREGATEFUNCTION_MAXIMUM2", UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM2},
+    {"AGGREGATEFUNCTION_MAXIMUMACTUALTIME", UA_NS0ID_AGGREGATEFUNCTION_MAXIMUMACTUALTIME},
+    {"AGGREGATEFUNCTION_MAXIMUMACTUALTIME2", UA_NS0ID_AGGREGATEFUNCTION_MAXIMUMACTUALTIME2},
+    {"AGGREGATEFUNCTION_MINIMUM", UA_NS0ID_AGGREGATEFUNCTION_MINIMUM},
+    {"AGGREGATEFUNCTION_MINIMUM2", UA_NS0ID_AGGREGATEFUNCTION_MINIMUM2},
+    {"AGGREGATEFUNCTION_MINIMUMACTUALTIME", UA_NS0ID_AGGREGATEFUNCTION_MINIMUMACTUALTIME},
+    {"AGGREGATEFUNCTION_MINIMUMACTUALTIME2", UA_NS0ID_AGGREGATEFUNCTION_MINIMUMACTUALTIME2},
+    {"AGGREGATEFUNCTION_NUMBEROFTRANSITIONS", UA_NS0ID_AGGREGATEFUNCTION_NUMBEROFTRANSITIONS},
+    {"AGGREGATEFUNCTION_PERCENTBAD", UA_NS0ID_AGGREGATEFUNCTION_PERCENTBAD},
+    {"AGGREGATEFUNCTION_PERCENTGOOD", UA_NS0ID_AGGREGATEFUNCTION_PERCENTGOOD},
+    {"AGGREGATEFUNCTION_RANGE", UA_NS0ID_AGGREGATEFUNCTION_RANGE},
+    {"AGGREGATEFUNCTION_RANGE2", UA_NS0ID_AGGREGATEFUNCTION_RANGE2},
+    {"AGGREGATEFUNCTION_STANDARDDEVIATIONPOPULATION", UA_NS0ID_AGGREGATEFUNCTION_STANDARDDEVIATIONPOPULATION},
+    {"AGGREGATEFUNCTION_STANDARDDEVIATIONSAMPLE", UA_NS0ID_AGGREGATEFUNCTION_STANDARDDEVIATIONSAMPLE},
+    {"AGGREGATEFUNCTION_START", UA_NS0ID_AGGREGATEFUNCTION_START},
+    {"AGGREGATEFUNCTION_STARTBOUND", UA_NS0ID_AGGREGATEFUNCTION_STARTBOUND},
+    {"AGGREGATEFUNCTION_TIMEAVERAGE", UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE},
+    {"AGGREGATEFUNCTION_TIMEAVERAGE2", UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE2},
+    {"AGGREGATEFUNCTION_TOTAL", UA_NS0ID_AGGREGATEFUNCTION_TOTAL},
+    {"AGGREGATEFUNCTION_TOTAL2", UA_NS0ID_AGGREGATEFUNCTION_TOTAL2},
+    {"AGGREGATEFUNCTION_VARIANCEPOPULATION", UA_NS0ID_AGGREGATEFUNCTION_VARIANCEPOPULATION},
+    {"AGGREGATEFUNCTION_VARIANCESAMPLE", UA_NS0ID_AGGREGATEFUNCTION_VARIANCESAMPLE},
+    {"AGGREGATEFUNCTION_WORSTQUALITY", UA_NS0ID_AGGREGATEFUNCTION_WORSTQUALITY},
+    {"AGGREGATEFUNCTION_WORSTQUALITY2", UA_NS0ID_AGGREGATEFUNCTION_WORSTQUALITY2},
+    {"AGGREGATES", UA_NS0ID_AGGREGATES},
+    {"ALARMCONDITIONTYPE", UA_NS0ID_ALARMCONDITIONTYPE},
+    {"ALLOWNULLS", UA_NS0ID_ALLOWNULLS},
+    {"ALWAYSGENERATESEVENT", UA_NS0ID_ALWAYSGENERATESEVENT},
+    {"ANALOGITEMTYPE", UA_NS0ID_ANALOGITEMTYPE},
+    {"ANNOTATION", UA_NS0ID_ANNOTATION},
+    {"ANNOTATIONS", UA_NS0ID_ANNOTATIONS},
+    {"ANONYMOUSIDENTITYTOKEN", UA_NS0ID_ANONYMOUSIDENTITYTOKEN},
+    {"APPLICATIONDESCRIPTION", UA_NS0ID_APPLICATIONDESCRIPTION},
+    {"APPLICATIONINSTANCECERTIFICATE", UA_NS0ID_APPLICATIONINSTANCECERTIFICATE},
+    {"APPLICATIONTYPE", UA_NS0ID_APPLICATIONTYPE},
+    {"ARGUMENT", UA_NS0ID_ARGUMENT},
+    {"ARRAYITEMTYPE", UA_NS0ID_ARRAYITEMTYPE},
+    {"ATTRIBUTEOPERAND", UA_NS0ID_ATTRIBUTEOPERAND},
+    {"ATTRIBUTEWRITEMASK", UA_NS0ID_ATTRIBUTEWRITEMASK},
+    {"ATTRIBUTEWRITEMASK_ENUMVALUES", UA_NS0ID_ATTRIBUTEWRITEMASK_ENUMVALUES},
+    {"AUDITACTIVATESESSIONEVENTTYPE", UA_NS0ID_AUDITACTIVATESESSIONEVENTTYPE},
+    {"AUDITADDNODESEVENTTYPE", UA_NS0ID_AUDITADDNODESEVENTTYPE},
+    {"AUDITADDREFERENCESEVENTTYPE", UA_NS0ID_AUDITADDREFERENCESEVENTTYPE},
+    {"AUDITCANCELEVENTTYPE", UA_NS0ID_AUDITCANCELEVENTTYPE},
+    {"AUDITCERTIFICATEDATAMISMATCHEVENTTYPE", UA_NS0ID_AUDITCERTIFICATEDATAMISMATCHEVENTTYPE},
+    {"AUDITCERTIFICATEEVENTTYPE", UA_NS0ID_AUDITCERTIFICATEEVENTTYPE},
+    {"AUDITCERTIFICATEEXPIREDEVENTTYPE", UA_NS0ID_AUDITCERTIFICATEEXPIREDEVENTTYPE},
+    {"AUDITCERTIFICATEINVALIDEVENTTYPE", UA_NS0ID_AUDITCERTIFICATEINVALIDEVENTTYPE},
+    {"AUDITCERTIFICATEMISMATCHEVENTTYPE", UA_NS0ID_AUDITCERTIFICATEMISMATCHEVENTTYPE},
+    {"AUDITCERTIFICATEREVOKEDEVENTTYPE", UA_NS0ID_AUDITCERTIFICATEREVOKEDEVENTTYPE},
+    {"AUDITCERTIFICATEUNTRUSTEDEVENTTYPE", UA_NS0ID_AUDITCERTIFICATEUNTRUSTEDEVENTTYPE},
+    {"AUDITCHANNELEVENTTYPE", UA_NS0ID_AUDITCHANNELEVENTTYPE},
+    {"AUDITCONDITIONACKNOWLEDGEEVENTTYPE", UA_NS0ID_AUDITCONDITIONACKNOWLEDGEEVENTTYPE},
+    {"AUDITCONDITIONCOMMENTEVENTTYPE", UA_NS0ID_AUDITCONDITIONCOMMENTEVENTTYPE},
+    {"AUDITCONDITIONCONFIRMEVENTTYPE", UA_NS0ID_AUDITCONDITIONCONFIRMEVENTTYPE},
+    {"AUDITCONDITIONENABLEEVENTTYPE", UA_NS0ID_AUDITCONDITIONENABLEEVENTTYPE},
+    {"AUDITCONDITIONEVENTTYPE", UA_NS0ID_AUDITCONDITIONEVENTTYPE},
+    {"AUDITCONDITIONRESPONDEVENTTYPE", UA_NS0ID_AUDITCONDITIONRESPONDEVENTTYPE},
+    {"AUDITCONDITIONSHELVINGEVENTTYPE", UA_NS0ID_AUDITCONDITIONSHELVINGEVENTTYPE},
+    {"AUDITCREATESESSIONEVENTTYPE", UA_NS0ID_AUDITCREATESESSIONEVENTTYPE},
+    {"AUDITDELETENODESEVENTTYPE", UA_NS0ID_AUDITDELETENODESEVENTTYPE},
+    {"AUDITDELETEREFERENCESEVENTTYPE", UA_NS0ID_AUDITDELETEREFERENCESEVENTTYPE},
+    {"AUDITEVENTTYPE", UA_NS0ID_AUDITEVENTTYPE},
+    {"AUDITHISTORYATTIMEDELETEEVENTTYPE", UA_NS0ID_AUDITHISTORYATTIMEDELETEEVENTTYPE},
+    {"AUDITHISTORYDELETEEVENTTYPE", UA_NS0ID_AUDITHISTORYDELETEEVENTTYPE},
+    {"AUDITHISTORYEVENTDELETEEVENTTYPE", UA_NS0ID_AUDITHISTORYEVENTDELETEEVENTTYPE},
+    {"AUDITHISTORYEVENTUPDATEEVENTTYPE", UA_NS0ID_AUDITHISTORYEVENTUPDATEEVENTTYPE},
+    {"AUDITHISTORYRAWMODIFYDELETEEVENTTYPE", UA_NS0ID_AUDITHISTORYRAWMODIFYDELETEEVENTTYPE},
+    {"AUDITHISTORYUPDATEEVENTTYPE", UA_NS0ID_AUDITHISTORYUPDATEEVENTTYPE},
+    {"AUDITHISTORYVALUEUPDATEEVENTTYPE", UA_NS0ID_AUDITHISTORYVALUEUPDATEEVENTTYPE},
+    {"AUDITNODEMANAGEMENTEVENTTYPE", UA_NS0ID_AUDITNODEMANAGEMENTEVENTTYPE},
+    {"AUDITOPENSECURECHANNELEVENTTYPE", UA_NS0ID_AUDITOPENSECURECHANNELEVENTTYPE},
+    {"AUDITPROGRAMTRANSITIONEVENTTYPE", UA_NS0ID_AUDITPROGRAMTRANSITIONEVENTTYPE},
+    {"AUDITSECURITYEVENTTYPE", UA_NS0ID_AUDITSECURITYEVENTTYPE},
+    {"AUDITSESSIONEVENTTYPE", UA_NS0ID_AUDITSESSIONEVENTTYPE},
+    {"AUDITUPDATEEVENTTYPE", UA_NS0ID_AUDITUPDATEEVENTTYPE},
+    {"AUDITUPDATEMETHODEVENTTYPE", UA_NS0ID_AUDITUPDATEMETHODEVENTTYPE},
+    {"AUDITUPDATESTATEEVENTTYPE", UA_NS0ID_AUDITUPDATESTATEEVENTTYPE},
+    {"AUDITURLMISMATCHEVENTTYPE", UA_NS0ID_AUDITURLMISMATCHEVENTTYPE},
+    {"AUDITWRITEUPDATEEVENTTYPE", UA_NS0ID_AUDITWRITEUPDATEEVENTTYPE},
+    {"AXISINFORMATION", UA_NS0ID_AXISINFORMATION},
+    {"AXISSCALEENUMERATION", UA_NS0ID_AXISSCALEENUMERATION},
+    {"AXISSCALEENUMERATION_ENUMSTRINGS", UA_NS0ID_AXISSCALEENUMERATION_ENUMSTRINGS},
+    {"BASECONDITIONCLASSTYPE", UA_NS0ID_BASECONDITIONCLASSTYPE},
+    {"BASEDATATYPE", UA_NS0ID_BASEDATATYPE},
+    {"BASEDATAVARIABLETYPE", UA_NS0ID_BASEDATAVARIABLETYPE},
+    {"BASEEVENTTYPE", UA_NS0ID_BASEEVENTTYPE},
+    {"BASEMODELCHANGEEVENTTYPE", UA_NS0ID_BASEMODELCHANGEEVENTTYPE},
+    {"BASEOBJECTTYPE", UA_NS0ID_BASEOBJECTTYPE},
+    {"BASEVARIABLETYPE", UA_NS0ID_BASEVARIABLETYPE},
+    {"BITFIELDMASKDATATYPE", UA_NS0ID_BITFIELDMASKDATATYPE},
+    {"BOOLEAN", UA_NS0ID_BOOLEAN},
+    {"BROWSEDESCRIPTION", UA_NS0ID_BROWSEDESCRIPTION},
+    {"BROWSEDIRECTION", UA_NS0ID_BROWSEDIRECTION},
+    {"BROWSEDIRECTION_ENUMSTRINGS", UA_NS0ID_BROWSEDIRECTION_ENUMSTRINGS},
+    {"BROWSENEXTREQUEST", UA_NS0ID_BROWSENEXTREQUEST},
+    {"BROWSENEXTRESPONSE", UA_NS0ID_BROWSENEXTRESPONSE},
+    {"BROWSEPATH", UA_NS0ID_BROWSEPATH},
+    {"BROWSEPATHRESULT", UA_NS0ID_BROWSEPATHRESULT},
+    {"BROWSEPATHTARGET", UA_NS0ID_BROWSEPATHTARGET},
+    {"BROWSEREQUEST", UA_NS0ID_BROWSEREQUEST},
+    {"BROWSERESPONSE", UA_NS0ID_BROWSERESPONSE},
+    {"BROWSERESULT", UA_NS0ID_BROWSERESULT},
+    {"BROWSERESULTMASK", UA_NS0ID_BROWSERESULTMASK},
+    {"BROWSERESULTMASK_ENUMVALUES", UA_NS0ID_BROWSERESULTMASK_ENUMVALUES},
+    {"BUILDINFO", UA_NS0ID_BUILDINFO},
+    {"BUILDINFOTYPE", UA_NS0ID_BUILDINFOTYPE},
+    {"BYTE", UA_NS0ID_BYTE},
+    {"BYTESTRING", UA_NS0ID_BYTESTRING},
+    {"CALLMETHODREQUEST", UA_NS0ID_CALLMETHODREQUEST},
+    {"CALLMETHODRESULT", UA_NS0ID_CALLMETHODRESULT},
+    {"CALLREQUEST", UA_NS0ID_CALLREQUEST},
+    {"CALLRESPONSE", UA_NS0ID_CALLRESPONSE},
+    {"CANCELREQUEST", UA_NS0ID_CANCELREQUEST},
+    {"CANCELRESPONSE", UA_NS0ID_CANCELRESPONSE},
+    {"CHANNELSECURITYTOKEN", UA_NS0ID_CHANNELSECURITYTOKEN},
+    {"CLOSEMETHODTYPE", UA_NS0ID_CLOSEMETHODTYPE},
+    {"CLOSESECURECHANNELREQUEST", UA_NS0ID_CLOSESECURECHANNELREQUEST},
+    {"CLOSESECURECHANNELRESPONSE", UA_NS0ID_CLOSESECURECHANNELRESPONSE},
+    {"CLOSESESSIONREQUEST", UA_NS0ID_CLOSESESSIONREQUEST},
+    {"CLOSESESSIONRESPONSE", UA_NS0ID_CLOSESESSIONRESPONSE},
+    {"COMPLEXNUMBERTYPE", UA_NS0ID_COMPLEXNUMBERTYPE},
+    {"COMPLIANCELEVEL", UA_NS0ID_COMPLIANCELEVEL},
+    {"COMPLIANCELEVEL_ENUMSTRINGS", UA_NS0ID_COMPLIANCELEVEL_ENUMSTRINGS},
+    {"CONDITIONREFRESHMETHODTYPE", UA_NS0ID_CONDITIONREFRESHMETHODTYPE},
+    {"CONDITIONTYPE", UA_NS0ID_CONDITIONTYPE},
+    {"CONDITIONVARIABLETYPE", UA_NS0ID_CONDITIONVARIABLETYPE},
+    {"CONTENTFILTER", UA_NS0ID_CONTENTFILTER},
+    {"CONTENTFILTERELEMENT", UA_NS0ID_CONTENTFILTERELEMENT},
+    {"CONTENTFILTERELEMENTRESULT", UA_NS0ID_CONTENTFILTERELEMENTRESULT},
+    {"CONTENTFILTERRESULT", UA_NS0ID_CONTENTFILTERRESULT},
+    {"CONTINUATIONPOINT", UA_NS0ID_CONTINUATIONPOINT},
+    {"COUNTER", UA_NS0ID_COUNTER},
+    {"CREATEMONITOREDITEMSREQUEST", UA_NS0ID_CREATEMONITOREDITEMSREQUEST},
+    {"CREATEMONITOREDITEMSRESPONSE", UA_NS0ID_CREATEMONITOREDITEMSRESPONSE},
+    {"CREATESESSIONREQUEST", UA_NS0ID_CREATESESSIONREQUEST},
+    {"CREATESESSIONRESPONSE", UA_NS0ID_CREATESESSIONRESPONSE},
+    {"CREATESUBSCRIPTIONREQUEST", UA_NS0ID_CREATESUBSCRIPTIONREQUEST},
+    {"CREATESUBSCRIPTIONRESPONSE", UA_NS0ID_CREATESUBSCRIPTIONRESPONSE},
+    {"CUBEITEMTYPE", UA_NS0ID_CUBEITEMTYPE},
+    {"DATACHANGEFILTER", UA_NS0ID_DATACHANGEFILTER},
+    {"DATACHANGENOTIFICATION", UA_NS0ID_DATACHANGENOTIFICATION},
+    {"DATACHANGETRIGGER", UA_NS0ID_DATACHANGETRIGGER},
+    {"DATACHANGETRIGGER_ENUMSTRINGS", UA_NS0ID_DATACHANGETRIGGER_ENUMSTRINGS},
+    {"DATAITEMTYPE", UA_NS0ID_DATAITEMTYPE},
+    {"DATATYPEATTRIBUTES", UA_NS0ID_DATATYPEATTRIBUTES},
+    {"DATATYPEDESCRIPTIONTYPE", UA_NS0ID_DATATYPEDESCRIPTIONTYPE},
+    {"DATATYPEDICTIONARYTYPE", UA_NS0ID_DATATYPEDICTIONARYTYPE},
+    {"DATATYPEENCODINGTYPE", UA_NS0ID_DATATYPEENCODINGTYPE},
+    {"DATATYPENODE", UA_NS0ID_DATATYPENODE},
+    {"DATATYPESFOLDER", UA_NS0ID_DATATYPESFOLDER},
+    {"DATATYPESYSTEMTYPE", UA_NS0ID_DATATYPESYSTEMTYPE},
+    {"DATAVALUE", UA_NS0ID_DATAVALUE},
+    {"DATE", UA_NS0ID_DATE},
+    {"DATETIME", UA_NS0ID_DATETIME},
+    {"DEADBANDTYPE", UA_NS0ID_DEADBANDTYPE},
+    {"DEFAULTBINARY", UA_NS0ID_DEFAULTBINARY},
+    {"DEFAULTXML", UA_NS0ID_DEFAULTXML},
+    {"DELETEATTIMEDETAILS", UA_NS0ID_DELETEATTIMEDETAILS},
+    {"DELETEEVENTDETAILS", UA_NS0ID_DELETEEVENTDETAILS},
+    {"DELETEMONITOREDITEMSREQUEST", UA_NS0ID_DELETEMONITOREDITEMSREQUEST},
+    {"DELETEMONITOREDITEMSRESPONSE", UA_NS0ID_DELETEMONITOREDITEMSRESPONSE},
+    {"DELETENODESITEM", UA_NS0ID_DELETENODESITEM},
+    {"DELETENODESREQUEST", UA_NS0ID_DELETENODESREQUEST},
+    {"DELETENODESRESPONSE", UA_NS0ID_DELETENODESRESPONSE},
+    {"DELETERAWMODIFIEDDETAILS", UA_NS0ID_DELETERAWMODIFIEDDETAILS},
+    {"DELETEREFERENCESITEM", UA_NS0ID_DELETEREFERENCESITEM},
+    {"DELETEREFERENCESREQUEST", UA_NS0ID_DELETEREFERENCESREQUEST},
+    {"DELETEREFERENCESRESPONSE", UA_NS0ID_DELETEREFERENCESRESPONSE},
+    {"DELETESUBSCRIPTIONSREQUEST", UA_NS0ID_DELETESUBSCRIPTIONSREQUEST},
+    {"DELETESUBSCRIPTIONSRESPONSE", UA_NS0ID_DELETESUBSCRIPTIONSRESPONSE},
+    {"DEVICEFAILUREEVENTTYPE", UA_NS0ID_DEVICEFAILUREEVENTTYPE},
+    {"DIAGNOSTICINFO", UA_NS0ID_DIAGNOSTICINFO},
+    {"DIALOGCONDITIONTYPE", UA_NS0ID_DIALOGCONDITIONTYPE},
+    {"DIALOGRESPONSEMETHODTYPE", UA_NS0ID_DIALOGRESPONSEMETHODTYPE},
+    {"DISCRETEALARMTYPE", UA_NS0ID_DISCRETEALARMTYPE},
+    {"DISCRETEITEMTYPE", UA_NS0ID_DISCRETEITEMTYPE},
+    {"DOUBLE", UA_NS0ID_DOUBLE},
+    {"DOUBLECOMPLEXNUMBERTYPE", UA_NS0ID_DOUBLECOMPLEXNUMBERTYPE},
+    {"DURATION", UA_NS0ID_DURATION},
+    {"ELEMENTOPERAND", UA_NS0ID_ELEMENTOPERAND},
+    {"ENDPOINTCONFIGURATION", UA_NS0ID_ENDPOINTCONFIGURATION},
+    {"ENDPOINTDESCRIPTION", UA_NS0ID_ENDPOINTDESCRIPTION},
+    {"ENDPOINTURLLISTDATATYPE", UA_NS0ID_ENDPOINTURLLISTDATATYPE},
+    {"ENGINEERINGUNITS", UA_NS0ID_ENGINEERINGUNITS},
+    {"ENUMERATION", UA_NS0ID_ENUMERATION},
+    {"ENUMSTRINGS", UA_NS0ID_ENUMSTRINGS},
+    {"ENUMVALUES", UA_NS0ID_ENUMVALUES},
+    {"ENUMVALUETYPE", UA_NS0ID_ENUMVALUETYPE},
+    {"EUINFORMATION", UA_NS0ID_EUINFORMATION},
+    {"EVENTFIELDLIST", UA_NS0ID_EVENTFIELDLIST},
+    {"EVENTFILTER", UA_NS0ID_EVENTFILTER},
+    {"EVENTFILTERRESULT", UA_NS0ID_EVENTFILTERRESULT},
+    {"EVENTNOTIFICATIONLIST", UA_NS0ID_EVENTNOTIFICATIONLIST},
+    {"EVENTQUEUEOVERFLOWEVENTTYPE", UA_NS0ID_EVENTQUEUEOVERFLOWEVENTTYPE},
+    {"EVENTTYPESFOLDER", UA_NS0ID_EVENTTYPESFOLDER},
+    {"EXCEPTIONDEVIATIONFORMAT", UA_NS0ID_EXCEPTIONDEVIATIONFORMAT},
+    {"EXCEPTIONDEVIATIONFORMAT_ENUMSTRINGS", UA_NS0ID_EXCEPTIONDEVIATIONFORMAT_ENUMSTRINGS},
+    {"EXCLUSIVEDEVIATIONALARMTYPE", UA_NS0ID_EXCLUSIVEDEVIATIONALARMTYPE},
+    {"EXCLUSIVELEVELALARMTYPE", UA_NS0ID_EXCLUSIVELEVELALARMTYPE},
+    {"EXCLUSIVELIMITALARMTYPE", UA_NS0ID_EXCLUSIVELIMITALARMTYPE},
+    {"EXCLUSIVELIMITSTATEMACHINETYPE", UA_NS0ID_EXCLUSIVELIMITSTATEMACHINETYPE},
+    {"EXCLUSIVERATEOFCHANGEALARMTYPE", UA_NS0ID_EXCLUSIVERATEOFCHANGEALARMTYPE},
+    {"EXPANDEDNODEID", UA_NS0ID_EXPANDEDNODEID},
+    {"FILETYPE", UA_NS0ID_FILETYPE},
+    {"FILTEROPERAND", UA_NS0ID_FILTEROPERAND},
+    {"FILTEROPERATOR", UA_NS0ID_FILTEROPERATOR},
+    {"FILTEROPERATOR_ENUMSTRINGS", UA_NS0ID_FILTEROPERATOR_ENUMSTRINGS},
+    {"FINDSERVERSREQUEST", UA_NS0ID_FINDSERVERSREQUEST},
+    {"FINDSERVERSRESPONSE", UA_NS0ID_FINDSERVERSRESPONSE},
+    {"FINITESTATEMACHINETYPE", UA_NS0ID_FINITESTATEMACHINETYPE},
+    {"FINITESTATEVARIABLETYPE", UA_NS0ID_FINITESTATEVARIABLETYPE},
+    {"FINITETRANSITIONVARIABLETYPE", UA_NS0ID_FINITETRANSITIONVARIABLETYPE},
+    {"FLOAT", UA_NS0ID_FLOAT},
+    {"FOLDERTYPE", UA_NS0ID_FOLDERTYPE},
+    {"FROMSTATE", UA_NS0ID_FROMSTATE},
+    {"GENERALMODELCHANGEEVENTTYPE", UA_NS0ID_GENERALMODELCHANGEEVENTTYPE},
+    {"GENERATESEVENT", UA_NS0ID_GENERATESEVENT},
+    {"GETENDPOINTSREQUEST", UA_NS0ID_GETENDPOINTSREQUEST},
+    {"GETENDPOINTSRESPONSE", UA_NS0ID_GETENDPOINTSRESPONSE},
+    {"GETMONITOREDITEMSMETHODTYPE", UA_NS0ID_GETMONITOREDITEMSMETHODTYPE},
+    {"GETPOSITIONMETHODTYPE", UA_NS0ID_GETPOSITIONMETHODTYPE},
+    {"GUID", UA_NS0ID_GUID},
+    {"HACONFIGURATION", UA_NS0ID_HACONFIGURATION},
+    {"HACONFIGURATION_AGGREGATECONFIGURATION", UA_NS0ID_HACONFIGURATION_AGGREGATECONFIGURATION},
+    {"HACONFIGURATION_AGGREGATECONFIGURATION_PERCENTDATABAD", UA_NS0ID_HACONFIGURATION_AGGREGATECONFIGURATION_PERCENTDATABAD},
+    {"HACONFIGURATION_AGGREGATECONFIGURATION_PERCENTDATAGOOD", UA_NS0ID_HACONFIGURATION_AGGREGATECONFIGURATION_PERCENTDATAGOOD},
+    {"HACONFIGURATION_AGGREGATECONFIGURATION_TREATUNCERTAINASBAD", UA_NS0ID_HACONFIGURATION_AGGREGATECONFIGURATION_TREATUNCERTAINASBAD},
+    {"HACONFIGURATION_AGGREGATECONFIGURATION_USESLOPEDEXTRAPOLATION", UA_NS0ID_HACONFIGURATION_AGGREGATECONFIGURATION_USESLOPEDEXTRAPOLATION},
+    {"HACONFIGURATION_AGGREGATEFUNCTIONS", UA_NS0ID_HACONFIGURATION_AGGREGATEFUNCTIONS},
+    {"HACONFIGURATION_DEFINITION", UA_NS0ID_HACONFIGURATION_DEFINITION},
+    {"HACONFIGURATION_EXCEPTIONDEVIATION", UA_NS0ID_HACONFIGURATION_EXCEPTIONDEVIATION},
+    {"HACONFIGURATION_EXCEPTIONDEVIATIONFORMAT", UA_NS0ID_HACONFIGURATION_EXCEPTIONDEVIATIONFORMAT},
+    {"HACONFIGURATION_MAXTIMEINTERVAL", UA_NS0ID_HACONFIGURATION_MAXTIMEINTERVAL},
+    {"HACONFIGURATION_MINTIMEINTERVAL", UA_NS0ID_HACONFIGURATION_MINTIMEINTERVAL},
+    {"HACONFIGURATION_STARTOFARCHIVE", UA_NS0ID_HACONFIGURATION_STARTOFARCHIVE},
+    {"HACONFIGURATION_STARTOFONLINEARCHIVE", UA_NS0ID_HACONFIGURATION_STARTOFONLINEARCHIVE},
+    {"HACONFIGURATION_STEPPED", UA_NS0ID_HACONFIGURATION_STEPPED},
+    {"HASCAUSE", UA_NS0ID_HASCAUSE},
+    {"HASCHILD", UA_NS0ID_HASCHILD},
+    {"HASCOMPONENT", UA_NS0ID_HASCOMPONENT},
+    {"HASCONDITION", UA_NS0ID_HASCONDITION},
+    {"HASDESCRIPTION", UA_NS0ID_HASDESCRIPTION},
+    {"HASEFFECT", UA_NS0ID_HASEFFECT},
+    {"HASENCODING", UA_NS0ID_HASENCODING},
+    {"HASEVENTSOURCE", UA_NS0ID_HASEVENTSOURCE},
+    {"HASFALSESUBSTATE", UA_NS0ID_HASFALSESUBSTATE},
+    {"HASHISTORICALCONFIGURATION", UA_NS0ID_HASHISTORICALCONFIGURATION},
+    {"HASMODELLINGRULE", UA_NS0ID_HASMODELLINGRULE},
+    {"HASMODELPARENT", UA_NS0ID_HASMODELPARENT},
+    {"HASNOTIFIER", UA_NS0ID_HASNOTIFIER},
+    {"HASORDEREDCOMPONENT", UA_NS0ID_HASORDEREDCOMPONENT},
+    {"HASPROPERTY", UA_NS0ID_HASPROPERTY},
+    {"HASSUBSTATEMACHINE", UA_NS0ID_HASSUBSTATEMACHINE},
+    {"HASSUBTYPE", UA_NS0ID_HASSUBTYPE},
+    {"HASTRUESUBSTATE", UA_NS0ID_HASTRUESUBSTATE},
+    {"HASTYPEDEFINITION", UA_NS0ID_HASTYPEDEFINITION},
+    {"HIERARCHICALREFERENCES", UA_NS0ID_HIERARCHICALREFERENCES},
+    {"HISTORICALDATACONFIGURATIONTYPE", UA_NS0ID_HISTORICALDATACONFIGURATIONTYPE},
+    {"HISTORICALEVENTFILTER", UA_NS0ID_HISTORICALEVENTFILTER},
+    {"HISTORYDATA", UA_NS0ID_HISTORYDATA},
+    {"HISTORYEVENT", UA_NS0ID_HISTORYEVENT},
+    {"HISTORYEVENTFIELDLIST", UA_NS0ID_HISTORYEVENTFIELDLIST},
+    {"HISTORYMODIFIEDDATA", UA_NS0ID_HISTORYMODIFIEDDATA},
+    {"HISTORYREADDETAILS", UA_NS0ID_HISTORYREADDETAILS},
+    {"HISTORYREADREQUEST", UA_NS0ID_HISTORYREADREQUEST},
+    {"HISTORYREADRESPONSE", UA_NS0ID_HISTORYREADRESPONSE},
+    {"HISTORYREADRESULT", UA_NS0ID_HISTORYREADRESULT},
+    {"HISTORYREADVALUEID", UA_NS0ID_HISTORYREADVALUEID},
+    {"HISTORYSERVERCAPABILITIES", UA_NS0ID_HISTORYSERVERCAPABILITIES},
+    {"HISTORYSERVERCAPABILITIESTYPE", UA_NS0ID_HISTORYSERVERCAPABILITIESTYPE},
+    {"HISTORYSERVERCAPABILITIES_ACCESSHISTORYDATACAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_ACCESSHISTORYDATACAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_ACCESSHISTORYEVENTSCAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_ACCESSHISTORYEVENTSCAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_AGGREGATEFUNCTIONS", UA_NS0ID_HISTORYSERVERCAPABILITIES_AGGREGATEFUNCTIONS},
+    {"HISTORYSERVERCAPABILITIES_DELETEATTIMECAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_DELETEATTIMECAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_DELETEEVENTCAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_DELETEEVENTCAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_DELETERAWCAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_DELETERAWCAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_INSERTANNOTATIONCAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_INSERTANNOTATIONCAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_INSERTDATACAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_INSERTDATACAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_INSERTEVENTCAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_INSERTEVENTCAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_MAXRETURNDATAVALUES", UA_NS0ID_HISTORYSERVERCAPABILITIES_MAXRETURNDATAVALUES},
+    {"HISTORYSERVERCAPABILITIES_MAXRETURNEVENTVALUES", UA_NS0ID_HISTORYSERVERCAPABILITIES_MAXRETURNEVENTVALUES},
+    {"HISTORYSERVERCAPABILITIES_REPLACEDATACAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_REPLACEDATACAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_REPLACEEVENTCAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_REPLACEEVENTCAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_UPDATEDATACAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_UPDATEDATACAPABILITY},
+    {"HISTORYSERVERCAPABILITIES_UPDATEEVENTCAPABILITY", UA_NS0ID_HISTORYSERVERCAPABILITIES_UPDATEEVENTCAPABILITY},
+    {"HISTORYUPDATEDETAILS", UA_NS0ID_HISTORYUPDATEDETAILS},
+    {"HISTORYUPDATEEVENTRESULT", UA_NS0ID_HISTORYUPDATEEVENTRESULT},
+    {"HISTORYUPDATEREQUEST", UA_NS0ID_HISTORYUPDATEREQUEST},
+    {"HISTORYUPDATERESPONSE", UA_NS0ID_HISTORYUPDATERESPONSE},
+    {"HISTORYUPDATERESULT", UA_NS0ID_HISTORYUPDATERESULT},
+    {"HISTORYUPDATETYPE", UA_NS0ID_HISTORYUPDATETYPE},
+    {"ICON", UA_NS0ID_ICON},
+    {"IDTYPE", UA_NS0ID_IDTYPE},
+    {"IMAGE", UA_NS0ID_IMAGE},
+    {"IMAGEBMP", UA_NS0ID_IMAGEBMP},
+    {"IMAGEGIF", UA_NS0ID_IMAGEGIF},
+    {"IMAGEITEMTYPE", UA_NS0ID_IMAGEITEMTYPE},
+    {"IMAGEJPG", UA_NS0ID_IMAGEJPG},
+    {"IMAGEPNG", UA_NS0ID_IMAGEPNG},
+    {"INITIALSTATETYPE", UA_NS0ID_INITIALSTATETYPE},
+    {"INPUTARGUMENTS", UA_NS0ID_INPUTARGUMENTS},
+    {"INSTANCENODE", UA_NS0ID_INSTANCENODE},
+    {"INT16", UA_NS0ID_INT16},
+    {"INT32", UA_NS0ID_INT32},
+    {"INT64", UA_NS0ID_INT64},
+    {"INTEGER", UA_NS0ID_INTEGER},
+    {"INTEGERID", UA_NS0ID_INTEGERID},
+    {"ISSUEDIDENTITYTOKEN", UA_NS0ID_ISSUEDIDENTITYTOKEN},
+    {"LIMITALARMTYPE", UA_NS0ID_LIMITALARMTYPE},
+    {"LITERALOPERAND", UA_NS0ID_LITERALOPERAND},
+    {"LOCALEID", UA_NS0ID_LOCALEID},
+    {"LOCALIZEDTEXT", UA_NS0ID_LOCALIZEDTEXT},
+    {"LOCALTIME", UA_NS0ID_LOCALTIME},
+    {"LOCKTYPE", UA_NS0ID_LOCKTYPE},
+    {"MAINTENANCECONDITIONCLASSTYPE", UA_NS0ID_MAINTENANCECONDITIONCLASSTYPE},
+    {"MAXARRAYLENGTH", UA_NS0ID_MAXARRAYLENGTH},
+    {"MAXSTRINGLENGTH", UA_NS0ID_MAXSTRINGLENGTH},
+    {"MESSAGESECURITYMODE", UA_NS0ID_MESSAGESECURITYMODE},
+    {"MESSAGESECURITYMODE_ENUMSTRINGS", UA_NS0ID_MESSAGESECURITYMODE_ENUMSTRINGS},
+    {"METHODATTRIBUTES", UA_NS0ID_METHODATTRIBUTES},
+    {"METHODNODE", UA_NS0ID_METHODNODE},
+    {"MODELCHANGESTRUCTUREDATATYPE", UA_NS0ID_MODELCHANGESTRUCTUREDATATYPE},
+    {"MODELCHANGESTRUCTUREVERBMASK", UA_NS0ID_MODELCHANGESTRUCTUREVERBMASK},
+    {"MODELCHANGESTRUCTUREVERBMASK_ENUMVALUES", UA_NS0ID_MODELCHANGESTRUCTUREVERBMASK_ENUMVALUES},
+    {"MODELLINGRULETYPE", UA_NS0ID_MODELLINGRULETYPE},
+    {"MODELLINGRULE_EXPOSESITSARRAY", UA_NS0ID_MODELLINGRULE_EXPOSESITSARRAY},
+    {"MODELLINGRULE_EXPOSESITSARRAY_NAMINGRULE", UA_NS0ID_MODELLINGRULE_EXPOSESITSARRAY_NAMINGRULE},
+    {"MODELLINGRULE_MANDATORY", UA_NS0ID_MODELLINGRULE_MANDATORY},
+    {"MODELLINGRULE_MANDATORYPLACEHOLDER", UA_NS0ID_MODELLINGRULE_MANDATORYPLACEHOLDER},
+    {"MODELLINGRULE_MANDATORYPLACEHOLDER_NAMINGRULE", UA_NS0ID_MODELLINGRULE_MANDATORYPLACEHOLDER_NAMINGRULE},
+    {"MODELLINGRULE_MANDATORYSHARED", UA_NS0ID_MODELLINGRULE_MANDATORYSHARED},
+    {"MODELLINGRULE_MANDATORYSHARED_NAMINGRULE", UA_NS0ID_MODELLINGRULE_MANDATORYSHARED_NAMINGRULE},
+    {"MODELLINGRULE_MANDATORY_NAMINGRULE", UA_NS0ID_MODELLINGRULE_MANDATORY_NAMINGRULE},
+    {"MODELLINGRULE_OPTIONAL", UA_NS0ID_MODELLINGRULE_OPTIONAL},
+    {"MODELLINGRULE_OPTIONALPLACEHOLDER", UA_NS0ID_MODELLINGRULE_OPTIONALPLACEHOLDER},
+    {"MODELLINGRULE_OPTIONALPLACEHOLDER_NAMINGRULE", UA_NS0ID_MODELLINGRULE_OPTIONALPLACEHOLDER_NAMINGRULE},
+    {"MODELLINGRULE_OPTIONAL_NAMINGRULE", UA_NS0ID_MODELLINGRULE_OPTIONAL_NAMINGRULE},
+    {"MODIFICATIONINFO", UA_NS0ID_MODIFICATIONINFO},
+    {"MODIFYMONITOREDITEMSREQUEST", UA_NS0ID_MODIFYMONITOREDITEMSREQUEST},
+    {"MODIFYMONITOREDITEMSRESPONSE", UA_NS0ID_MODIFYMONITOREDITEMSRESPONSE},
+    {"MODIFYSUBSCRIPTIONREQUEST", UA_NS0ID_MODIFYSUBSCRIPTIONREQUEST},
+    {"MODIFYSUBSCRIPTIONRESPONSE", UA_NS0ID_MODIFYSUBSCRIPTIONRESPONSE},
+    {"MONITOREDITEMCREATEREQUEST", UA_NS0ID_MONITOREDITEMCREATEREQUEST},
+    {"MONITOREDITEMCREATERESULT", UA_NS0ID_MONITOREDITEMCREATERESULT},
+    {"MONITOREDITEMMODIFYREQUEST", UA_NS0ID_MONITOREDITEMMODIFYREQUEST},
+    {"MONITOREDITEMMODIFYRESULT", UA_NS0ID_MONITOREDITEMMODIFYRESULT},
+    {"MONITOREDITEMNOTIFICATION", UA_NS0ID_MONITOREDITEMNOTIFICATION},
+    {"MONITORINGFILTER", UA_NS0ID_MONITORINGFILTER},
+    {"MONITORINGFILTERRESULT", UA_NS0ID_MONITORINGFILTERRESULT},
+    {"MONITORINGMODE", UA_NS0ID_MONITORINGMODE},
+    {"MONITORINGMODE_ENUMSTRINGS", UA_NS0ID_MONITORINGMODE_ENUMSTRINGS},
+    {"MONITORINGPARAMETERS", UA_NS0ID_MONITORINGPARAMETERS},
+    {"MULTISTATEDISCRETETYPE", UA_NS0ID_MULTISTATEDISCRETETYPE},
+    {"MULTISTATEVALUEDISCRETETYPE", UA_NS0ID_MULTISTATEVALUEDISCRETETYPE},
+    {"NAMESPACEMETADATATYPE", UA_NS0ID_NAMESPACEMETADATATYPE},
+    {"NAMESPACESTYPE", UA_NS0ID_NAMESPACESTYPE},
+    {"NAMINGRULETYPE", UA_NS0ID_NAMINGRULETYPE},
+    {"NDIMENSIONARRAYITEMTYPE", UA_NS0ID_NDIMENSIONARRAYITEMTYPE},
+    {"NETWORKGROUPDATATYPE", UA_NS0ID_NETWORKGROUPDATATYPE},
+    {"NODE", UA_NS0ID_NODE},
+    {"NODEATTRIBUTES", UA_NS0ID_NODEATTRIBUTES},
+    {"NODEATTRIBUTESMASK", UA_NS0ID_NODEATTRIBUTESMASK},
+    {"NODEATTRIBUTESMASK_ENUMVALUES", UA_NS0ID_NODEATTRIBUTESMASK_ENUMVALUES},
+    {"NODECLASS", UA_NS0ID_NODECLASS},
+    {"NODECLASS_ENUMVALUES", UA_NS0ID_NODECLASS_ENUMVALUES},
+    {"NODEID", UA_NS0ID_NODEID},
+    {"NODEREFERENCE", UA_NS0ID_NODEREFERENCE},
+    {"NODETYPEDESCRIPTION", UA_NS0ID_NODETYPEDESCRIPTION},
+    {"NODEVERSION", UA_NS0ID_NODEVERSION},
+    {"NONEXCLUSIVEDEVIATIONALARMTYPE", UA_NS0ID_NONEXCLUSIVEDEVIATIONALARMTYPE},
+    {"NONEXCLUSIVELEVELALARMTYPE", UA_NS0ID_NONEXCLUSIVELEVELALARMTYPE},
+    {"NONEXCLUSIVELIMITALARMTYPE", UA_NS0ID_NONEXCLUSIVELIMITALARMTYPE},
+    {"NONEXCLUSIVERATEOFCHANGEALARMTYPE", UA_NS0ID_NONEXCLUSIVERATEOFCHANGEALARMTYPE},
+    {"NONHIERARCHICALREFERENCES", UA_NS0ID_NONHIERARCHICALREFERENCES},
+    {"NONTRANSPARENTNETWORKREDUNDANCYTYPE", UA_NS0ID_NONTRANSPARENTNETWORKREDUNDANCYTYPE},
+    {"NONTRANSPARENTREDUNDANCYTYPE", UA_NS0ID_NONTRANSPARENTREDUNDANCYTYPE},
+    {"NOTIFICATIONDATA", UA_NS0ID_NOTIFICATIONDATA},
+    {"NOTIFICATIONMESSAGE", UA_NS0ID_NOTIFICATIONMESSAGE},
+    {"NUMBER", UA_NS0ID_NUMBER},
+    {"NUMERICRANGE", UA_NS0ID_NUMERICRANGE},
+    {"OBJECTATTRIBUTES", UA_NS0ID_OBJECTATTRIBUTES},
+    {"OBJECTNODE", UA_NS0ID_OBJECTNODE},
+    {"OBJECTSFOLDER", UA_NS0ID_OBJECTSFOLDER},
+    {"OBJECTTYPEATTRIBUTES", UA_NS0ID_OBJECTTYPEATTRIBUTES},
+    {"OBJECTTYPENODE", UA_NS0ID_OBJECTTYPENODE},
+    {"OBJECTTYPESFOLDER", UA_NS0ID_OBJECTTYPESFOLDER},
+    {"OFFNORMALALARMTYPE", UA_NS0ID_OFFNORMALALARMTYPE},
+    {"OPCBINARYSCHEMA_TYPESYSTEM", UA_NS0ID_OPCBINARYSCHEMA_TYPESYSTEM},
+    {"OPENFILEMODE", UA_NS0ID_OPENFILEMODE},
+    {"OPENFILEMODE_ENUMVALUES", UA_NS0ID_OPENFILEMODE_ENUMVALUES},
+    {"OPENMETHODTYPE", UA_NS0ID_OPENMETHODTYPE},
+    {"OPENSECURECHANNELREQUEST", UA_NS0ID_OPENSECURECHANNELREQUEST},
+    {"OPENSECURECHANNELRESPONSE", UA_NS0ID_OPENSECURECHANNELRESPONSE},
+    {"OPERATIONLIMITSTYPE", UA_NS0ID_OPERATIONLIMITSTYPE},
+    {"OPTIONSETTYPE", UA_NS0ID_OPTIONSETTYPE},
+    {"ORGANIZES", UA_NS0ID_ORGANIZES},
+    {"OUTPUTARGUMENTS", UA_NS0ID_OUTPUTARGUMENTS},
+    {"PARSINGRESULT", UA_NS0ID_PARSINGRESULT},
+    {"PERFORMUPDATETYPE", UA_NS0ID_PERFORMUPDATETYPE},
+    {"PROCESSCONDITIONCLASSTYPE", UA_NS0ID_PROCESSCONDITIONCLASSTYPE},
+    {"PROGRAMDIAGNOSTICDATATYPE", UA_NS0ID_PROGRAMDIAGNOSTICDATATYPE},
+    {"PROGRAMDIAGNOSTICTYPE", UA_NS0ID_PROGRAMDIAGNOSTICTYPE},
+    {"PROGRAMSTATEMACHINETYPE", UA_NS0ID_PROGRAMSTATEMACHINETYPE},
+    {"PROGRAMTRANSITIONAUDITEVENTTYPE", UA_NS0ID_PROGRAMTRANSITIONAUDITEVENTTYPE},
+    {"PROGRAMTRANSITIONEVENTTYPE", UA_NS0ID_PROGRAMTRANSITIONEVENTTYPE},
+    {"PROGRESSEVENTTYPE", UA_NS0ID_PROGRESSEVENTTYPE},
+    {"PROPERTYTYPE", UA_NS0ID_PROPERTYTYPE},
+    {"PUBLISHREQUEST", UA_NS0ID_PUBLISHREQUEST},
+    {"PUBLISHRESPONSE", UA_NS0ID_PUBLISHRESPONSE},
+    {"QUALIFIEDNAME", UA_NS0ID_QUALIFIEDNAME},
+    {"QUERYDATADESCRIPTION", UA_NS0ID_QUERYDATADESCRIPTION},
+    {"QUERYDATASET", UA_NS0ID_QUERYDATASET},
+    {"QUERYFIRSTREQUEST", UA_NS0ID_QUERYFIRSTREQUEST},
+    {"QUERYFIRSTRESPONSE", UA_NS0ID_QUERYFIRSTRESPONSE},
+    {"QUERYNEXTREQUEST", UA_NS0ID_QUERYNEXTREQUEST},
+    {"QUERYNEXTRESPONSE", UA_NS0ID_QUERYNEXTRESPONSE},
+    {"RANGE", UA_NS0ID_RANGE},
+    {"READATTIMEDETAILS", UA_NS0ID_READATTIMEDETAILS},
+    {"READEVENTDETAILS", UA_NS0ID_READEVENTDETAILS},
+    {"READMETHODTYPE", UA_NS0ID_READMETHODTYPE},
+    {"READPROCESSEDDETAILS", UA_NS0ID_READPROCESSEDDETAILS},
+    {"READRAWMODIFIEDDETAILS", UA_NS0ID_READRAWMODIFIEDDETAILS},
+    {"READREQUEST", UA_NS0ID_READREQUEST},
+    {"READRESPONSE", UA_NS0ID_READRESPONSE},
+    {"READVALUEID", UA_NS0ID_READVALUEID},
+    {"REDUNDANCYSUPPORT", UA_NS0ID_REDUNDANCYSUPPORT},
+    {"REDUNDANCYSUPPORT_ENUMSTRINGS", UA_NS0ID_REDUNDANCYSUPPORT_ENUMSTRINGS},
+    {"REDUNDANTSERVERDATATYPE", UA_NS0ID_REDUNDANTSERVERDATATYPE},
+    {"REFERENCEDESCRIPTION", UA_NS0ID_REFERENCEDESCRIPTION},
+    {"REFERENCENODE", UA_NS0ID_REFERENCENODE},
+    {"REFERENCES", UA_NS0ID_REFERENCES},
+    {"REFERENCETYPEATTRIBUTES", UA_NS0ID_REFERENCETYPEATTRIBUTES},
+    {"REFERENCETYPENODE", UA_NS0ID_REFERENCETYPENODE},
+    {"REFERENCETYPESFOLDER", UA_NS0ID_REFERENCETYPESFOLDER},
+    {"REFRESHENDEVENTTYPE", UA_NS0ID_REFRESHENDEVENTTYPE},
+    {"REFRESHREQUIREDEVENTTYPE", UA_NS0ID_REFRESHREQUIREDEVENTTYPE},
+    {"REFRESHSTARTEVENTTYPE", UA_NS0ID_REFRESHSTARTEVENTTYPE},
+    {"REGISTEREDSERVER", UA_NS0ID_REGISTEREDSERVER},
+    {"REGISTERNODESREQUEST", UA_NS0ID_REGISTERNODESREQUEST},
+    {"REGISTERNODESRESPONSE", UA_NS0ID_REGISTERNODESRESPONSE},
+    {"REGISTERSERVERREQUEST", UA_NS0ID_REGISTERSERVERREQUEST},
+    {"REGISTERSERVERRESPONSE", UA_NS0ID_REGISTERSERVERRESPONSE},
+    {"RELATIVEPATH", UA_NS0ID_RELATIVEPATH},
+    {"RELATIVEPATHELEMENT", UA_NS0ID_RELATIVEPATHELEMENT},
+    {"REPUBLISHREQUEST", UA_NS0ID_REPUBLISHREQUEST},
+    {"REPUBLISHRESPONSE", UA_NS0ID_REPUBLISHRESPONSE},
+    {"REQUESTHEADER", UA_NS0ID_REQUESTHEADER},
+    {"RESPONSEHEADER", UA_NS0ID_RESPONSEHEADER},
+    {"ROOTFOLDER", UA_NS0ID_ROOTFOLDER},
+    {"SAMPLINGINTERVALDIAGNOSTICSARRAYTYPE", UA_NS0ID_SAMPLINGINTERVALDIAGNOSTICSARRAYTYPE},
+    {"SAMPLINGINTERVALDIAGNOSTICSDATATYPE", UA_NS0ID_SAMPLINGINTERVALDIAGNOSTICSDATATYPE},
+    {"SAMPLINGINTERVALDIAGNOSTICSTYPE", UA_NS0ID_SAMPLINGINTERVALDIAGNOSTICSTYPE},
+    {"SBYTE", UA_NS0ID_SBYTE},
+    {"SECURITYTOKENREQUESTTYPE", UA_NS0ID_SECURITYTOKENREQUESTTYPE},
+    {"SEMANTICCHANGEEVENTTYPE", UA_NS0ID_SEMANTICCHANGEEVENTTYPE},
+    {"SEMANTICCHANGESTRUCTUREDATATYPE", UA_NS0ID_SEMANTICCHANGESTRUCTUREDATATYPE},
+    {"SERVER", UA_NS0ID_SERVER},
+    {"SERVERCAPABILITIESTYPE", UA_NS0ID_SERVERCAPABILITIESTYPE},
+    {"SERVERDIAGNOSTICSSUMMARYDATATYPE", UA_NS0ID_SERVERDIAGNOSTICSSUMMARYDATATYPE},
+    {"SERVERDIAGNOSTICSSUMMARYTYPE", UA_NS0ID_SERVERDIAGNOSTICSSUMMARYTYPE},
+    {"SERVERDIAGNOSTICSTYPE", UA_NS0ID_SERVERDIAGNOSTICSTYPE},
+    {"SERVERLOCK", UA_NS0ID_SERVERLOCK},
+    {"SERVERLOCK_LOCK", UA_NS0ID_SERVERLOCK_LOCK},
+    {"SERVERLOCK_UNLOCK", UA_NS0ID_SERVERLOCK_UNLOCK},
+    {"SERVERREDUNDANCYTYPE", UA_NS0ID_SERVERREDUNDANCYTYPE},
+    {"SERVERSTATE", UA_NS0ID_SERVERSTATE},
+    {"SERVERSTATE_ENUMSTRINGS", UA_NS0ID_SERVERSTATE_ENUMSTRINGS},
+    {"SERVERSTATUSDATATYPE", UA_NS0ID_SERVERSTATUSDATATYPE},
+    {"SERVERSTATUSTYPE", UA_NS0ID_SERVERSTATUSTYPE},
+    {"SERVERTYPE", UA_NS0ID_SERVERTYPE},
+    {"SERVERVENDORCAPABILITYTYPE", UA_NS0ID_SERVERVENDORCAPABILITYTYPE},
+    {"SERVER_AUDITING", UA_NS0ID_SERVER_AUDITING},
+    {"SERVER_GETMONITOREDITEMS", UA_NS0ID_SERVER_GETMONITOREDITEMS},
+    {"SERVER_GETMONITOREDITEMS_INPUTARGUMENTS", UA_NS0ID_SERVER_GETMONITOREDITEMS_INPUTARGUMENTS},
+    {"SERVER_GETMONITOREDITEMS_OUTPUTARGUMENTS", UA_NS0ID_SERVER_GETMONITOREDITEMS_OUTPUTARGUMENTS},
+    {"SERVER_NAMESPACEARRAY", UA_NS0ID_SERVER_NAMESPACEARRAY},
+    {"SERVER_NAMESPACES", UA_NS0ID_SERVER_NAMESPACES},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_CLOSE", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_CLOSE},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_CLOSE_INPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_CLOSE_INPUTARGUMENTS},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_EXPORTNAMESPACE", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_EXPORTNAMESPACE},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_GETPOSITION", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_GETPOSITION},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_GETPOSITION_INPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_GETPOSITION_INPUTARGUMENTS},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_GETPOSITION_OUTPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_GETPOSITION_OUTPUTARGUMENTS},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_OPEN", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_OPEN},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_OPENCOUNT", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_OPENCOUNT},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_OPEN_INPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_OPEN_INPUTARGUMENTS},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_OPEN_OUTPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_OPEN_OUTPUTARGUMENTS},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_READ", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_READ},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_READ_INPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_READ_INPUTARGUMENTS},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_READ_OUTPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_READ_OUTPUTARGUMENTS},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_SETPOSITION", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_SETPOSITION},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_SETPOSITION_INPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_SETPOSITION_INPUTARGUMENTS},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_SIZE", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_SIZE},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_USERWRITEABLE", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_USERWRITEABLE},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_WRITE", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_WRITE},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_WRITEABLE", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_WRITEABLE},
+    {"SERVER_NAMESPACES_ADDRESSSPACEFILE_WRITE_INPUTARGUMENTS", UA_NS0ID_SERVER_NAMESPACES_ADDRESSSPACEFILE_WRITE_INPUTARGUMENTS},
+    {"SERVER_SERVERARRAY", UA_NS0ID_SERVER_SERVERARRAY},
+    {"SERVER_SERVERCAPABILITIES", UA_NS0ID_SERVER_SERVERCAPABILITIES},
+    {"SERVER_SERVERCAPABILITIES_AGGREGATEFUNCTIONS", UA_NS0ID_SERVER_SERVERCAPABILITIES_AGGREGATEFUNCTIONS},
+    {"SERVER_SERVERCAPABILITIES_LOCALEIDARRAY", UA_NS0ID_SERVER_SERVERCAPABILITIES_LOCALEIDARRAY},
+    {"SERVER_SERVERCAPABILITIES_MAXARRAYLENGTH", UA_NS0ID_SERVER_SERVERCAPABILITIES_MAXARRAYLENGTH},
+    {"SERVER_SERVERCAPABILITIES_MAXBROWSECONTINUATIONPOINTS", UA_NS0ID_SERVER_SERVERCAPABILITIES_MAXBROWSECONTINUATIONPOINTS},
+    {"SERVER_SERVERCAPABILITIES_MAXHISTORYCONTINUATIONPOINTS", UA_NS0ID_SERVER_SERVERCAPABILITIES_MAXHISTORYCONTINUATIONPOINTS},
+    {"SERVER_SERVERCAPABILITIES_MAXQUERYCONTINUATIONPOINTS", UA_NS0ID_SERVER_SERVERCAPABILITIES_MAXQUERYCONTINUATIONPOINTS},
+    {"SERVER_SERVERCAPABILITIES_MAXSTRINGLENGTH", UA_NS0ID_SERVER_SERVERCAPABILITIES_MAXSTRINGLENGTH},
+    {"SERVER_SERVERCAPABILITIES_MINSUPPORTEDSAMPLERATE", UA_NS0ID_SERVER_SERVERCAPABILITIES_MINSUPPORTEDSAMPLERATE},
+    {"SERVER_SERVERCAPABILITIES_MODELLINGRULES", UA_NS0ID_SERVER_SERVERCAPABILITIES_MODELLINGRULES},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXMONITOREDITEMSPERCALL", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXMONITOREDITEMSPERCALL},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERBROWSE", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERBROWSE},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERHISTORYREADDATA", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERHISTORYREADDATA},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERHISTORYREADEVENTS", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERHISTORYREADEVENTS},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERHISTORYUPDATEDATA", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERHISTORYUPDATEDATA},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERHISTORYUPDATEEVENTS", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERHISTORYUPDATEEVENTS},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERMETHODCALL", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERMETHODCALL},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERNODEMANAGEMENT", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERNODEMANAGEMENT},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREAD", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREAD},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREGISTERNODES", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREGISTERNODES},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERTRANSLATEBROWSEPATHSTONODEIDS", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERTRANSLATEBROWSEPATHSTONODEIDS},
+    {"SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERWRITE", UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERWRITE},
+    {"SERVER_SERVERCAPABILITIES_SERVERPROFILEARRAY", UA_NS0ID_SERVER_SERVERCAPABILITIES_SERVERPROFILEARRAY},
+    {"SERVER_SERVERCAPABILITIES_SOFTWARECERTIFICATES", UA_NS0ID_SERVER_SERVERCAPABILITIES_SOFTWARECERTIFICATES},
+    {"SERVER_SERVERDIAGNOSTICS", UA_NS0ID_SERVER_SERVERDIAGNOSTICS},
+    {"SERVER_SERVERDIAGNOSTICS_ENABLEDFLAG", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_ENABLEDFLAG},
+    {"SERVER_SERVERDIAGNOSTICS_SAMPLINGINTERVALDIAGNOSTICSARRAY", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SAMPLINGINTERVALDIAGNOSTICSARRAY},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSESSIONCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSESSIONCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSUBSCRIPTIONCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSUBSCRIPTIONCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CURRENTSESSIONCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CURRENTSESSIONCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CURRENTSUBSCRIPTIONCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CURRENTSUBSCRIPTIONCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_PUBLISHINGINTERVALCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_PUBLISHINGINTERVALCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_REJECTEDREQUESTSCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_REJECTEDREQUESTSCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_REJECTEDSESSIONCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_REJECTEDSESSIONCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SECURITYREJECTEDREQUESTSCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SECURITYREJECTEDREQUESTSCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SECURITYREJECTEDSESSIONCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SECURITYREJECTEDSESSIONCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SERVERVIEWCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SERVERVIEWCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SESSIONABORTCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SESSIONABORTCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SESSIONTIMEOUTCOUNT", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SESSIONTIMEOUTCOUNT},
+    {"SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY},
+    {"SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY_SESSIONDIAGNOSTICSARRAY", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY_SESSIONDIAGNOSTICSARRAY},
+    {"SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY_SESSIONSECURITYDIAGNOSTICSARRAY", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY_SESSIONSECURITYDIAGNOSTICSARRAY},
+    {"SERVER_SERVERDIAGNOSTICS_SUBSCRIPTIONDIAGNOSTICSARRAY", UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SUBSCRIPTIONDIAGNOSTICSARRAY},
+    {"SERVER_SERVERREDUNDANCY", UA_NS0ID_SERVER_SERVERREDUNDANCY},
+    {"SERVER_SERVERREDUNDANCY_CURRENTSERVERID", UA_NS0ID_SERVER_SERVERREDUNDANCY_CURRENTSERVERID},
+    {"SERVER_SERVERREDUNDANCY_REDUNDANCYSUPPORT", UA_NS0ID_SERVER_SERVERREDUNDANCY_REDUNDANCYSUPPORT},
+    {"SERVER_SERVERREDUNDANCY_REDUNDANTSERVERARRAY", UA_NS0ID_SERVER_SERVERREDUNDANCY_REDUNDANTSERVERARRAY},
+    {"SERVER_SERVERREDUNDANCY_SERVERURIARRAY", UA_NS0ID_SERVER_SERVERREDUNDANCY_SERVERURIARRAY},
+    {"SERVER_SERVERSTATUS", UA_NS0ID_SERVER_SERVERSTATUS},
+    {"SERVER_SERVERSTATUS_BUILDINFO", UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO},
+    {"SERVER_SERVERSTATUS_BUILDINFO_BUILDDATE", UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO_BUILDDATE},
+    {"SERVER_SERVERSTATUS_BUILDINFO_BUILDNUMBER", UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO_BUILDNUMBER},
+    {"SERVER_SERVERSTATUS_BUILDINFO_MANUFACTURERNAME", UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO_MANUFACTURERNAME},
+    {"SERVER_SERVERSTATUS_BUILDINFO_PRODUCTNAME", UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO_PRODUCTNAME},
+    {"SERVER_SERVERSTATUS_BUILDINFO_PRODUCTURI", UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO_PRODUCTURI},
+    {"SERVER_SERVERSTATUS_BUILDINFO_SOFTWAREVERSION", UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO_SOFTWAREVERSION},
+    {"SERVER_SERVERSTATUS_CURRENTTIME", UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME},
+    {"SERVER_SERVERSTATUS_SECONDSTILLSHUTDOWN", UA_NS0ID_SERVER_SERVERSTATUS_SECONDSTILLSHUTDOWN},
+    {"SERVER_SERVERSTATUS_SHUTDOWNREASON", UA_NS0ID_SERVER_SERVERSTATUS_SHUTDOWNREASON},
+    {"SERVER_SERVERSTATUS_STARTTIME", UA_NS0ID_SERVER_SERVERSTATUS_STARTTIME},
+    {"SERVER_SERVERSTATUS_STATE", UA_NS0ID_SERVER_SERVERSTATUS_STATE},
+    {"SERVER_SERVICELEVEL", UA_NS0ID_SERVER_SERVICELEVEL},
+    {"SERVER_VENDORSERVERINFO", UA_NS0ID_SERVER_VENDORSERVERINFO},
+    {"SERVICECOUNTERDATATYPE", UA_NS0ID_SERVICECOUNTERDATATYPE},
+    {"SERVICEFAULT", UA_NS0ID_SERVICEFAULT},
+    {"SESSIONAUTHENTICATIONTOKEN", UA_NS0ID_SESSIONAUTHENTICATIONTOKEN},
+    {"SESSIONDIAGNOSTICSARRAYTYPE", UA_NS0ID_SESSIONDIAGNOSTICSARRAYTYPE},
+    {"SESSIONDIAGNOSTICSDATATYPE", UA_NS0ID_SESSIONDIAGNOSTICSDATATYPE},
+    {"SESSIONDIAGNOSTICSOBJECTTYPE", UA_NS0ID_SESSIONDIAGNOSTICSOBJECTTYPE},
+    {"SESSIONDIAGNOSTICSVARIABLETYPE", UA_NS0ID_SESSIONDIAGNOSTICSVARIABLETYPE},
+    {"SESSIONSDIAGNOSTICSSUMMARYTYPE", UA_NS0ID_SESSIONSDIAGNOSTICSSUMMARYTYPE},
+    {"SESSIONSECURITYDIAGNOSTICSARRAYTYPE", UA_NS0ID_SESSIONSECURITYDIAGNOSTICSARRAYTYPE},
+    {"SESSIONSECURITYDIAGNOSTICSDATATYPE", UA_NS0ID_SESSIONSECURITYDIAGNOSTICSDATATYPE},
+    {"SESSIONSECURITYDIAGNOSTICSTYPE", UA_NS0ID_SESSIONSECURITYDIAGNOSTICSTYPE},
+    {"SETMONITORINGMODEREQUEST", UA_NS0ID_SETMONITORINGMODEREQUEST},
+    {"SETMONITORINGMODERESPONSE", UA_NS0ID_SETMONITORINGMODERESPONSE},
+    {"SETPOSITIONMETHODTYPE", UA_NS0ID_SETPOSITIONMETHODTYPE},
+    {"SETPUBLISHINGMODEREQUEST", UA_NS0ID_SETPUBLISHINGMODEREQUEST},
+    {"SETPUBLISHINGMODERESPONSE", UA_NS0ID_SETPUBLISHINGMODERESPONSE},
+    {"SETTRIGGERINGREQUEST", UA_NS0ID_SETTRIGGERINGREQUEST},
+    {"SETTRIGGERINGRESPONSE", UA_NS0ID_SETTRIGGERINGRESPONSE},
+    {"SHELVEDSTATEMACHINETYPE", UA_NS0ID_SHELVEDSTATEMACHINETYPE},
+    {"SIGNATUREDATA", UA_NS0ID_SIGNATUREDATA},
+    {"SIGNEDSOFTWARECERTIFICATE", UA_NS0ID_SIGNEDSOFTWARECERTIFICATE},
+    {"SIMPLEATTRIBUTEOPERAND", UA_NS0ID_SIMPLEATTRIBUTEOPERAND},
+    {"SOFTWARECERTIFICATE", UA_NS0ID_SOFTWARECERTIFICATE},
+    {"STATEMACHINETYPE", UA_NS0ID_STATEMACHINETYPE},
+    {"STATETYPE", UA_NS0ID_STATETYPE},
+    {"STATEVARIABLETYPE", UA_NS0ID_STATEVARIABLETYPE},
+    {"STATUSCHANGENOTIFICATION", UA_NS0ID_STATUSCHANGENOTIFICATION},
+    {"STATUSCODE", UA_NS0ID_STATUSCODE},
+    {"STATUSRESULT", UA_NS0ID_STATUSRESULT},
+    {"STRING", UA_NS0ID_STRING},
+    {"STRUCTURE", UA_NS0ID_STRUCTURE},
+    {"SUBSCRIPTIONACKNOWLEDGEMENT", UA_NS0ID_SUBSCRIPTIONACKNOWLEDGEMENT},
+    {"SUBSCRIPTIONDIAGNOSTICSARRAYTYPE", UA_NS0ID_SUBSCRIPTIONDIAGNOSTICSARRAYTYPE},
+    {"SUBSCRIPTIONDIAGNOSTICSDATATYPE", UA_NS0ID_SUBSCRIPTIONDIAGNOSTICSDATATYPE},
+    {"SUBSCRIPTIONDIAGNOSTICSTYPE", UA_NS0ID_SUBSCRIPTIONDIAGNOSTICSTYPE},
+    {"SUPPORTEDPROFILE", UA_NS0ID_SUPPORTEDPROFILE},
+    {"SYSTEMCONDITIONCLASSTYPE", UA_NS0ID_SYSTEMCONDITIONCLASSTYPE},
+    {"SYSTEMEVENTTYPE", UA_NS0ID_SYSTEMEVENTTYPE},
+    {"SYSTEMOFFNORMALALARMTYPE", UA_NS0ID_SYSTEMOFFNORMALALARMTYPE},
+    {"SYSTEMSTATUSCHANGEEVENTTYPE", UA_NS0ID_SYSTEMSTATUSCHANGEEVENTTYPE},
+    {"TIME", UA_NS0ID_TIME},
+    {"TIMEDSHELVEMETHODTYPE", UA_NS0ID_TIMEDSHELVEMETHODTYPE},
+    {"TIMESTAMPSTORETURN", UA_NS0ID_TIMESTAMPSTORETURN},
+    {"TIMESTAMPSTORETURN_ENUMSTRINGS", UA_NS0ID_TIMESTAMPSTORETURN_ENUMSTRINGS},
+    {"TIMEZONEDATATYPE", UA_NS0ID_TIMEZONEDATATYPE},
+    {"TOSTATE", UA_NS0ID_TOSTATE},
+    {"TRANSFERRESULT", UA_NS0ID_TRANSFERRESULT},
+    {"TRANSFERSUBSCRIPTIONSREQUEST", UA_NS0ID_TRANSFERSUBSCRIPTIONSREQUEST},
+    {"TRANSFERSUBSCRIPTIONSRESPONSE", UA_NS0ID_TRANSFERSUBSCRIPTIONSRESPONSE},
+    {"TRANSITIONEVENTTYPE", UA_NS0ID_TRANSITIONEVENTTYPE},
+    {"TRANSITIONTYPE", UA_NS0ID_TRANSITIONTYPE},
+    {"TRANSITIONVARIABLETYPE", UA_NS0ID_TRANSITIONVARIABLETYPE},
+    {"TRANSLATEBROWSEPATHSTONODEIDSREQUEST", UA_NS0ID_TRANSLATEBROWSEPATHSTONODEIDSREQUEST},
+    {"TRANSLATEBROWSEPATHSTONODEIDSRESPONSE", UA_NS0ID_TRANSLATEBROWSEPATHSTONODEIDSRESPONSE},
+    {"TRANSPARENTREDUNDANCYTYPE", UA_NS0ID_TRANSPARENTREDUNDANCYTYPE},
+    {"TRIPALARMTYPE", UA_NS0ID_TRIPALARMTYPE},
+    {"TWOSTATEDISCRETETYPE", UA_NS0ID_TWOSTATEDISCRETETYPE},
+    {"TWOSTATEVARIABLETYPE", UA_NS0ID_TWOSTATEVARIABLETYPE},
+    {"TYPENODE", UA_NS0ID_TYPENODE},
+    {"TYPESFOLDER", UA_NS0ID_TYPESFOLDER},
+    {"UINT16", UA_NS0ID_UINT16},
+    {"UINT32", UA_NS0ID_UINT32},
+    {"UINT64", UA_NS0ID_UINT64},
+    {"UINTEGER", UA_NS0ID_UINTEGER},
+    {"UNREGISTERNODESREQUEST", UA_NS0ID_UNREGISTERNODESREQUEST},
+    {"UNREGISTERNODESRESPONSE", UA_NS0ID_UNREGISTERNODESRESPONSE},
+    {"UPDATEDATADETAILS", UA_NS0ID_UPDATEDATADETAILS},
+    {"UPDATEEVENTDETAILS", UA_NS0ID_UPDATEEVENTDETAILS},
+    {"UPDATESTRUCTUREDATADETAILS", UA_NS0ID_UPDATESTRUCTUREDATADETAILS},
+    {"USERIDENTITYTOKEN", UA_NS0ID_USERIDENTITYTOKEN},
+    {"USERNAMEIDENTITYTOKEN", UA_NS0ID_USERNAMEIDENTITYTOKEN},
+    {"USERTOKENPOLICY", UA_NS0ID_USERTOKENPOLICY},
+    {"USERTOKENTYPE", UA_NS0ID_USERTOKENTYPE},
+    {"UTCTIME", UA_NS0ID_UTCTIME},
+    {"VALUEASTEXT", UA_NS0ID_VALUEASTEXT},
+    {"VARIABLEATTRIBUTES", UA_NS0ID_VARIABLEATTRIBUTES},
+    {"VARIABLENODE", UA_NS0ID_VARIABLENODE},
+    {"VARIABLETYPEATTRIBUTES", UA_NS0ID_VARIABLETYPEATTRIBUTES},
+    {"VARIABLETYPENODE", UA_NS0ID_VARIABLETYPENODE},
+    {"VARIABLETYPESFOLDER", UA_NS0ID_VARIABLETYPESFOLDER},
+    {"VENDORSERVERINFOTYPE", UA_NS0ID_VENDORSERVERINFOTYPE},
+    {"VIEWATTRIBUTES", UA_NS0ID_VIEWATTRIBUTES},
+    {"VIEWDESCRIPTION", UA_NS0ID_VIEWDESCRIPTION},
+    {"VIEWNODE", UA_NS0ID_VIEWNODE},
+    {"VIEWSFOLDER", UA_NS0ID_VIEWSFOLDER},
+    {"VIEWVERSION", UA_NS0ID_VIEWVERSION},
+    {"WRITEMETHODTYPE", UA_NS0ID_WRITEMETHODTYPE},
+    {"WRITEREQUEST", UA_NS0ID_WRITEREQUEST},
+    {"WRITERESPONSE", UA_NS0ID_WRITERESPONSE},
+    {"WRITEVALUE", UA_NS0ID_WRITEVALUE},
+    {"X509IDENTITYTOKEN", UA_NS0ID_X509IDENTITYTOKEN},
+    {"XMLELEMENT", UA_NS0ID_XMLELEMENT},
+    {"XMLSCHEMA_TYPESYSTEM", UA_NS0ID_XMLSCHEMA_TYPESYSTEM},
+    {"XVTYPE", UA_NS0ID_XVTYPE},
+    {"XYARRAYITEMTYPE", UA_NS0ID_XYARRAYITEMTYPE},
+    {"YARRAYITEMTYPE", UA_NS0ID_YARRAYITEMTYPE},
+};
+
+const size_t ua_nodeid_namesSize = sizeof(ua_nodeid_names) / sizeof(ua_nodeid_name);
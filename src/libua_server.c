@@ -1,15 +1,42 @@
 // This file is a part of uascript. License is MIT (see LICENSE file)
 
+#define _XOPEN_SOURCE 500 /* recursive mutexes */
+#include <pthread.h>
+
 #include "libua.h"
 #include "lualib.h"
 #include "lauxlib.h"
 
+struct callbackdata;
+struct ua_datasource;
+struct ua_resolver;
+
 struct ua_background_server {
-    UA_ServerNetworkLayer nl;
+    UA_ServerNetworkLayer nl; /* first member, the network layer is cast back */
     UA_Server *server;
+    pthread_mutex_t lock; /* held while the server state is used */
+    pthread_t thread;
+    UA_Boolean background;
+    UA_Boolean running;
+    int ref; /* anchors the userdata while the thread runs */
+    size_t (*getJobs)(UA_ServerNetworkLayer *nl, UA_Job **jobs, UA_UInt16 timeout);
+    /* The callbacks take their coroutines from the pool (a table at index 1)
+       on the stack of this thread. Index 2 holds the userdata in a weak
+       table. The thread is only used with the server lock held. */
+    lua_State *L;
+    int threadRef;
+    struct callbackdata *callbacks;
+    struct ua_datasource *datasources;
+    struct ua_resolver *resolvers;
 };
 
+/* Idle coroutines kept for the method callbacks */
+#define LIBUA_CALLBACK_POOLSIZE 16
+
+/* The server state is allocated on the heap and never in the arena of a
+   ua.scope */
 int ua_server_new(lua_State *L) {
+    ua_arena_use(NULL);
     if(!lua_isnumber(L, 1))
         return luaL_error(L, "The 1st argument must be the server port");
     int port = lua_tonumber(L, 1);
@@ -20,37 +47,157 @@ int ua_server_new(lua_State *L) {
     config.networkLayers = &server->nl;
     config.networkLayersSize = 1;
     server->server = UA_Server_new(config);
+    /* recursive, method callbacks use the server while it is locked */
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&server->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    server->background = false;
+    server->running = false;
+    server->ref = LUA_NOREF;
+    server->L = lua_newthread(L);
+    server->threadRef = luaL_ref(L, LUA_REGISTRYINDEX);
+    /* sized up front, returning a coroutine to the pool never allocates */
+    lua_createtable(server->L, LIBUA_CALLBACK_POOLSIZE, 0);
+    lua_newtable(server->L);
+    lua_newtable(server->L);
+    lua_pushliteral(server->L, "v");
+    lua_setfield(server->L, -2, "__mode");
+    lua_setmetatable(server->L, -2);
+    lua_pushvalue(L, -1);
+    lua_xmove(L, server->L, 1);
+    lua_rawseti(server->L, 2, 1);
+    server->callbacks = NULL;
+    server->datasources = NULL;
+    server->resolvers = NULL;
     luaL_setmetatable(L, "open62541-server");
     return 1;
 }
 
+/* Waits for the background thread to finish its iteration and end */
+static void ua_server_join(lua_State *L, struct ua_background_server *server) {
+    if(!server->background)
+        return;
+    pthread_mutex_lock(&server->lock);
+    server->running = false;
+    pthread_mutex_unlock(&server->lock);
+    pthread_join(server->thread, NULL);
+    server->nl.getJobs = server->getJobs;
+    server->background = false;
+    luaL_unref(L, LUA_REGISTRYINDEX, server->ref);
+    server->ref = LUA_NOREF;
+}
+
+static void ua_server_freecallbacks(lua_State *L, struct ua_background_server *server);
+
 int ua_server_gc(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, -1, "open62541-server");
+    ua_server_join(L, server);
     server->nl.deleteMembers(&server->nl);
     UA_Server_delete(server->server);
+    pthread_mutex_destroy(&server->lock);
+    ua_server_freecallbacks(L, server);
+    luaL_unref(L, LUA_REGISTRYINDEX, server->threadRef);
     return 0;
 }
 
 int ua_server_start(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, -1, "open62541-server");
-    lua_pushinteger(L, UA_Server_run_startup(server->server));
+    ua_arena_use(NULL);
+    pthread_mutex_lock(&server->lock);
+    UA_StatusCode retval = UA_Server_run_startup(server->server);
+    pthread_mutex_unlock(&server->lock);
+    lua_pushinteger(L, retval);
     return 1;
 }
 
 int ua_server_iterate(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, -1, "open62541-server");
-    lua_pushnumber(L, UA_Server_run_iterate(server->server, true));
+    if(server->background)
+        return luaL_error(L, "The server runs in the background");
+    ua_arena_use(NULL);
+    pthread_mutex_lock(&server->lock);
+    UA_UInt16 timeout = UA_Server_run_iterate(server->server, true);
+    pthread_mutex_unlock(&server->lock);
+    lua_pushnumber(L, timeout);
     return 1;
 }
 
+/* The background thread releases the server lock while it waits for
+   messages. The TCP layer takes the timeout in microseconds, the server
+   computes it in milliseconds. */
+static size_t
+ua_server_getjobs(UA_ServerNetworkLayer *nl, UA_Job **jobs, UA_UInt16 timeout) {
+    struct ua_background_server *server = (struct ua_background_server*)nl;
+    UA_UInt16 usec = timeout < UA_UINT16_MAX / 1000 ? timeout * 1000 : UA_UINT16_MAX;
+    pthread_mutex_unlock(&server->lock);
+    size_t jobsSize = server->getJobs(nl, jobs, usec);
+    pthread_mutex_lock(&server->lock);
+    return jobsSize;
+}
+
+static void * ua_server_thread(void *arg) {
+    struct ua_background_server *server = arg;
+    pthread_mutex_lock(&server->lock);
+    while(server->running)
+        UA_Server_run_iterate(server->server, true);
+    pthread_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+/* Starts the server and iterates it in a native thread. Method callbacks
+   enter the Lua state from that thread, this requires the global lock of the
+   uascript interpreter. */
+int ua_server_start_background(lua_State *L) {
+#ifndef UASCRIPT_GLOBAL_LOCK
+    return luaL_error(L, "Background servers require the uascript interpreter");
+#else
+    struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    if(server->background)
+        return luaL_error(L, "The server already runs in the background");
+    ua_arena_use(NULL);
+    pthread_mutex_lock(&server->lock);
+    UA_StatusCode retval = UA_Server_run_startup(server->server);
+    pthread_mutex_unlock(&server->lock);
+    if(retval != UA_STATUSCODE_GOOD) {
+        lua_pushinteger(L, retval);
+        return 1;
+    }
+    lua_pushvalue(L, 1);
+    server->ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    server->getJobs = server->nl.getJobs;
+    server->nl.getJobs = ua_server_getjobs;
+    server->running = true;
+    if(pthread_create(&server->thread, NULL, ua_server_thread, server) != 0) {
+        server->nl.getJobs = server->getJobs;
+        server->running = false;
+        luaL_unref(L, LUA_REGISTRYINDEX, server->ref);
+        server->ref = LUA_NOREF;
+        return luaL_error(L, "Cannot start the server thread");
+    }
+    server->background = true;
+    lua_pushinteger(L, UA_STATUSCODE_GOOD);
+    return 1;
+#endif
+}
+
 int ua_server_stop(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, -1, "open62541-server");
-    lua_pushinteger(L, UA_Server_run_shutdown(server->server));
+    if(server->background && pthread_equal(server->thread, pthread_self()))
+        return luaL_error(L, "The server cannot be stopped from its own thread");
+    ua_arena_use(NULL);
+    ua_server_join(L, server);
+    pthread_mutex_lock(&server->lock);
+    UA_StatusCode retval = UA_Server_run_shutdown(server->server);
+    pthread_mutex_unlock(&server->lock);
+    lua_pushinteger(L, retval);
     return 1;
 }
 
 int ua_server_add_variablenode(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
     if(!server)
         return luaL_error(L, "function must be called on a server");
     ua_data *requestedNewNodeId = ua_getdata(L, 2, &UA_TYPES[UA_TYPES_NODEID]);
@@ -59,24 +206,25 @@ int ua_server_add_variablenode(lua_State *L) {
     ua_data *browseName = ua_getdata(L, 5, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
     ua_data *typeDefinition = ua_getdata(L, 6, &UA_TYPES[UA_TYPES_NODEID]);
     ua_data *attr = ua_getdata(L, 7, &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES]);
+    ua_variant_decodelazy(L, &((UA_VariableAttributes*)attr->data)->value, attr->scope);
     UA_NodeId result;
     UA_StatusCode retval;
+    pthread_mutex_lock(&server->lock);
     retval = UA_Server_addVariableNode(server->server, *(UA_NodeId*)requestedNewNodeId->data,
                                        *(UA_NodeId*)parentNodeId->data, *(UA_NodeId*)referenceTypeId->data,
                                        *(UA_QualifiedName*)browseName->data, *(UA_NodeId*)typeDefinition->data,
                                        *(UA_VariableAttributes*)attr->data, NULL, &result);
+    pthread_mutex_unlock(&server->lock);
     if(retval != UA_STATUSCODE_GOOD)
         return luaL_error(L, "Statuscode is %f", retval);
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = &UA_TYPES[UA_TYPES_NODEID];
-    data->data = UA_NodeId_new();
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
     *(UA_NodeId*)data->data = result;
-    luaL_setmetatable(L, "open62541-data");
     return 1;
 }
 
 int ua_server_add_objectnode(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
     if(!server)
         return luaL_error(L, "function must be called on a server");
     ua_data *requestedNewNodeId = ua_getdata(L, 2, &UA_TYPES[UA_TYPES_NODEID]);
@@ -87,22 +235,22 @@ int ua_server_add_objectnode(lua_State *L) {
     ua_data *attr = ua_getdata(L, 7, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
     UA_NodeId result;
     UA_StatusCode retval;
+    pthread_mutex_lock(&server->lock);
     retval = UA_Server_addObjectNode(server->server, *(UA_NodeId*)requestedNewNodeId->data,
                                      *(UA_NodeId*)parentNodeId->data, *(UA_NodeId*)referenceTypeId->data,
                                      *(UA_QualifiedName*)browseName->data, *(UA_NodeId*)typeDefinition->data,
                                      *(UA_ObjectAttributes*)attr->data, NULL, &result);
+    pthread_mutex_unlock(&server->lock);
     if(retval != UA_STATUSCODE_GOOD)
         return luaL_error(L, "Statuscode is %f", retval);
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = &UA_TYPES[UA_TYPES_NODEID];
-    data->data = UA_NodeId_new();
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
     *(UA_NodeId*)data->data = result;
-    luaL_setmetatable(L, "open62541-data");
     return 1;
 }
 
 int ua_server_add_objecttypenode(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
     if(!server)
         return luaL_error(L, "function must be called on a server");
     ua_data *requestedNewNodeId = ua_getdata(L, 2, &UA_TYPES[UA_TYPES_NODEID]);
@@ -112,22 +260,22 @@ int ua_server_add_objecttypenode(lua_State *L) {
     ua_data *attr = ua_getdata(L, 6, &UA_TYPES[UA_TYPES_OBJECTTYPEATTRIBUTES]);
     UA_NodeId result;
     UA_StatusCode retval;
+    pthread_mutex_lock(&server->lock);
     retval = UA_Server_addObjectTypeNode(server->server, *(UA_NodeId*)requestedNewNodeId->data,
                                          *(UA_NodeId*)parentNodeId->data, *(UA_NodeId*)referenceTypeId->data,
                                          *(UA_QualifiedName*)browseName->data,
                                          *(UA_ObjectTypeAttributes*)attr->data, NULL, &result);
+    pthread_mutex_unlock(&server->lock);
     if(retval != UA_STATUSCODE_GOOD)
         return luaL_error(L, "Statuscode is %f", retval);
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = &UA_TYPES[UA_TYPES_NODEID];
-    data->data = UA_NodeId_new();
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
     *(UA_NodeId*)data->data = result;
-    luaL_setmetatable(L, "open62541-data");
     return 1;
 }
 
 int ua_server_add_referencetypenode(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
     if(!server)
         return luaL_error(L, "function must be called on a server");
     ua_data *requestedNewNodeId = ua_getdata(L, 2, &UA_TYPES[UA_TYPES_NODEID]);
@@ -137,78 +285,273 @@ int ua_server_add_referencetypenode(lua_State *L) {
     ua_data *attr = ua_getdata(L, 6, &UA_TYPES[UA_TYPES_REFERENCETYPEATTRIBUTES]);
     UA_NodeId result;
     UA_StatusCode retval;
+    pthread_mutex_lock(&server->lock);
     retval = UA_Server_addReferenceTypeNode(server->server, *(UA_NodeId*)requestedNewNodeId->data,
                                             *(UA_NodeId*)parentNodeId->data, *(UA_NodeId*)referenceTypeId->data,
                                             *(UA_QualifiedName*)browseName->data,
                                             *(UA_ReferenceTypeAttributes*)attr->data, NULL, &result);
+    pthread_mutex_unlock(&server->lock);
     if(retval != UA_STATUSCODE_GOOD)
         return luaL_error(L, "Statuscode is %f", retval);
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = &UA_TYPES[UA_TYPES_NODEID];
-    data->data = UA_NodeId_new();
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
     *(UA_NodeId*)data->data = result;
-    luaL_setmetatable(L, "open62541-data");
     return 1;
 }
 
 struct callbackdata {
-    lua_State *L;
-    void* functionindex;
+    struct ua_background_server *server;
+    int function; /* registry reference */
+    UA_UInt32 timeout; /* in ms when the method yields */
+    struct callbackdata *next;
+};
+
+/* Deferred method calls are answered with BadTimeout after */
+#define LIBUA_METHOD_TIMEOUT 10000
+
+/* Data source variables call Lua for their value. The last value is cached
+   for maxAge, so that all reads of the node within the interval cost a single
+   Lua call. */
+struct ua_datasource {
+    struct ua_background_server *server;
+    struct ua_resolver *resolver; /* NULL if read is used */
+    int read; /* registry references */
+    int write; /* LUA_REFNIL if the variable is not writable */
+    UA_DateTime maxAge; /* 0 disables the cache */
+    UA_DateTime cachedAt; /* monotonic, 0 if nothing is cached */
+    UA_Boolean pending; /* part of the Lua call in progress */
+    UA_DataValue cache;
+    struct ua_datasource *next;
+};
+
+/* A resolver reads all data sources of a Read request that share it with a
+   single Lua call */
+struct ua_resolver {
+    struct ua_background_server *server;
+    int function; /* registry reference */
+    struct ua_resolver *next;
+};
+
+static void
+ua_server_freecallbacks(lua_State *L, struct ua_background_server *server) {
+    struct callbackdata *cb = server->callbacks;
+    while(cb) {
+        struct callbackdata *next = cb->next;
+        luaL_unref(L, LUA_REGISTRYINDEX, cb->function);
+        free(cb);
+        cb = next;
+    }
+    server->callbacks = NULL;
+    struct ua_datasource *ds = server->datasources;
+    while(ds) {
+        struct ua_datasource *next = ds->next;
+        luaL_unref(L, LUA_REGISTRYINDEX, ds->read);
+        luaL_unref(L, LUA_REGISTRYINDEX, ds->write);
+        UA_DataValue_deleteMembers(&ds->cache);
+        free(ds);
+        ds = next;
+    }
+    server->datasources = NULL;
+    struct ua_resolver *resolver = server->resolvers;
+    while(resolver) {
+        struct ua_resolver *next = resolver->next;
+        luaL_unref(L, LUA_REGISTRYINDEX, resolver->function);
+        free(resolver);
+        resolver = next;
+    }
+    server->resolvers = NULL;
+}
+
+/* Runs in protected mode with the pool at index 1 */
+static int
+ua_server_popcoroutine(lua_State *L) {
+    lua_Integer n = (lua_Integer)lua_rawlen(L, 1);
+    if(n == 0) {
+        lua_newthread(L);
+        return 1;
+    }
+    lua_rawgeti(L, 1, n);
+    lua_pushnil(L);
+    lua_rawseti(L, 1, n);
+    return 1;
+}
+
+/* Takes an idle coroutine from the pool or creates one. The coroutine stays
+   on the stack of the server thread until it is released. Returns NULL when
+   out of memory. */
+static lua_State *
+ua_server_getcoroutine(lua_State *L) {
+    if(!lua_checkstack(L, 2))
+        return NULL;
+    lua_pushcfunction(L, ua_server_popcoroutine);
+    lua_pushvalue(L, 1);
+    if(lua_pcall(L, 1, 1, 0) != LUA_OK) {
+        lua_pop(L, 1);
+        return NULL;
+    }
+    return lua_tothread(L, -1);
+}
+
+static void
+ua_server_releasecoroutine(lua_State *L, lua_State *co) {
+    lua_settop(co, 0);
+    lua_Integer n = (lua_Integer)lua_rawlen(L, 1);
+    if(n < LIBUA_CALLBACK_POOLSIZE)
+        lua_rawseti(L, 1, n + 1);
+    else
+        lua_pop(L, 1);
+}
+
+/* The state of a method call at index 1 of its coroutine. The uservalue
+   anchors the server while the coroutine is suspended. */
+struct ua_methodcall {
+    struct ua_background_server *server;
+    UA_Variant *output; /* NULL once the call is deferred */
+    size_t outputSize;
+    UA_UInt32 id; /* of the deferred call */
+    UA_StatusCode status;
 };
 
+/* Runs in protected mode with the server locked. Converts the results into
+   the outputs of the call (userdata at index 1). */
+static int
+ua_server_setoutputs(lua_State *L) {
+    struct ua_methodcall *call = lua_touserdata(L, 1);
+    UA_Variant *output = call->output;
+    size_t outputSize = call->outputSize;
+    if(!output) {
+        UA_CallMethodResult *result =
+            UA_Server_getDeferredMethodCall(call->server->server, call->id);
+        output = result ? result->outputArguments : NULL;
+        outputSize = result ? result->outputArgumentsSize : 0;
+    }
+    lua_settop(L, (int)outputSize + 1);
+    ua_arena_use(NULL);
+    for(size_t j = 0; j < outputSize; j++) {
+        ua_fromlua(L, 2 + (int)j, &output[j], &UA_TYPES[UA_TYPES_VARIANT]);
+        if(!output[j].type) /* empty variants cannot be encoded */
+            return luaL_error(L, "Missing output argument %d", (int)j + 1);
+    }
+    return 0;
+}
+
+/* Continues after the method returned. A deferred call is finished in the
+   server, which sends the response. The stack is prepared before the lock is
+   taken, nothing may raise an error while it is held. */
+static int
+ua_server_callmethod_k(lua_State *L, int status, lua_KContext ctx) {
+    struct ua_methodcall *call = lua_touserdata(L, 1);
+    struct ua_background_server *server = call->server;
+    if(status == LUA_OK || status == LUA_YIELD) {
+        luaL_checkstack(L, 2, NULL);
+        lua_pushcfunction(L, ua_server_setoutputs);
+        lua_pushvalue(L, 1);
+        lua_rotate(L, 2, 2);
+    }
+    pthread_mutex_lock(&server->lock);
+    if(status == LUA_OK || status == LUA_YIELD)
+        status = lua_pcall(L, lua_gettop(L) - 2, 0, 0);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(status != LUA_OK && status != LUA_YIELD)
+        retval = UA_STATUSCODE_BADINTERNALERROR;
+    if(call->output)
+        call->status = retval;
+    else
+        UA_Server_finishMethodCall(server->server, call->id, retval);
+    pthread_mutex_unlock(&server->lock);
+    if(retval != UA_STATUSCODE_GOOD)
+        printf("error in the callback: %s\n", lua_tostring(L, -1));
+    return 0;
+}
+
+/* The arguments of a method callback, passed to the coroutine as a light
+   userdata */
+struct ua_methodargs {
+    struct callbackdata *data;
+    const UA_NodeId *objectId;
+    const UA_Variant *input;
+    size_t inputSize;
+    UA_Variant *output;
+    size_t outputSize;
+    const ua_arena *borrow;
+    struct ua_methodcall *call; /* set once the call state is pushed */
+};
+
+/* The body of the coroutine. The call state and the arguments are pushed
+   here, where a memory error is caught by the resume. The method may yield,
+   the outputs are converted when it returns. */
+static int
+ua_server_callmethod(lua_State *L) {
+    struct ua_methodargs *args = lua_touserdata(L, 1);
+    struct ua_background_server *server = args->data->server;
+    lua_settop(L, 0);
+    luaL_checkstack(L, (int)args->inputSize + 3, NULL);
+    struct ua_methodcall *call = lua_newuserdata(L, sizeof(struct ua_methodcall));
+    call->server = server;
+    call->output = args->output;
+    call->outputSize = args->outputSize;
+    call->id = 0;
+    call->status = UA_STATUSCODE_GOOD;
+    args->call = call;
+    lua_rawgeti(server->L, 2, 1);
+    lua_xmove(server->L, L, 1);
+    lua_setuservalue(L, -2);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, args->data->function);
+    ua_pushborrowed(L, args->objectId, &UA_TYPES[UA_TYPES_NODEID], args->borrow);
+    for(size_t i = 0; i < args->inputSize; i++)
+        ua_pushborrowed(L, &args->input[i], &UA_TYPES[UA_TYPES_VARIANT], args->borrow);
+    return ua_server_callmethod_k(L, lua_pcallk(L, lua_gettop(L) - 2, LUA_MULTRET, 0, 0,
+                                                ua_server_callmethod_k), 0);
+}
+
+/* The objectId and the input arguments are passed without a copy. They are
+   valid until the callback returns or yields. A method that yields is
+   deferred and answered when its coroutine is resumed and returns. */
 static UA_StatusCode
 ua_server_methodcallback(void *methodHandle, const UA_NodeId objectId, size_t inputSize,
                          const UA_Variant *input, size_t outputSize, UA_Variant *output) {
     struct callbackdata *data = methodHandle;
-    lua_State *L = lua_newthread(data->L);
-    /* get the function */
-    lua_pushlightuserdata(L, data->functionindex);
-    lua_gettable(L, LUA_REGISTRYINDEX);
-
-    int top = lua_gettop(L);
-    ua_data *id = lua_newuserdata(L, sizeof(ua_data));
-    id->data = UA_NodeId_new();
-    UA_NodeId_copy(&objectId, id->data);
-    id->type = &UA_TYPES[UA_TYPES_NODEID];
-    luaL_setmetatable(L, "open62541-data");
-
-    for(size_t i = 0; i < inputSize; i++) {
-        ua_data *arg = lua_newuserdata(L, sizeof(ua_data));
-        arg->data = UA_Variant_new();
-        UA_Variant_copy(&input[i], arg->data);
-        arg->type = &UA_TYPES[UA_TYPES_VARIANT];
-        luaL_setmetatable(L, "open62541-data");
-    }
-
-    int res = lua_pcall(L, inputSize+1, outputSize, 0); // the first output is the statuscode
-    if(res) {
-        printf("error in the callback: %s\n", lua_tostring(L, -1));
-        return UA_STATUSCODE_BADINTERNALERROR;
+    struct ua_background_server *server = data->server;
+    lua_State *L = ua_server_getcoroutine(server->L);
+    if(!L)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ua_arena *active = ua_arena_current();
+    ua_arena *borrow = ua_arena_push_borrow();
+    if(!borrow) {
+        ua_server_releasecoroutine(server->L, L);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-    for(size_t j = 0; j < outputSize; j++) {
-        ua_data *out = ua_getdata(L, top+j, NULL);
-        if(out) {
-            if(out->type == &UA_TYPES[UA_TYPES_VARIANT])
-                UA_Variant_copy(out->data, &output[j]);
-            else
-                UA_Variant_setScalarCopy(&output[j], out->data, out->type);
-            continue;
-        }
-        ua_array *outarray = luaL_testudata(L, -outputSize-1, "open62541-array");
-        if(outarray) {
-            UA_Variant_setArrayCopy(&output[j], *outarray->data, *outarray->length, outarray->type);
-            continue;
-        }
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
+    struct ua_methodargs args = {data, &objectId, input, inputSize,
+                                 output, outputSize, borrow, NULL};
+    lua_pushcfunction(L, ua_server_callmethod);
+    lua_pushlightuserdata(L, &args);
+    ua_arena_use(NULL);
+    int status = lua_resume(L, NULL, 1);
+    ua_arena_pop(borrow);
+    ua_arena_use(active);
+    struct ua_methodcall *call = args.call;
 
-    lua_pop(data->L, 1); // pop the new thread from the original state
-    return UA_STATUSCODE_GOOD;
+    if(status == LUA_YIELD) {
+        /* whoever resumes the coroutine owns it */
+        lua_pop(server->L, 1);
+        call->output = NULL;
+        call->id = UA_Server_deferMethodCall(server->server, data->timeout);
+        return call->id ? UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY : UA_STATUSCODE_BADINTERNALERROR;
+    }
+    if(status != LUA_OK) {
+        printf("error in the callback: %s\n", lua_tostring(L, -1));
+        lua_pop(server->L, 1); /* the coroutine is dead */
+        return status == LUA_ERRMEM ? UA_STATUSCODE_BADOUTOFMEMORY :
+            UA_STATUSCODE_BADINTERNALERROR;
+    }
+    UA_StatusCode retval = call->status;
+    ua_server_releasecoroutine(server->L, L);
+    return retval;
 }
 
 int ua_server_add_methodnode(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
     ua_data *requestedNewNodeId = ua_getdata(L, 2, &UA_TYPES[UA_TYPES_NODEID]);
     ua_data *parentNodeId = ua_getdata(L, 3, &UA_TYPES[UA_TYPES_NODEID]);
     ua_data *referenceTypeId = ua_getdata(L, 4, &UA_TYPES[UA_TYPES_NODEID]);
@@ -222,16 +565,20 @@ int ua_server_add_methodnode(lua_State *L) {
     ua_array *output = ua_getarray(L, 9);
     if(!output || (output->type && output->type != &UA_TYPES[UA_TYPES_ARGUMENT]))
         return luaL_error(L, "8th argument (outputarguments) is not an array of arguments");
+    lua_Integer timeout = luaL_optinteger(L, 10, LIBUA_METHOD_TIMEOUT);
+    luaL_argcheck(L, timeout >= 0 && timeout <= UA_UINT32_MAX, 10, "the timeout is out of range");
 
     struct callbackdata *cbdata = malloc(sizeof(struct callbackdata));
-
-    /* put the function in the registry */
-    lua_pushlightuserdata(L, cbdata);
+    if(!cbdata)
+        return luaL_error(L, "Out of memory");
     lua_pushvalue(L, 7);
-    lua_settable(L, LUA_REGISTRYINDEX);
-    cbdata->L = L;
-    cbdata->functionindex = (void*)cbdata;
+    cbdata->function = luaL_ref(L, LUA_REGISTRYINDEX);
+    cbdata->server = server;
+    cbdata->timeout = (UA_UInt32)timeout;
+    cbdata->next = server->callbacks;
+    server->callbacks = cbdata;
     UA_NodeId result;
+    pthread_mutex_lock(&server->lock);
     UA_StatusCode retval = UA_Server_addMethodNode(server->server, *(UA_NodeId*)requestedNewNodeId->data,
                                                    *(UA_NodeId*)parentNodeId->data,
                                                    *(UA_NodeId*)referenceTypeId->data,
@@ -240,19 +587,426 @@ int ua_server_add_methodnode(lua_State *L) {
                                                    ua_server_methodcallback, cbdata,
                                                    *input->length, *input->data,
                                                    *output->length, *output->data, &result);
+    pthread_mutex_unlock(&server->lock);
+
+    if(retval != UA_STATUSCODE_GOOD)
+        return luaL_error(L, "Statuscode is %f", retval);
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
+    *(UA_NodeId*)data->data = result;
+    return 1;
+}
+
+/* Converts a result of the read function or the resolver. Raises errors. */
+static void
+ua_server_tovalue(lua_State *L, int index, UA_DataValue *value) {
+    ua_data *data = luaL_testudata(L, index, "open62541-data");
+    if(data && data->type == &UA_TYPES[UA_TYPES_DATAVALUE]) {
+        ua_getdata(L, index, data->type); /* checks the scope */
+        ua_variant_decodelazy(L, &((UA_DataValue*)data->data)->value, data->scope);
+        if(UA_DataValue_copy(data->data, value) != UA_STATUSCODE_GOOD)
+            luaL_error(L, "Out of memory");
+    } else {
+        ua_fromlua(L, index, &value->value, &UA_TYPES[UA_TYPES_VARIANT]);
+        value->hasValue = true;
+    }
+    if(value->hasValue && !value->value.type) /* empty variants cannot be encoded */
+        luaL_error(L, "The data source returned no value");
+}
+
+/* The stale data sources of a read, passed as a light userdata */
+struct ua_readargs {
+    struct ua_datasource *first;
+    const UA_NodeId *nodeIds;
+    const size_t *stale; /* indices into nodeIds */
+    size_t size;
+    UA_DataValue *values;
+    const ua_arena *borrow;
+};
+
+/* Runs in protected mode. Calls the read function with the NodeId, or the
+   resolver with the table of NodeIds. The results are converted into the
+   DataValues. */
+static int
+ua_server_readsources(lua_State *L) {
+    struct ua_readargs *args = lua_touserdata(L, 1);
+    UA_DataValue *values = args->values;
+    if(args->first->resolver) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, args->first->resolver->function);
+        lua_createtable(L, (int)args->size, 0);
+        for(size_t k = 0; k < args->size; k++) {
+            ua_pushborrowed(L, &args->nodeIds[args->stale[k]],
+                            &UA_TYPES[UA_TYPES_NODEID], args->borrow);
+            lua_rawseti(L, -2, (lua_Integer)k + 1);
+        }
+    } else {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, args->first->read);
+        ua_pushborrowed(L, &args->nodeIds[args->stale[0]],
+                        &UA_TYPES[UA_TYPES_NODEID], args->borrow);
+    }
+    lua_call(L, 1, 1);
+    ua_arena_use(NULL);
+    if(!args->first->resolver) {
+        ua_server_tovalue(L, 2, values);
+        return 0;
+    }
+    if(!lua_istable(L, 2))
+        return luaL_error(L, "The resolver must return a table of values");
+    for(size_t i = 0; i < args->size; i++) {
+        if(lua_rawgeti(L, 2, (lua_Integer)i + 1) == LUA_TNIL) {
+            values[i].hasStatus = true;
+            values[i].status = UA_STATUSCODE_BADNODATA;
+        } else {
+            ua_server_tovalue(L, 3, &values[i]);
+        }
+        lua_pop(L, 1);
+    }
+    return 0;
+}
+
+/* Calls Lua for the data sources whose cached value is older than maxAge. The
+   sources of a resolver are read with a single call. A failed call is cached
+   as the status of the value until the next read. */
+static UA_StatusCode
+ua_server_refreshsources(size_t size, struct ua_datasource * const *sources,
+                         const UA_NodeId *nodeIds) {
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    size_t oneIndex;
+    UA_DataValue oneValue;
+    size_t *stale = &oneIndex;
+    UA_DataValue *values = &oneValue;
+    if(size > 1) {
+        stale = malloc(size * sizeof(size_t));
+        values = malloc(size * sizeof(UA_DataValue));
+        if(!stale || !values) {
+            free(stale);
+            free(values);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
+    size_t n = 0;
+    for(size_t i = 0; i < size; i++) {
+        struct ua_datasource *ds = sources[i];
+        if(ds->pending || (ds->cachedAt != 0 && now - ds->cachedAt < ds->maxAge))
+            continue;
+        ds->pending = true; /* duplicates are read once */
+        UA_DataValue_init(&values[n]);
+        stale[n++] = i;
+    }
+
+    if(n > 0) {
+        struct ua_datasource *first = sources[stale[0]];
+        struct ua_background_server *server = first->server;
+        lua_State *L = ua_server_getcoroutine(server->L);
+        ua_arena *active = ua_arena_current();
+        ua_arena *borrow = L ? ua_arena_push_borrow() : NULL;
+        UA_StatusCode retval = UA_STATUSCODE_GOOD;
+        if(borrow) {
+            struct ua_readargs args = {first, nodeIds, stale, n, values, borrow};
+            lua_pushcfunction(L, ua_server_readsources);
+            lua_pushlightuserdata(L, &args);
+            ua_arena_use(NULL);
+            int status = lua_pcall(L, 1, 0, 0);
+            if(status != LUA_OK) {
+                printf("error in the data source: %s\n", lua_tostring(L, -1));
+                retval = status == LUA_ERRMEM ? UA_STATUSCODE_BADOUTOFMEMORY :
+                    UA_STATUSCODE_BADINTERNALERROR;
+            }
+            ua_arena_pop(borrow);
+            ua_arena_use(active);
+        } else {
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        if(L)
+            ua_server_releasecoroutine(server->L, L);
+
+        UA_DateTime sourceTime = UA_DateTime_now();
+        for(size_t k = 0; k < n; k++) {
+            struct ua_datasource *ds = sources[stale[k]];
+            ds->pending = false;
+            UA_DataValue_deleteMembers(&ds->cache);
+            if(retval != UA_STATUSCODE_GOOD) {
+                UA_DataValue_deleteMembers(&values[k]);
+                UA_DataValue_init(&ds->cache);
+                ds->cache.hasStatus = true;
+                ds->cache.status = retval;
+                ds->cachedAt = 0;
+                continue;
+            }
+            if(!values[k].hasSourceTimestamp) {
+                values[k].hasSourceTimestamp = true;
+                values[k].sourceTimestamp = sourceTime;
+            }
+            ds->cache = values[k];
+            ds->cachedAt = now;
+        }
+    }
+
+    if(size > 1) {
+        free(stale);
+        free(values);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Copies the cached value (or its index range) into the DataValue for the
+   client. With move, the value is moved out of the cache instead. */
+static UA_StatusCode
+ua_server_copysource(struct ua_datasource *ds, UA_Boolean includeSourceTimeStamp,
+                     const UA_NumericRange *range, UA_DataValue *value, UA_Boolean move) {
+    UA_DataValue *cache = &ds->cache;
+    value->hasValue = false; /* preset by Service_Read_single */
+    if(cache->hasValue) {
+        UA_StatusCode retval = UA_STATUSCODE_GOOD;
+        if(range) {
+            retval = UA_Variant_copyRange(&cache->value, &value->value, *range);
+        } else if(move) {
+            value->value = cache->value;
+            UA_Variant_init(&cache->value);
+            cache->hasValue = false;
+            ds->cachedAt = 0;
+        } else {
+            retval = UA_Variant_copy(&cache->value, &value->value);
+        }
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+        value->hasValue = true;
+    }
+    value->hasStatus = cache->hasStatus;
+    value->status = cache->status;
+    if(includeSourceTimeStamp) {
+        value->hasSourceTimestamp = cache->hasSourceTimestamp;
+        value->sourceTimestamp = cache->sourceTimestamp;
+        value->hasSourcePicoseconds = cache->hasSourcePicoseconds;
+        value->sourcePicoseconds = cache->sourcePicoseconds;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+ua_server_datasource_read(void *handle, const UA_NodeId nodeid, UA_Boolean includeSourceTimeStamp,
+                          const UA_NumericRange *range, UA_DataValue *value) {
+    struct ua_datasource *ds = handle;
+    UA_StatusCode retval = ua_server_refreshsources(1, &ds, &nodeid);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    /* without a cache, the value is moved out */
+    return ua_server_copysource(ds, includeSourceTimeStamp, range, value, ds->maxAge == 0);
+}
+
+/* Service_Read groups the sources of a resolver. Their handles are the
+   ua_datasource structs. */
+static UA_StatusCode
+ua_server_datasource_readbatch(void *batchHandle, size_t size, void * const *handles,
+                               const UA_NodeId *nodeIds, UA_Boolean includeSourceTimeStamp,
+                               const UA_NumericRange * const *ranges, UA_DataValue * const *values) {
+    struct ua_datasource * const *sources = (struct ua_datasource * const *)handles;
+    UA_StatusCode retval = ua_server_refreshsources(size, sources, nodeIds);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    for(size_t i = 0; i < size; i++) {
+        retval = ua_server_copysource(sources[i], includeSourceTimeStamp, ranges[i], values[i], false);
+        if(retval != UA_STATUSCODE_GOOD) {
+            values[i]->hasStatus = true;
+            values[i]->status = retval;
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The arguments of a write, passed as a light userdata */
+struct ua_writeargs {
+    struct ua_datasource *ds;
+    const UA_NodeId *nodeId;
+    const UA_Variant *data;
+    const ua_arena *borrow;
+    UA_StatusCode status; /* returned by the write function */
+};
+
+/* Runs in protected mode. Calls the write function with the NodeId and the
+   value and stores a returned status code. */
+static int
+ua_server_writesource(lua_State *L) {
+    struct ua_writeargs *args = lua_touserdata(L, 1);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, args->ds->write);
+    ua_pushborrowed(L, args->nodeId, &UA_TYPES[UA_TYPES_NODEID], args->borrow);
+    ua_pushborrowed(L, args->data, &UA_TYPES[UA_TYPES_VARIANT], args->borrow);
+    lua_call(L, 2, 1);
+    if(!lua_isnil(L, 2))
+        ua_fromlua(L, 2, &args->status, &UA_TYPES[UA_TYPES_STATUSCODE]);
+    return 0;
+}
+
+/* The write function always receives the complete value. Writes of an index
+   range are applied to the current value of the source first. */
+static UA_StatusCode
+ua_server_datasource_write(void *handle, const UA_NodeId nodeid,
+                           const UA_Variant *data, const UA_NumericRange *range) {
+    struct ua_datasource *ds = handle;
+    UA_Variant full;
+    UA_Variant_init(&full);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(range) {
+        ds->cachedAt = 0;
+        retval = ua_server_refreshsources(1, &ds, &nodeid);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+        if(!ds->cache.hasValue || ds->cache.value.type != data->type)
+            return UA_STATUSCODE_BADTYPEMISMATCH;
+        retval = UA_Variant_copy(&ds->cache.value, &full);
+        if(retval == UA_STATUSCODE_GOOD)
+            retval = UA_Variant_setRangeCopy(&full, data->data, data->arrayLength, *range);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_Variant_deleteMembers(&full);
+            return retval;
+        }
+        data = &full;
+    }
 
+    struct ua_background_server *server = ds->server;
+    lua_State *L = ua_server_getcoroutine(server->L);
+    ua_arena *active = ua_arena_current();
+    ua_arena *borrow = L ? ua_arena_push_borrow() : NULL;
+    if(!borrow) {
+        if(L)
+            ua_server_releasecoroutine(server->L, L);
+        UA_Variant_deleteMembers(&full);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    struct ua_writeargs args = {ds, &nodeid, data, borrow, UA_STATUSCODE_GOOD};
+    lua_pushcfunction(L, ua_server_writesource);
+    lua_pushlightuserdata(L, &args);
+    ua_arena_use(NULL);
+    int status = lua_pcall(L, 1, 0, 0);
+    retval = args.status;
+    if(status != LUA_OK) {
+        printf("error in the data source: %s\n", lua_tostring(L, -1));
+        retval = status == LUA_ERRMEM ? UA_STATUSCODE_BADOUTOFMEMORY :
+            UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    ua_arena_pop(borrow);
+    ua_arena_use(active);
+    ua_server_releasecoroutine(server->L, L);
+    UA_Variant_deleteMembers(&full);
+    ds->cachedAt = 0; /* the next read sees the written value */
+    return retval;
+}
+
+/* Checks the read function (or resolver), the write function and the maxAge
+   (in ms) at index and the following. The default maxAge is the
+   minimumSamplingInterval. */
+static UA_DataSource
+ua_server_newdatasource(lua_State *L, struct ua_background_server *server, int index,
+                        UA_Double minimumSamplingInterval) {
+    struct ua_resolver *resolver = NULL;
+    if(lua_islightuserdata(L, index)) {
+        resolver = server->resolvers;
+        while(resolver && resolver != lua_touserdata(L, index))
+            resolver = resolver->next;
+        luaL_argcheck(L, resolver != NULL, index, "not a resolver of this server");
+    } else {
+        luaL_checktype(L, index, LUA_TFUNCTION);
+    }
+    if(!lua_isnoneornil(L, index + 1))
+        luaL_checktype(L, index + 1, LUA_TFUNCTION);
+    lua_Number maxAge = luaL_optnumber(L, index + 2, minimumSamplingInterval);
+    luaL_argcheck(L, maxAge >= 0, index + 2, "the maxAge must not be negative");
+
+    struct ua_datasource *ds = malloc(sizeof(struct ua_datasource));
+    if(!ds)
+        luaL_error(L, "Out of memory");
+    ds->server = server;
+    ds->resolver = resolver;
+    ds->read = LUA_NOREF;
+    if(!resolver) {
+        lua_pushvalue(L, index);
+        ds->read = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+    lua_pushvalue(L, index + 1);
+    ds->write = luaL_ref(L, LUA_REGISTRYINDEX); /* LUA_REFNIL is never called */
+    ds->maxAge = (UA_DateTime)(maxAge * UA_MSEC_TO_DATETIME);
+    ds->cachedAt = 0;
+    ds->pending = false;
+    UA_DataValue_init(&ds->cache);
+    ds->next = server->datasources;
+    server->datasources = ds;
+
+    UA_DataSource dataSource;
+    dataSource.handle = ds;
+    dataSource.read = ua_server_datasource_read;
+    dataSource.write = lua_isnoneornil(L, index + 1) ? NULL : ua_server_datasource_write;
+    dataSource.batchHandle = resolver;
+    dataSource.readBatch = resolver ? ua_server_datasource_readbatch : NULL;
+    return dataSource;
+}
+
+/* The resolver is a handle for the read argument of data sources */
+int ua_server_add_resolver(lua_State *L) {
+    struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    luaL_checktype(L, 2, LUA_TFUNCTION);
+    struct ua_resolver *resolver = malloc(sizeof(struct ua_resolver));
+    if(!resolver)
+        return luaL_error(L, "Out of memory");
+    lua_pushvalue(L, 2);
+    resolver->function = luaL_ref(L, LUA_REGISTRYINDEX);
+    resolver->server = server;
+    resolver->next = server->resolvers;
+    server->resolvers = resolver;
+    lua_pushlightuserdata(L, resolver);
+    return 1;
+}
+
+int ua_server_add_datasourcevariablenode(lua_State *L) {
+    struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
+    ua_data *requestedNewNodeId = ua_getdata(L, 2, &UA_TYPES[UA_TYPES_NODEID]);
+    ua_data *parentNodeId = ua_getdata(L, 3, &UA_TYPES[UA_TYPES_NODEID]);
+    ua_data *referenceTypeId = ua_getdata(L, 4, &UA_TYPES[UA_TYPES_NODEID]);
+    ua_data *browseName = ua_getdata(L, 5, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    ua_data *typeDefinition = ua_getdata(L, 6, &UA_TYPES[UA_TYPES_NODEID]);
+    ua_data *attr = ua_getdata(L, 7, &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES]);
+    UA_VariableAttributes *attributes = attr->data;
+    UA_DataSource dataSource =
+        ua_server_newdatasource(L, server, 8, attributes->minimumSamplingInterval);
+    UA_NodeId result;
+    pthread_mutex_lock(&server->lock);
+    UA_StatusCode retval =
+        UA_Server_addDataSourceVariableNode(server->server, *(UA_NodeId*)requestedNewNodeId->data,
+                                            *(UA_NodeId*)parentNodeId->data,
+                                            *(UA_NodeId*)referenceTypeId->data,
+                                            *(UA_QualifiedName*)browseName->data,
+                                            *(UA_NodeId*)typeDefinition->data,
+                                            *attributes, dataSource, &result);
+    pthread_mutex_unlock(&server->lock);
     if(retval != UA_STATUSCODE_GOOD)
         return luaL_error(L, "Statuscode is %f", retval);
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = &UA_TYPES[UA_TYPES_NODEID];
-    data->data = UA_NodeId_new();
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
     *(UA_NodeId*)data->data = result;
-    luaL_setmetatable(L, "open62541-data");
+    return 1;
+}
+
+int ua_server_set_datasource(lua_State *L) {
+    struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
+    ua_data *nodeId = ua_getdata(L, 2, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_Double minimumSamplingInterval = 0;
+    pthread_mutex_lock(&server->lock);
+    UA_Server_readMinimumSamplingInterval(server->server, *(UA_NodeId*)nodeId->data,
+                                          &minimumSamplingInterval);
+    pthread_mutex_unlock(&server->lock);
+    UA_DataSource dataSource = ua_server_newdatasource(L, server, 3, minimumSamplingInterval);
+    pthread_mutex_lock(&server->lock);
+    UA_StatusCode retval =
+        UA_Server_setVariableNode_dataSource(server->server, *(UA_NodeId*)nodeId->data, dataSource);
+    pthread_mutex_unlock(&server->lock);
+    lua_pushinteger(L, retval);
     return 1;
 }
 
 int ua_server_add_reference(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
     if(!server)
         return luaL_error(L, "function must be called on a server");
     ua_data *sourceId = ua_getdata(L, 2, &UA_TYPES[UA_TYPES_NODEID]);
@@ -270,19 +1024,19 @@ int ua_server_add_reference(lua_State *L) {
     else
         target.nodeId = *(UA_NodeId*)targetId->data;
 
+    pthread_mutex_lock(&server->lock);
     UA_StatusCode retval = UA_Server_addReference(server->server, *(UA_NodeId*)sourceId->data,
                                                   *(UA_NodeId*)refTypeId->data,
                                                   target, *(UA_Boolean*)isForward->data);
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = &UA_TYPES[UA_TYPES_STATUSCODE];
-    data->data = UA_StatusCode_new();
+    pthread_mutex_unlock(&server->lock);
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_STATUSCODE]);
     *(UA_StatusCode*)data->data = retval;
-    luaL_setmetatable(L, "open62541-data");
     return 1;
 }
 
 int ua_server_write(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
     if(!server)
         return luaL_error(L, "function must be called on a server");
 
@@ -292,27 +1046,30 @@ int ua_server_write(lua_State *L) {
     lua_Number attrId = lua_tonumber(L, 3);
 
     ua_data *value = ua_getdata(L, 4, NULL);
+    if(value->type == &UA_TYPES[UA_TYPES_VARIANT])
+        ua_variant_decodelazy(L, value->data, value->scope);
 
     UA_StatusCode retval;
+    pthread_mutex_lock(&server->lock);
     if(attrId != UA_ATTRIBUTEID_VALUE) {
         retval = __UA_Server_write(server->server, (UA_NodeId*)sourceId->data,
                                    (UA_AttributeId)attrId, value->type, value->data);
     } else {
+        /* the server copies the value, wrap it without copying */
         UA_Variant v;
         UA_Variant_init(&v);
-        UA_Variant_setScalarCopy(&v, value->data, value->type);
+        UA_Variant_setScalar(&v, value->data, value->type);
         retval = __UA_Server_write(server->server, (UA_NodeId*)sourceId->data,
                                    (UA_AttributeId)attrId, &UA_TYPES[UA_TYPES_VARIANT], &v);
     }
-    UA_WriteValue wv;
-    UA_WriteValue_init(&wv);
-    UA_Variant_setScalar(&wv.value.value, value->data, value->type);
+    pthread_mutex_unlock(&server->lock);
     lua_pushnumber(L, retval);
     return 1;
 }
 
 int ua_server_read(lua_State *L) {
     struct ua_background_server *server = luaL_checkudata (L, 1, "open62541-server");
+    ua_arena_use(NULL);
     if(!server)
         return luaL_error(L, "function must be called on a server");
 
@@ -388,17 +1145,15 @@ int ua_server_read(lua_State *L) {
     default:
         return luaL_error(L, "Unknown attribute");
     }
-    void *v = UA_new(type);
-    UA_StatusCode retval = __UA_Server_read(server->server, sourceId->data, attrId, v);
+    ua_data *data = ua_newdata(L, type);
+    pthread_mutex_lock(&server->lock);
+    UA_StatusCode retval = __UA_Server_read(server->server, sourceId->data, attrId, data->data);
+    pthread_mutex_unlock(&server->lock);
     if(retval != UA_STATUSCODE_GOOD) {
-        UA_delete(v, type);
+        lua_pop(L, 1);
         lua_pushnil(L);
         lua_pushinteger(L, retval);
         return 2;
     }
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = type;
-    data->data = v;
-    luaL_setmetatable(L, "open62541-data");
     return 1;
 }
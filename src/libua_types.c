@@ -1,58 +1,67 @@
 // This file is a part of uascript. License is MIT (see LICENSE file)
 
+#include <errno.h>
 #include "libua.h"
 #include "lualib.h"
 #include "lauxlib.h"
+#include "spinlock.h"
 
-/* try to convert the element to a lua value */
-static void uatolua(lua_State *L, int index) {
-    ua_data *v = luaL_testudata(L, index, "open62541-data");
-    if(!v)
-        return;
-    switch(v->type->typeIndex) {
+/* Push the value as a native Lua value. Returns 0 if there is no native
+   representation. */
+static int ua_pushnative(lua_State *L, const void *p, const UA_DataType *type) {
+    switch(type->typeIndex) {
     case UA_TYPES_BOOLEAN:
-        lua_pushboolean(L, *(UA_Boolean*)v->data);
-        break;
+        lua_pushboolean(L, *(const UA_Boolean*)p);
+        return 1;
     case UA_TYPES_SBYTE:
-        lua_pushinteger(L, *(UA_SByte*)v->data);
-        break;
+        lua_pushinteger(L, *(const UA_SByte*)p);
+        return 1;
     case UA_TYPES_BYTE:
-        lua_pushinteger(L, *(UA_Byte*)v->data);
-        break;
+        lua_pushinteger(L, *(const UA_Byte*)p);
+        return 1;
     case UA_TYPES_INT16:
-        lua_pushinteger(L, *(UA_Int16*)v->data);
-        break;
+        lua_pushinteger(L, *(const UA_Int16*)p);
+        return 1;
     case UA_TYPES_UINT16:
-        lua_pushinteger(L, *(UA_UInt16*)v->data);
-        break;
+        lua_pushinteger(L, *(const UA_UInt16*)p);
+        return 1;
     case UA_TYPES_UINT32:
-        lua_pushinteger(L, *(UA_UInt32*)v->data);
-        break;
+        lua_pushinteger(L, *(const UA_UInt32*)p);
+        return 1;
     case UA_TYPES_INT32:
     case UA_TYPES_STATUSCODE:
-        lua_pushinteger(L, *(UA_Int32*)v->data);
-        break;
+        lua_pushinteger(L, *(const UA_Int32*)p);
+        return 1;
     case UA_TYPES_INT64:
-        lua_pushinteger(L, *(UA_Int64*)v->data);
-        break;
+        lua_pushinteger(L, *(const UA_Int64*)p);
+        return 1;
     case UA_TYPES_UINT64:
-        lua_pushinteger(L, *(UA_UInt64*)v->data);
-        break;
+        lua_pushinteger(L, *(const UA_UInt64*)p);
+        return 1;
     case UA_TYPES_FLOAT:
-        lua_pushnumber(L, *(UA_Float*)v->data);
-        break;
+        lua_pushnumber(L, *(const UA_Float*)p);
+        return 1;
     case UA_TYPES_DOUBLE:
-        lua_pushnumber(L, *(UA_Double*)v->data);
-        break;
+        lua_pushnumber(L, *(const UA_Double*)p);
+        return 1;
     case UA_TYPES_STRING:
     case UA_TYPES_BYTESTRING:
     case UA_TYPES_XMLELEMENT:
-        lua_pushlstring(L, (char*)((UA_String*)v->data)->data, ((UA_String*)v->data)->length);
-        break;
+        lua_pushlstring(L, (const char*)((const UA_String*)p)->data, ((const UA_String*)p)->length);
+        return 1;
     default:
-        return;
+        return 0;
     }
-    lua_replace(L, index);
+}
+
+/* try to convert the element to a lua value */
+static void uatolua(lua_State *L, int index) {
+    index = lua_absindex(L, index);
+    ua_data *v = luaL_testudata(L, index, "open62541-data");
+    if(!v)
+        return;
+    if(ua_pushnative(L, v->data, v->type))
+        lua_replace(L, index);
 }
 
 /*****************/
@@ -60,18 +69,13 @@ static void uatolua(lua_State *L, int index) {
 /*****************/
 
 /* Guid */
-static UA_Guid* parse_guid(lua_State *L, int index) {
-    if(!lua_isstring(L, index)) {
+static void parse_guid(lua_State *L, int index, UA_Guid *guid) {
+    if(!lua_isstring(L, index))
         luaL_error(L, "Guid needs to be of the form \"00000000-0000-0000-0000-000000000000\"");
-        return NULL;
-    }
     size_t arglength;
     const char *arg = lua_tolstring(L, index, &arglength);
-    if(arglength != 36) {
+    if(arglength != 36)
         luaL_error(L, "Guid needs to be of the form \"00000000-0000-0000-0000-000000000000\"");
-        return NULL;
-    }
-    UA_Guid *guid = UA_Guid_new();
     guid->data1 = strtoull(arg, NULL, 16);
     guid->data2 = strtoull(&arg[9], NULL, 16);
     guid->data3 = strtoull(&arg[14], NULL, 16);
@@ -85,116 +89,126 @@ static UA_Guid* parse_guid(lua_State *L, int index) {
     guid->data4[5] = data4_2 >> 16;
     guid->data4[6] = data4_2 >> 8;
     guid->data4[7] = data4_2;
-    return guid;
 }
 
 /* NodeId */
-static UA_NodeId* parse_nodeid(lua_State *L, int index) {
-    if(!lua_isnumber(L, index)) {
+
+/* A numeric NodeId identifier; fractional numbers are rejected */
+static UA_UInt32
+ua_nodeid_numeric(lua_State *L, int index) {
+    int isint;
+    lua_Integer i = lua_tointegerx(L, index, &isint);
+    if(!isint)
+        luaL_error(L, "Numeric NodeId identifiers must be integers");
+    if(i < 0 || i > UA_UINT32_MAX)
+        luaL_error(L, "Numeric NodeId identifier %I out of range", i);
+    return (UA_UInt32)i;
+}
+
+static void parse_nodeid(lua_State *L, int index, UA_NodeId *id) {
+    if(!lua_isnumber(L, index))
         luaL_error(L, "The first argument is no integer namespace id");
-        return NULL;
-    } else if(!lua_isnumber(L, index+1) && !lua_isstring(L, index+1)) {
+    else if(!lua_isnumber(L, index+1) && !lua_isstring(L, index+1))
         luaL_error(L, "Currently, only numeric and string nodeids are implemented");
-        return NULL;
-    }
-    UA_NodeId *id = UA_NodeId_new();
-    id->namespaceIndex = lua_tointeger(L, index);
+    int isint;
+    lua_Integer ns = lua_tointegerx(L, index, &isint);
+    if(!isint || ns < 0 || ns > UA_UINT16_MAX)
+        luaL_error(L, "The namespace index is no integer in [0, %d]", UA_UINT16_MAX);
+    id->namespaceIndex = (UA_UInt16)ns;
     if(lua_isnumber(L, index+1)) {
         id->identifierType = UA_NODEIDTYPE_NUMERIC;
-        id->identifier.numeric = lua_tointeger(L, index+1);
+        id->identifier.numeric = ua_nodeid_numeric(L, index+1);
     } else if(lua_isstring(L, index+1)) {
         id->identifierType = UA_NODEIDTYPE_STRING;
         id->identifier.string = UA_String_fromChars(lua_tostring(L, index+1));
     } 
-    return id;
 }
 
 /* QualifiedName */
-static UA_QualifiedName* parse_qualifiedname(lua_State *L, int index) {
-    if(!lua_isnumber(L, index)) {
+static void parse_qualifiedname(lua_State *L, int index, UA_QualifiedName *qn) {
+    if(!lua_isnumber(L, index))
         luaL_error(L, "The first argument is no integer namespace index");
-        return NULL;
-    } else if(!lua_isstring(L, index+1)) {
+    else if(!lua_isstring(L, index+1))
         luaL_error(L, "The second argument is no string");
-        return NULL;
-    }
-    UA_QualifiedName *qn = UA_QualifiedName_new();
     qn->namespaceIndex = lua_tointeger(L, index);
     qn->name = UA_STRING_ALLOC(lua_tostring(L, index+1));
-    return qn;
 }
 
 /* LocalizedText */
-static UA_LocalizedText* parse_localizedtext(lua_State *L, int index) {
-    if(!lua_isstring(L, index)) {
+static void parse_localizedtext(lua_State *L, int index, UA_LocalizedText *lt) {
+    if(!lua_isstring(L, index))
         luaL_error(L, "The first argument is no string");
-        return NULL;
-    } else if(!lua_isstring(L, index+1)) {
+    else if(!lua_isstring(L, index+1))
         luaL_error(L, "The second argument is no string");
-        return NULL;
-    }
-    UA_LocalizedText *lt = UA_LocalizedText_new();
     lt->locale = UA_STRING_ALLOC(lua_tostring(L, index));
     lt->text = UA_STRING_ALLOC(lua_tostring(L, index+1));
-    return lt;
 }
 
-static UA_Variant* parse_variant(lua_State *L, int index) {
-    ua_data *data = ua_getdata(L, index, NULL);
-    if(data) {
-        UA_Variant *v = UA_Variant_new();
-        UA_Variant_setScalarCopy(v, data->data, data->type);
-        return v;
+static UA_Boolean parse_variant(lua_State *L, int index, UA_Variant *v) {
+    if(!lua_istable(L, index)) {
+        ua_data *data = ua_getdata(L, index, NULL);
+        if(data) {
+            UA_Variant_setScalarCopy(v, data->data, data->type);
+            return true;
+        }
     }
     ua_array *array = ua_getarray(L, index);
     if(array) {
-        UA_Variant *v = UA_Variant_new();
         UA_Variant_setArrayCopy(v, *array->data, *array->length, array->type);
-        return v;
+        return true;
     }
-    return NULL;
+    return false;
 }
 
 // type can be null
 // index points to the arguments
 static ua_data *
 ua_type_parse(lua_State *L, int index, const UA_DataType *type) {
-    void *data = NULL;
     if(lua_isnil(L, index)) {
         if(!type) {
             luaL_error(L, "Cannot create an unspecifie type without an argument");
             return NULL;
         }
-        data = UA_new(type);
-    } else if(type && type->builtin) {
+        return ua_newdata(L, type);
+    }
+
+    if(type && type->builtin) {
+        ua_data *d;
         switch(type->typeIndex) {
         case UA_TYPES_GUID:
-            data = parse_guid(L, index);
-            break;
+            d = ua_newdata(L, type);
+            parse_guid(L, index, d->data);
+            return d;
         case UA_TYPES_NODEID:
-            data = parse_nodeid(L, index);
-            break;
+            d = ua_newdata(L, type);
+            parse_nodeid(L, index, d->data);
+            return d;
         case UA_TYPES_QUALIFIEDNAME:
-            data = parse_qualifiedname(L, index);
-            break;
+            d = ua_newdata(L, type);
+            parse_qualifiedname(L, index, d->data);
+            return d;
         case UA_TYPES_LOCALIZEDTEXT:
-            data = parse_localizedtext(L, index);
-            break;
+            d = ua_newdata(L, type);
+            parse_localizedtext(L, index, d->data);
+            return d;
         case UA_TYPES_VARIANT:
-            data = parse_variant(L, index);
+            d = ua_newdata(L, type);
+            if(parse_variant(L, index, d->data))
+                return d;
+            lua_pop(L, 1);
             break;
         default:
             break;
         }
     }
 
-    if(data) {
-        ua_data *d = lua_newuserdata(L, sizeof(ua_data));
-        d->data = data;
-        d->type = type;
-        luaL_setmetatable(L, "open62541-data");
+    /* structures from a table with the member names */
+    if(type && lua_istable(L, index)) {
+        ua_data *d = ua_newdata(L, type);
+        ua_fromlua(L, index, d->data, type);
         return d;
     }
+
     ua_data *d = ua_getdata(L, index, type);
     lua_pushvalue(L, index);
     return d;
@@ -202,6 +216,8 @@ ua_type_parse(lua_State *L, int index, const UA_DataType *type) {
 
 /* General type constructor function. Takes the datatype from its closure. */
 int ua_type_instantiate(lua_State *L) {
+    ua_arena_use(ua_arena_innermost());
+    ua_memory_check(L);
     lua_pushnil(L); // separator between data from the user and what we add
     lua_rawgeti(L, 1, 1);
     const UA_DataType *type = lua_touserdata(L, -1);
@@ -222,12 +238,8 @@ void ua_type_push_typetable(lua_State *L, const UA_DataType *type) {
     lua_newtable(L);
     lua_pushlightuserdata(L, (void*)(uintptr_t)type);
     lua_rawseti(L, -2, 1);
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    UA_NodeId *typeId = UA_NodeId_new();
-    *typeId = type->typeId;
-    data->data= typeId;
-    data->type = &UA_TYPES[UA_TYPES_NODEID];
-    luaL_setmetatable(L, "open62541-data");
+    ua_data *data = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_NodeId_copy(&type->typeId, data->data);
     lua_setfield(L, -2, "typeId");
     luaL_setmetatable(L, "open62541-type");
 }
@@ -250,13 +262,421 @@ int ua_get_type(lua_State *L) {
     return 1;
 }
 
+/****************/
+/* Custom Types */
+/****************/
+
+static const UA_DataType * ua_checktype(lua_State *L, int index);
+
+/* Types defined with ua.defineType live in a slab. The first UA_TYPES_COUNT + 1
+   entries stay unused, so that the typeIndex of the custom types does not
+   collide with the ns0 types (and UA_ENCODEDVARIANT). Members of a custom type
+   refer to other custom types with namespaceZero = false and their typeIndex
+   as the position in the slab, as in the generated type tables. The slab is
+   shared by all Lua states and threads and never released. An identical
+   definition in another Lua state reuses the existing type. The slab is
+   allocated at its full size and the entries do not change once they are
+   counted, so readers take the count under the lock and read without it. */
+#define LIBUA_MAXCUSTOMTYPES 256
+#define LIBUA_CUSTOMTYPES_FIRST (UA_TYPES_COUNT + 1)
+
+static struct {
+    struct spinlock lock;
+    UA_DataType *types;
+    size_t size;
+} ua_customtypes;
+
+/* The types are at types[LIBUA_CUSTOMTYPES_FIRST, size) */
+static size_t
+ua_customtypes_get(UA_DataType **types) {
+    SPIN_LOCK(&ua_customtypes);
+    *types = ua_customtypes.types;
+    size_t size = ua_customtypes.size;
+    SPIN_UNLOCK(&ua_customtypes);
+    return size;
+}
+
+#define UA_ALIGNOF(T) offsetof(struct { char c; T x; }, x)
+
+static const size_t ua_builtin_align[UA_BUILTIN_TYPES_COUNT] = {
+    UA_ALIGNOF(UA_Boolean), UA_ALIGNOF(UA_SByte), UA_ALIGNOF(UA_Byte),
+    UA_ALIGNOF(UA_Int16), UA_ALIGNOF(UA_UInt16), UA_ALIGNOF(UA_Int32),
+    UA_ALIGNOF(UA_UInt32), UA_ALIGNOF(UA_Int64), UA_ALIGNOF(UA_UInt64),
+    UA_ALIGNOF(UA_Float), UA_ALIGNOF(UA_Double), UA_ALIGNOF(UA_String),
+    UA_ALIGNOF(UA_DateTime), UA_ALIGNOF(UA_Guid), UA_ALIGNOF(UA_ByteString),
+    UA_ALIGNOF(UA_XmlElement), UA_ALIGNOF(UA_NodeId), UA_ALIGNOF(UA_ExpandedNodeId),
+    UA_ALIGNOF(UA_StatusCode), UA_ALIGNOF(UA_QualifiedName), UA_ALIGNOF(UA_LocalizedText),
+    UA_ALIGNOF(UA_ExtensionObject), UA_ALIGNOF(UA_DataValue), UA_ALIGNOF(UA_Variant),
+    UA_ALIGNOF(UA_DiagnosticInfo) };
+
+/* The alignment of the C structure of a type (enums are Int32) */
+static size_t
+ua_type_align(const UA_DataType *type) {
+    if(type->builtin)
+        return ua_builtin_align[type->typeIndex];
+    const UA_DataType *typelists[2] = { UA_TYPES, &type[-type->typeIndex] };
+    size_t align = 1;
+    for(size_t i = 0; i < type->membersSize; i++) {
+        const UA_DataTypeMember *member = &type->members[i];
+        size_t a = UA_ALIGNOF(size_t);
+        if(!member->isArray)
+            a = ua_type_align(&typelists[!member->namespaceZero][member->memberTypeIndex]);
+        if(a > align)
+            align = a;
+    }
+    return align;
+}
+
+static UA_Boolean
+ua_customtype_equal(const UA_DataType *a, const UA_DataType *b) {
+    if(strcmp(a->typeName, b->typeName) != 0 || a->membersSize != b->membersSize ||
+       !UA_NodeId_equal(&a->typeId, &b->typeId))
+        return false;
+    for(size_t i = 0; i < a->membersSize; i++) {
+        const UA_DataTypeMember *ma = &a->members[i];
+        const UA_DataTypeMember *mb = &b->members[i];
+        if(strcmp(ma->memberName, mb->memberName) != 0 ||
+           ma->memberTypeIndex != mb->memberTypeIndex ||
+           ma->namespaceZero != mb->namespaceZero || ma->isArray != mb->isArray)
+            return false;
+    }
+    return true;
+}
+
+static char *
+ua_strdup(const char *s) {
+    size_t len = strlen(s) + 1;
+    char *c = malloc(len);
+    if(c)
+        memcpy(c, s, len);
+    return c;
+}
+
+/* Release the copies of a definition that was not added to the slab */
+static void
+ua_customtype_clear(UA_DataType *t) {
+    if(t->members) {
+        for(size_t i = 0; i < t->membersSize; i++)
+            free((char*)(uintptr_t)t->members[i].memberName);
+        free(t->members);
+    }
+    free((char*)(uintptr_t)t->typeName);
+    UA_NodeId_deleteMembers(&t->typeId);
+}
+
+/* Fill the type from the members table and the name on top of the stack. The
+   member layout
+   follows the C alignment rules, so that the values match a struct with the
+   same members. */
+static void
+ua_customtype_parse(lua_State *L, UA_DataType *type, UA_DataTypeMember *members) {
+    type->typeName = lua_tostring(L, -1); /* replaced by a copy later */
+    if(!type->typeName)
+        luaL_error(L, "The type definition has no name");
+    size_t offset = 0;
+    size_t align = 1;
+    UA_Boolean fixedSize = true;
+    UA_Boolean zeroCopyable = true;
+    size_t encodedSize = 0; /* of the zero-copyable members */
+    UA_DataType *custom;
+    size_t customSize = ua_customtypes_get(&custom);
+    for(size_t i = 0; i < type->membersSize; i++) {
+        UA_DataTypeMember *member = &members[i];
+        lua_rawgeti(L, -2, (lua_Integer)i + 1);
+        if(!lua_istable(L, -1))
+            luaL_error(L, "Member %d is not a table", (int)i + 1);
+        lua_getfield(L, -1, "name");
+        member->memberName = lua_tostring(L, -1);
+        if(!member->memberName)
+            luaL_error(L, "Member %d has no name", (int)i + 1);
+        lua_getfield(L, -2, "type");
+        if(lua_isnil(L, -1))
+            luaL_error(L, "Member %s has no type", member->memberName);
+        const UA_DataType *mtype = ua_checktype(L, lua_gettop(L));
+        lua_getfield(L, -3, "array");
+        member->isArray = lua_toboolean(L, -1);
+        lua_pop(L, 2);
+        if(mtype >= UA_TYPES && mtype < &UA_TYPES[UA_TYPES_COUNT]) {
+            member->namespaceZero = true;
+            member->memberTypeIndex = (UA_UInt16)(mtype - UA_TYPES);
+        } else if(customSize > 0 && mtype >= &custom[LIBUA_CUSTOMTYPES_FIRST] &&
+                  mtype < &custom[customSize]) {
+            member->namespaceZero = false;
+            member->memberTypeIndex = mtype->typeIndex;
+        } else {
+            luaL_error(L, "Member %s has an unsupported type", member->memberName);
+        }
+
+        size_t a = member->isArray ? UA_ALIGNOF(size_t) : ua_type_align(mtype);
+        size_t padding = (a - offset % a) % a;
+        member->padding = (UA_Byte)padding;
+        offset += padding;
+        if(member->isArray)
+            offset += sizeof(size_t) + sizeof(void*);
+        else
+            offset += mtype->memSize;
+        if(a > align)
+            align = a;
+        fixedSize = fixedSize && !member->isArray && mtype->fixedSize;
+        zeroCopyable = zeroCopyable && !member->isArray && mtype->zeroCopyable &&
+            padding == 0;
+        encodedSize += mtype->memSize;
+        lua_pop(L, 2); /* name and member table */
+    }
+    offset += (align - offset % align) % align;
+    if(offset > UA_UINT16_MAX)
+        luaL_error(L, "The type is too large");
+    /* also the padding at the end would be copied into the encoding */
+    if(offset == 0 || offset != encodedSize)
+        zeroCopyable = false;
+    type->memSize = (UA_UInt16)offset;
+    type->builtin = false;
+    type->fixedSize = fixedSize;
+    type->zeroCopyable = zeroCopyable;
+}
+
+/* ua.defineType{name=, typeId=, binaryEncodingId=, members={{name=, type=,
+   array=}, ...}} returns the new type and adds it to ua.types */
+int ua_definetype(lua_State *L) {
+    ua_arena_use(NULL);
+    luaL_checktype(L, 1, LUA_TTABLE);
+    lua_settop(L, 1);
+    lua_getfield(L, 1, "members");
+    if(!lua_istable(L, -1))
+        return luaL_error(L, "The type definition has no members");
+    size_t membersSize = lua_rawlen(L, -1);
+    if(membersSize == 0 || membersSize > 255)
+        return luaL_error(L, "The type needs 1 to 255 members");
+    lua_getfield(L, 1, "name");
+
+    /* parse into scratch memory of Lua, the strings are copied at the end */
+    UA_DataType *type = lua_newuserdata(L, sizeof(UA_DataType));
+    memset(type, 0, sizeof(UA_DataType));
+    type->membersSize = (UA_Byte)membersSize;
+    UA_DataTypeMember *members = lua_newuserdata(L, sizeof(UA_DataTypeMember) * membersSize);
+    memset(members, 0, sizeof(UA_DataTypeMember) * membersSize);
+    lua_pushvalue(L, 2); /* members */
+    lua_pushvalue(L, 3); /* name */
+    ua_customtype_parse(L, type, members);
+    type->members = members;
+    lua_pop(L, 2);
+
+    /* the ids are garbage-collected if an error is raised */
+    lua_getfield(L, 1, "binaryEncodingId");
+    if(lua_isnil(L, -1))
+        return luaL_error(L, "The type definition has no binaryEncodingId");
+    const UA_NodeId *encodingId = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID])->data;
+    ua_fromlua(L, -2, (void*)(uintptr_t)encodingId, &UA_TYPES[UA_TYPES_NODEID]);
+    lua_getfield(L, 1, "typeId");
+    ua_data *typeId = ua_newdata(L, &UA_TYPES[UA_TYPES_NODEID]);
+    if(!lua_isnil(L, -2))
+        ua_fromlua(L, -2, typeId->data, &UA_TYPES[UA_TYPES_NODEID]);
+    type->typeId = *(UA_NodeId*)typeId->data; /* shallow for the comparison */
+
+    /* the ns0 types cannot be replaced */
+    const UA_DataType *existing = UA_findDataTypeByBinaryEncoding(encodingId);
+    if(existing && existing >= UA_TYPES && existing < &UA_TYPES[UA_TYPES_COUNT])
+        return luaL_error(L, "The binaryEncodingId is used by ua.types.%s",
+                          existing->typeName);
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        if(strcmp(UA_TYPES[i].typeName, type->typeName) == 0)
+            return luaL_error(L, "The name %s is used by a builtin type", type->typeName);
+        if(!UA_NodeId_isNull(&type->typeId) &&
+           UA_NodeId_equal(&UA_TYPES[i].typeId, &type->typeId))
+            return luaL_error(L, "The typeId is used by ua.types.%s", UA_TYPES[i].typeName);
+    }
+
+    /* reuse an identical type */
+    UA_DataType *custom;
+    size_t customSize = ua_customtypes_get(&custom);
+    UA_DataType *found = NULL;
+    for(size_t i = LIBUA_CUSTOMTYPES_FIRST; i < customSize; i++) {
+        if(ua_customtype_equal(&custom[i], type))
+            found = &custom[i];
+    }
+    if(found) {
+        type = found;
+    } else {
+        if(customSize == LIBUA_CUSTOMTYPES_FIRST + LIBUA_MAXCUSTOMTYPES)
+            return luaL_error(L, "Too many custom types");
+        /* copy the definition without raising errors until it is complete */
+        UA_DataType t = *type;
+        t.typeName = ua_strdup(type->typeName);
+        UA_DataTypeMember *m = calloc(membersSize, sizeof(UA_DataTypeMember));
+        t.members = m;
+        UA_NodeId_init(&t.typeId);
+        UA_Boolean ok = t.typeName && m &&
+            UA_NodeId_copy(typeId->data, &t.typeId) == UA_STATUSCODE_GOOD;
+        for(size_t i = 0; ok && i < membersSize; i++) {
+            m[i] = members[i];
+            m[i].memberName = ua_strdup(members[i].memberName);
+            ok = (m[i].memberName != NULL);
+        }
+        if(!ok) {
+            ua_customtype_clear(&t);
+            return luaL_error(L, "Out of memory");
+        }
+
+        /* publish the complete entry */
+        SPIN_LOCK(&ua_customtypes);
+        if(!ua_customtypes.types) {
+            ua_customtypes.types = calloc(LIBUA_CUSTOMTYPES_FIRST + LIBUA_MAXCUSTOMTYPES,
+                                          sizeof(UA_DataType));
+            ua_customtypes.size = LIBUA_CUSTOMTYPES_FIRST;
+        }
+        type = NULL;
+        if(ua_customtypes.types &&
+           ua_customtypes.size < LIBUA_CUSTOMTYPES_FIRST + LIBUA_MAXCUSTOMTYPES) {
+            type = &ua_customtypes.types[ua_customtypes.size];
+            *type = t;
+            type->typeIndex = (UA_UInt16)ua_customtypes.size++;
+        }
+        SPIN_UNLOCK(&ua_customtypes);
+        if(!type) {
+            ua_customtype_clear(&t);
+            return luaL_error(L, "Too many custom types");
+        }
+    }
+
+    if(UA_findDataTypeByBinaryEncoding(encodingId) != type &&
+       UA_registerDataType(type, encodingId) != UA_STATUSCODE_GOOD)
+        return luaL_error(L, "Out of memory");
+
+    ua_type_push_typetable(L, type);
+    lua_getfield(L, LUA_REGISTRYINDEX, "open62541-types");
+    lua_pushvalue(L, -2);
+    lua_setfield(L, -2, type->typeName);
+    lua_pop(L, 1);
+    return 1;
+}
+
+/* Find ns0 and custom types by name or typeId */
+const UA_DataType *
+ua_findtype_name(const char *name, size_t len) {
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        if(strncmp(UA_TYPES[i].typeName, name, len) == 0 &&
+           UA_TYPES[i].typeName[len] == '\0')
+            return &UA_TYPES[i];
+    }
+    UA_DataType *custom;
+    size_t customSize = ua_customtypes_get(&custom);
+    for(size_t i = LIBUA_CUSTOMTYPES_FIRST; i < customSize; i++) {
+        if(strncmp(custom[i].typeName, name, len) == 0 && custom[i].typeName[len] == '\0')
+            return &custom[i];
+    }
+    return NULL;
+}
+
+const UA_DataType *
+ua_findtype_id(const UA_NodeId *id) {
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        if(UA_NodeId_equal(&UA_TYPES[i].typeId, id))
+            return &UA_TYPES[i];
+    }
+    UA_DataType *custom;
+    size_t customSize = ua_customtypes_get(&custom);
+    for(size_t i = LIBUA_CUSTOMTYPES_FIRST; i < customSize; i++) {
+        if(UA_NodeId_equal(&custom[i].typeId, id))
+            return &custom[i];
+    }
+    return NULL;
+}
+
+/* Values of a closed ua.scope must not be touched anymore */
+static void
+ua_checkscope(lua_State *L, UA_UInt32 scope) {
+    if(scope != 0 && !ua_arena_find(scope))
+        luaL_error(L, "The value was released with its ua.scope");
+}
+
+ua_data *
+ua_newdata(lua_State *L, const UA_DataType *type) {
+    ua_memory_step(L);
+    ua_data *d;
+    if(type->memSize <= LIBUA_INLINE_MAXSIZE) {
+        d = lua_newuserdata(L, sizeof(ua_data) + type->memSize);
+        d->data = (void*)(d + 1);
+        UA_init(d->data, type);
+    } else {
+        d = lua_newuserdata(L, sizeof(ua_data));
+        d->data = UA_new(type);
+    }
+    d->type = type;
+    d->scope = ua_arena_id(ua_arena_current());
+    luaL_setmetatable(L, "open62541-data");
+    return d;
+}
+
+/* Push a copy of the value. Inside a ua.scope, the copy is allocated from the
+   arena of the innermost scope. */
+static ua_data *
+ua_pushcopy(lua_State *L, const void *p, const UA_DataType *type) {
+    ua_arena_use(ua_arena_innermost());
+    ua_data *data = ua_newdata(L, type);
+    UA_copy(p, data->data, type);
+    return data;
+}
+
+ua_data *
+ua_pushborrowed(lua_State *L, const void *p, const UA_DataType *type,
+                const ua_arena *borrow) {
+    ua_data *d = lua_newuserdata(L, sizeof(ua_data));
+    d->type = type;
+    d->data = (void*)(uintptr_t)p;
+    d->scope = ua_arena_id(borrow);
+    luaL_setmetatable(L, "open62541-data");
+    /* tagged like derived data, the gc does not delete it */
+    lua_pushboolean(L, true);
+    lua_setuservalue(L, -2);
+    return d;
+}
+
+static ua_array *
+ua_pusharraycopy(lua_State *L, const void *p, size_t length, const UA_DataType *type) {
+    ua_arena_use(ua_arena_innermost());
+    ua_array *array = ua_newarray(L, type);
+    UA_Array_copy(p, length, &array->local_data, type);
+    array->local_length = length;
+    array->capacity = length;
+    return array;
+}
+
+/* ua.copy(v) returns a copy of the value or array on the heap. This is how
+   values escape from a ua.scope. */
+int ua_copy(lua_State *L) {
+    ua_arena_use(NULL);
+    ua_memory_check(L);
+    ua_array *array = luaL_testudata(L, 1, "open62541-array");
+    if(array) {
+        ua_checkscope(L, array->scope);
+        ua_array *copy = ua_newarray(L, array->type);
+        if(UA_Array_copy(*array->data, *array->length, &copy->local_data,
+                         array->type) != UA_STATUSCODE_GOOD)
+            return luaL_error(L, "Out of memory");
+        copy->local_length = *array->length;
+        copy->capacity = *array->length;
+        return 1;
+    }
+    ua_data *data = ua_getdata(L, 1, NULL);
+    ua_data *copy = ua_newdata(L, data->type);
+    UA_copy(data->data, copy->data, data->type);
+    return 1;
+}
+
 int ua_gc(lua_State *L) {
-    ua_data *data = ua_getdata(L, -1, NULL);
+    ua_data *data = luaL_testudata(L, -1, "open62541-data");
     if(!data || !data->data)
         return 0;
+    /* the memory was released together with the scope */
+    if(data->scope != 0 && !ua_arena_find(data->scope))
+        return 0;
     lua_getuservalue(L, -1);
     /* derived data is not deleted, tagged with a uservalue */
-    if(lua_isnil(L, -1))
+    if(!lua_isnil(L, -1))
+        return 0;
+    if(data->data == (void*)(data + 1))
+        UA_deleteMembers(data->data, data->type);
+    else
         UA_delete(data->data, data->type);
     return 0;
 }
@@ -265,6 +685,8 @@ int ua_gc(lua_State *L) {
 ua_data *
 ua_getdata(lua_State *L, int index, const UA_DataType *type) {
     ua_data *data = luaL_testudata(L, index , "open62541-data");
+    if(data)
+        ua_checkscope(L, data->scope);
     if(data && (!type || type == data->type))
         return data; 
 
@@ -275,7 +697,8 @@ ua_getdata(lua_State *L, int index, const UA_DataType *type) {
 
     if(data) {
         if(!data->type->builtin) {
-            luaL_error(L, "Cannot convert from ua.types.%s to ua.types.%s", data->type, type->typeName);
+            luaL_error(L, "Cannot convert from ua.types.%s to ua.types.%s",
+                       data->type->typeName, type->typeName);
             return NULL;
         }
         switch(data->type->typeIndex) {
@@ -336,15 +759,17 @@ ua_getdata(lua_State *L, int index, const UA_DataType *type) {
         case UA_TYPES_XMLELEMENT:
             UA_String_copy(data->data, &str);
             isString = true;
+            break;
         default:
-            luaL_error(L, "Cannot convert from ua.types.%s to ua.types.%s", data->type, type->typeName);
+            luaL_error(L, "Cannot convert from ua.types.%s to ua.types.%s",
+                       data->type->typeName, type->typeName);
             return NULL;
         }
     } else {
         if(lua_type(L, index) == LUA_TSTRING) {
             size_t len = 0;
             const char *s = lua_tolstring(L, index, &len);
-            str.data = malloc(len);
+            str.data = ua_malloc(len);
             str.length = len;
             memcpy(str.data, s, len);
             isString = true;
@@ -367,66 +792,52 @@ ua_getdata(lua_State *L, int index, const UA_DataType *type) {
             type = &UA_TYPES[UA_TYPES_DOUBLE];
     }
 
-    data = lua_newuserdata(L, sizeof(ua_data));
     if(isNumber) {
+        data = ua_newdata(L, type);
         switch(type->typeIndex) {
         case UA_TYPES_BOOLEAN:
-            data->data = UA_Boolean_new();
             *(UA_Boolean*)data->data = number;
             break;
         case UA_TYPES_SBYTE:
-            data->data = UA_SByte_new();
             *(UA_SByte*)data->data = number;
             break;
         case UA_TYPES_BYTE:
-            data->data = UA_Byte_new();
             *(UA_Byte*)data->data = number;
             break;
         case UA_TYPES_INT16:
-            data->data = UA_Int16_new();
             *(UA_Int16*)data->data = number;
             break;
         case UA_TYPES_UINT16:
-            data->data = UA_UInt16_new();
             *(UA_UInt16*)data->data = number;
             break;
         case UA_TYPES_INT32:
-            data->data = UA_Int32_new();
             *(UA_Int32*)data->data = number;
             break;
         case UA_TYPES_UINT32:
-            data->data = UA_UInt32_new();
             *(UA_UInt32*)data->data = number;
             break;
         case UA_TYPES_INT64:
-            data->data = UA_Int64_new();
             *(UA_Int64*)data->data = number;
             break;
         case UA_TYPES_UINT64:
-            data->data = UA_UInt64_new();
             *(UA_UInt64*)data->data = number;
             break;
         case UA_TYPES_FLOAT:
-            data->data = UA_Float_new();
             *(UA_Float*)data->data = number;
             break;
         case UA_TYPES_DOUBLE:
-            data->data = UA_Double_new();
             *(UA_Double*)data->data = number;
             break;
         case UA_TYPES_DATETIME:
-            data->data = UA_DateTime_new();
             *(UA_DateTime*)data->data = number;
             break;
         case UA_TYPES_STATUSCODE:
-            data->data = UA_StatusCode_new();
             *(UA_StatusCode*)data->data = number;
             break;
         default:
             luaL_error(L, "Cannot convert from numerical to ua.types.%s", type->typeName);
             return NULL;
         }
-        data->type = type;
     } else {
         if(type != &UA_TYPES[UA_TYPES_STRING] &&
            type != &UA_TYPES[UA_TYPES_BYTESTRING] &&
@@ -435,12 +846,10 @@ ua_getdata(lua_State *L, int index, const UA_DataType *type) {
             luaL_error(L, "Cannot convert from string to ua.types.%s", type->typeName);
             return NULL;
         }
-        data->type = type;
-        data->data = UA_new(type);
+        data = ua_newdata(L, type);
         *(UA_String*)data->data = str;
     }
     
-    luaL_setmetatable(L, "open62541-data");
     lua_replace(L, index);
     return data;
 }
@@ -449,8 +858,10 @@ ua_getdata(lua_State *L, int index, const UA_DataType *type) {
 ua_array *
 ua_getarray(lua_State *L, int index) {
     ua_array *array = luaL_testudata(L, index , "open62541-array");
-    if(array)
+    if(array) {
+        ua_checkscope(L, array->scope);
         return array;
+    }
     if(!lua_istable(L, index))
         return NULL;
 
@@ -469,13 +880,10 @@ ua_getarray(lua_State *L, int index) {
     }
     type = data->type;
 
-    array = lua_newuserdata(L, sizeof(ua_array));
-    array->type = type;
-    array->data = &array->local_data;
-    array->length = &array->local_length;
+    array = ua_newarray(L, type);
     array->local_data = UA_Array_new(len, type);
     array->local_length = len;
-    luaL_setmetatable(L, "open62541-array");
+    array->capacity = len;
     UA_copy(data->data, array->local_data, type);
     lua_remove(L, -2); // the data
     
@@ -495,78 +903,168 @@ ua_getarray(lua_State *L, int index) {
 /* Index */
 /*********/
 
-/* Get the index of the member with the given name */
-static int
-find_memberindex(const UA_DataType *type, const char *membername) {
-    for(int memberindex = 0; memberindex < type->membersSize; memberindex++) {
-        const UA_DataTypeMember *member = &type->members[memberindex];
-        if(!member->memberName)
-            continue;
-        if(strcmp(member->memberName, membername) == 0)
-            return memberindex;
+/* The member layout of structured types is computed once when the type is
+   first used. For every type, the registry holds a table (keyed by the
+   lightuserdata of the type) that maps the member names to lightuserdata
+   pointing to the ua_member descriptors. Lua strings are interned, so the
+   lookup is a single hash access. The descriptor array itself is a userdata
+   stored at index 0 of the table. Types without named members are marked with
+   false. */
+void ua_members_register(lua_State *L, const UA_DataType *type) {
+    if(type->membersSize == 0 || !type->members[0].memberName ||
+       type->members[0].memberName[0] == '\0') {
+        lua_pushboolean(L, 0); /* builtin types without named members */
+        lua_rawsetp(L, LUA_REGISTRYINDEX, type);
+        return;
     }
-    return -1;
-}
+    lua_createtable(L, 1, type->membersSize);
+    ua_member *members = lua_newuserdata(L, sizeof(ua_member) * type->membersSize);
+    lua_rawseti(L, -2, 0);
 
-/* get the pointer to the member and the array length if an array */
-void *
-ua_getmember(void *parent, const UA_DataType *type, const char *membername,
-             const UA_DataType **memberType, size_t **arraylen) {
-    int memberindex = find_memberindex(type, membername);
-    if(memberindex < 0)
-        return NULL;
     const UA_DataType *typelists[2] = { UA_TYPES, &type[-type->typeIndex] };
-    uintptr_t ptr = (uintptr_t)parent;
-    const UA_DataTypeMember *member;
-    for(int i = 0; i < memberindex; i++) {
-        member = &type->members[i];
-        if(!member->isArray)
-            ptr += member->padding + UA_TYPES[member->memberTypeIndex].memSize;
+    size_t offset = 0;
+    for(size_t i = 0; i < type->membersSize; i++) {
+        const UA_DataTypeMember *member = &type->members[i];
+        ua_member *m = &members[i];
+        m->name = member->memberName;
+        m->type = &typelists[!member->namespaceZero][member->memberTypeIndex];
+        m->isArray = member->isArray;
+        m->index = i;
+        offset += member->padding;
+        m->offset = offset;
+        if(member->isArray)
+            offset += sizeof(size_t) + sizeof(void*);
         else
-            ptr += member->padding + sizeof(size_t) + sizeof(void*);
-    }
-    member = &type->members[memberindex];
-    if(memberType)
-    *memberType = &typelists[!member->namespaceZero][member->memberTypeIndex];
-    if(member->isArray) {
-        ptr += member->padding;
-        *arraylen = (size_t*)ptr;
-        ptr += sizeof(size_t);
-    } else {
-        *arraylen = NULL;
-        ptr += member->padding;
+            offset += m->type->memSize;
+        lua_pushlightuserdata(L, m);
+        lua_setfield(L, -2, m->name);
     }
-    return (void*)ptr;
+    lua_rawsetp(L, LUA_REGISTRYINDEX, type);
+}
+
+/* Pushes the member table of the type. Returns 0 and pushes nothing if the
+   type has no named members. */
+static int
+ua_members_push(lua_State *L, const UA_DataType *type) {
+    int t = lua_rawgetp(L, LUA_REGISTRYINDEX, type);
+    if(t == LUA_TTABLE)
+        return 1;
+    lua_pop(L, 1);
+    if(t == LUA_TBOOLEAN)
+        return 0;
+    ua_members_register(L, type);
+    if(lua_rawgetp(L, LUA_REGISTRYINDEX, type) == LUA_TTABLE)
+        return 1;
+    lua_pop(L, 1);
+    return 0;
+}
+
+/* Returns the descriptor array or NULL if the type has no named members */
+const ua_member *
+ua_members(lua_State *L, const UA_DataType *type) {
+    if(!ua_members_push(L, type))
+        return NULL;
+    lua_rawgeti(L, -1, 0);
+    const ua_member *members = lua_touserdata(L, -1);
+    lua_pop(L, 2);
+    return members;
+}
+
+/* Look up the member named by the string at keyindex */
+const ua_member *
+ua_findmember(lua_State *L, const UA_DataType *type, int keyindex) {
+    keyindex = lua_absindex(L, keyindex);
+    if(lua_type(L, keyindex) != LUA_TSTRING)
+        return NULL;
+    if(!ua_members_push(L, type))
+        return NULL;
+    lua_pushvalue(L, keyindex);
+    lua_rawget(L, -2);
+    const ua_member *m = lua_touserdata(L, -1);
+    lua_pop(L, 2);
+    return m;
+}
+
+const ua_member *
+ua_findmember_name(lua_State *L, const UA_DataType *type, const char *name) {
+    lua_pushstring(L, name);
+    const ua_member *m = ua_findmember(L, type, -1);
+    lua_pop(L, 1);
+    return m;
+}
+
+static int ua_binary_error(lua_State *L, const char *what, const UA_DataType *type,
+                           UA_StatusCode retval);
+
+/* Member proxies point into the memory of their parent. The parent userdata
+   is set as the uservalue of the proxy to prevent its garbage collection. The
+   proxies are cached per parent in a weak-keyed registry table, so repeated
+   access to the same member reuses the proxy and allocates nothing. */
+static void
+ua_proxy_cache(lua_State *L, int dataindex) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "open62541-proxies");
+    lua_pushvalue(L, dataindex);
+    if(lua_rawget(L, -2) != LUA_TTABLE) {
+        lua_pop(L, 1);
+        lua_newtable(L);
+        lua_pushvalue(L, dataindex);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, -4);
+    }
+    lua_remove(L, -2);
 }
 
 static int
 ua_return_member(lua_State *L, int dataindex,
                  void *member, const UA_DataType *membertype) {
-    ua_data *memberdata = lua_newuserdata(L, sizeof(ua_data));
+    dataindex = lua_absindex(L, dataindex);
+    ua_proxy_cache(L, dataindex);
+    lua_rawgetp(L, -1, member);
+    ua_data *memberdata = luaL_testudata(L, -1, "open62541-data");
+    if(memberdata && memberdata->type == membertype) {
+        lua_remove(L, -2);
+        return 1;
+    }
+    lua_pop(L, 1);
+    memberdata = lua_newuserdata(L, sizeof(ua_data));
     memberdata->type = membertype;
     memberdata->data = member;
+    memberdata->scope = ((ua_data*)lua_touserdata(L, dataindex))->scope;
     luaL_setmetatable(L, "open62541-data");
-    /* add a user value that prevents gc of the orig userdata */
-    lua_newtable(L);
     lua_pushvalue(L, dataindex);
-    lua_rawseti(L, -2, 1);
     lua_setuservalue(L, -2);
+    lua_pushvalue(L, -1);
+    lua_rawsetp(L, -3, member);
+    lua_remove(L, -2);
     return 1;
 }
 
 static int
 ua_return_memberarray(lua_State *L, int dataindex, void *array,
                       size_t *arraylen, const UA_DataType *arraytype) {
-    ua_array *memberdata = lua_newuserdata(L, sizeof(ua_array));
+    dataindex = lua_absindex(L, dataindex);
+    ua_proxy_cache(L, dataindex);
+    lua_rawgetp(L, -1, arraylen);
+    ua_array *memberdata = luaL_testudata(L, -1, "open62541-array");
+    if(memberdata && memberdata->type == arraytype) {
+        lua_remove(L, -2);
+        return 1;
+    }
+    lua_pop(L, 1);
+    memberdata = lua_newuserdata(L, sizeof(ua_array));
     memberdata->type = arraytype;
     memberdata->data = array;
     memberdata->length = arraylen;
+    memberdata->local_length = 0;
+    memberdata->local_data = NULL;
+    memberdata->capacity = 0;
+    memberdata->scope = ((ua_data*)lua_touserdata(L, dataindex))->scope;
     luaL_setmetatable(L, "open62541-array");
-    /* add a user value that prevents gc of the orig userdata */
-    lua_newtable(L);
-    lua_pushvalue(L, 1); // orig userdata
-    lua_rawseti(L, -2, 1);
-    lua_setuservalue(L, -2); // set the uservalue of the member data
+    lua_pushvalue(L, dataindex);
+    lua_setuservalue(L, -2);
+    lua_pushvalue(L, -1);
+    lua_rawsetp(L, -3, arraylen);
+    lua_remove(L, -2);
     return 1;
 }
 
@@ -605,40 +1103,58 @@ ua_localizedtext_index(lua_State *L, int dataindex, UA_LocalizedText *lt, const
     return luaL_error(L, "Cannot get this index %s", key);
 }
 
-/* access to variant always returns a copy */
+/* access to variant always returns a copy or a native value */
 static int
-ua_variant_index(lua_State *L, int dataindex, UA_Variant *v, const char *key) {
+ua_variant_index(lua_State *L, int dataindex, UA_Variant *v, const char *key, int native) {
     if(strcmp(key, "value") == 0) {
         if(!v->type) {
             lua_pushnil(L);
         } else if(UA_Variant_isScalar(v)) {
-            ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-            data->type = v->type;
-            data->data = UA_new(v->type);
-            UA_copy(v->data, data->data, v->type);
-            luaL_setmetatable(L, "open62541-data");
+            if(native && ua_pushnative(L, v->data, v->type))
+                return 1;
+            ua_pushcopy(L, v->data, v->type);
         } else {
-            ua_array *array = lua_newuserdata(L, sizeof(ua_array));
-            array->type = v->type;
-            array->data = &array->local_data;
-            array->length = &array->local_length;
-            UA_Array_copy(v->data, v->arrayLength, &array->local_data, v->type);
-            array->local_length = v->arrayLength;
-            luaL_setmetatable(L, "open62541-array");
+            ua_pusharraycopy(L, v->data, v->arrayLength, v->type);
         }
         return 1;
     }
     if(strcmp(key, "arrayDimensions") == 0) {
-        ua_array *array = lua_newuserdata(L, sizeof(ua_array));
-        array->type = &UA_TYPES[UA_TYPES_UINT32];
-        array->data = &array->local_data;
-        array->length = &array->local_length;
-        UA_Array_copy(v->arrayDimensions, v->arrayDimensionsSize,
-                      &array->local_data, &UA_TYPES[UA_TYPES_UINT32]);
-        array->local_length = v->arrayDimensionsSize;
-        luaL_setmetatable(L, "open62541-array");
+        ua_pusharraycopy(L, v->arrayDimensions, v->arrayDimensionsSize,
+                         &UA_TYPES[UA_TYPES_UINT32]);
+        return 1;
+    }
+    return luaL_error(L, "Cannot get this index %s", key);
+}
+
+/* The body of an extension object that was kept encoded is decoded on the
+   first access. Bodies of unknown types stay encoded. */
+static int
+ua_extensionobject_index(lua_State *L, int dataindex, ua_data *data, const char *key) {
+    UA_ExtensionObject *eo = data->data;
+    ua_arena *current = ua_arena_current();
+    ua_arena_use(ua_arena_find(data->scope));
+    UA_StatusCode retval = UA_ExtensionObject_decodeLazy(eo);
+    ua_arena_use(current);
+    if(retval != UA_STATUSCODE_GOOD)
+        return ua_binary_error(L, "Decoding", &UA_TYPES[UA_TYPES_EXTENSIONOBJECT], retval);
+    if(strcmp(key, "typeId") == 0) {
+        if(eo->encoding >= UA_EXTENSIONOBJECT_DECODED)
+            ua_pushcopy(L, &eo->content.decoded.type->typeId, &UA_TYPES[UA_TYPES_NODEID]);
+        else
+            ua_pushcopy(L, &eo->content.encoded.typeId, &UA_TYPES[UA_TYPES_NODEID]);
         return 1;
     }
+    if(strcmp(key, "body") == 0) {
+        if(eo->encoding >= UA_EXTENSIONOBJECT_DECODED)
+            return ua_return_member(L, dataindex, eo->content.decoded.data,
+                                    eo->content.decoded.type);
+        if(eo->encoding == UA_EXTENSIONOBJECT_ENCODED_NOBODY) {
+            lua_pushnil(L);
+            return 1;
+        }
+        return ua_return_member(L, dataindex, &eo->content.encoded.body,
+                                &UA_TYPES[UA_TYPES_BYTESTRING]);
+    }
     return luaL_error(L, "Cannot get this index %s", key);
 }
 
@@ -743,8 +1259,23 @@ ua_diagnosticinfo_index(lua_State *L, int dataindex, UA_DiagnosticInfo *di, cons
     return luaL_error(L, "Cannot get this index %s", key);
 }
 
-static int ua_index_key(lua_State *L, int dataindex, const char *key) {
+static int
+ua_index_member(lua_State *L, int dataindex, ua_data *data, const ua_member *m) {
+    void *member = (void*)((uintptr_t)data->data + m->offset);
+    if(m->isArray)
+        return ua_return_memberarray(L, dataindex, (void*)((uintptr_t)member + sizeof(size_t)),
+                                     member, m->type);
+    return ua_return_member(L, dataindex, member, m->type);
+}
+
+/* If native is set, values that have a native representation may be pushed
+   directly instead of a proxy */
+static int ua_index_key(lua_State *L, int dataindex, int keyindex, int native) {
     ua_data *data = luaL_checkudata(L, dataindex, "open62541-data");
+    ua_checkscope(L, data->scope);
+    const char *key = lua_tostring(L, keyindex);
+    if(!key)
+        return luaL_error(L, "Index must be a string");
 
     if(data->type == &UA_TYPES[UA_TYPES_NODEID])
         return ua_nodeid_index(L, dataindex, data->data, key);
@@ -752,26 +1283,28 @@ static int ua_index_key(lua_State *L, int dataindex, const char *key) {
         return ua_expandednodeid_index(L, dataindex, data->data, key);
     if(data->type == &UA_TYPES[UA_TYPES_LOCALIZEDTEXT])
         return ua_localizedtext_index(L, dataindex, data->data, key);
-    if(data->type == &UA_TYPES[UA_TYPES_VARIANT])
-        return ua_variant_index(L, dataindex, data->data, key);
+    if(data->type == &UA_TYPES[UA_TYPES_VARIANT]) {
+        ua_variant_decodelazy(L, data->data, data->scope);
+        return ua_variant_index(L, dataindex, data->data, key, native);
+    }
+    if(data->type == &UA_TYPES[UA_TYPES_EXTENSIONOBJECT])
+        return ua_extensionobject_index(L, dataindex, data, key);
     if(data->type == &UA_TYPES[UA_TYPES_DATAVALUE])
         return ua_datavalue_index(L, dataindex, data->data, key);
     if(data->type == &UA_TYPES[UA_TYPES_DIAGNOSTICINFO])
         return ua_diagnosticinfo_index(L, dataindex, data->data, key);
 
-    const UA_DataType *type;
-    size_t *arraylen;
-    void *member = ua_getmember(data->data, data->type, key, &type, &arraylen);
-    if(!member)
+    const ua_member *m = ua_findmember(L, data->type, keyindex);
+    if(!m)
         return luaL_error(L, "Cannot get this index %s", key);
-    if(arraylen)
-        return ua_return_memberarray(L, dataindex, member, arraylen, type);
-    return ua_return_member(L, dataindex, member, type);
+    if(native && !m->isArray &&
+       ua_pushnative(L, (void*)((uintptr_t)data->data + m->offset), m->type))
+        return 1;
+    return ua_index_member(L, dataindex, data, m);
 }
 
 int ua_index(lua_State *L) {
-    const char *key = lua_tostring(L, 2);
-    int ret = ua_index_key(L, 1, key);
+    int ret = ua_index_key(L, 1, 2, 1);
     if(ret == 0)
         return 0;
     uatolua(L, -1);
@@ -792,6 +1325,7 @@ ua_nodeid_newindex(lua_State *L, UA_NodeId *id, const char *key, int index) {
     if(strcmp(key, "identifier") == 0) {
         ua_data *data = luaL_testudata(L, index , "open62541-data");
         if(data) {
+            ua_checkscope(L, data->scope);
             if(data->type == &UA_TYPES[UA_TYPES_UINT32]) {
                 UA_NodeId_deleteMembers(id);
                 id->identifier.numeric = *(UA_UInt32*)data->data;
@@ -817,8 +1351,9 @@ ua_nodeid_newindex(lua_State *L, UA_NodeId *id, const char *key, int index) {
                 id->identifier.string = UA_String_fromChars(lua_tostring(L, index));
                 id->identifierType = UA_NODEIDTYPE_STRING;
             } else if(lua_isnumber(L, index)) {
+                UA_UInt32 numeric = ua_nodeid_numeric(L, index);
                 UA_NodeId_deleteMembers(id);
-                id->identifier.numeric = lua_tointeger(L, index);
+                id->identifier.numeric = numeric;
                 id->identifierType = UA_NODEIDTYPE_NUMERIC;
             } else {
                 return luaL_error(L, "Not a valid nodeid index");
@@ -922,6 +1457,7 @@ ua_datavalue_newindex(lua_State *L, UA_DataValue *v, const char *key, int index)
         }
         ua_data *data = luaL_testudata(L, index , "open62541-data");
         if(data && data->type == &UA_TYPES[UA_TYPES_VARIANT]) {
+            ua_checkscope(L, data->scope);
             UA_Variant_deleteMembers(&v->value);
             UA_Variant_copy(data->data, &v->value);
         } else
@@ -1003,9 +1539,13 @@ ua_datavalue_newindex(lua_State *L, UA_DataValue *v, const char *key, int index)
     return luaL_error(L, "Not a valid datavalue index");
 }
 
-// value, key, member
+/* value, key, member. The new member content is allocated in the arena of the
+   parent. */
 int ua_newindex(lua_State *L) {
     ua_data *parent = luaL_checkudata (L, 1, "open62541-data");
+    ua_checkscope(L, parent->scope);
+    ua_arena_use(ua_arena_find(parent->scope));
+    ua_memory_check(L);
     if(!lua_isstring(L, 2))
         return luaL_error(L, "Index must be a string");
     const char *key = lua_tostring(L, 2);
@@ -1016,32 +1556,24 @@ int ua_newindex(lua_State *L) {
         return ua_expandednodeid_newindex(L, parent->data, key, 3);
     if(parent->type == &UA_TYPES[UA_TYPES_LOCALIZEDTEXT])
         return ua_localizedtext_newindex(L, parent->data, key, 3);
-    if(parent->type == &UA_TYPES[UA_TYPES_VARIANT])
+    if(parent->type == &UA_TYPES[UA_TYPES_VARIANT]) {
+        ua_variant_decodelazy(L, parent->data, parent->scope);
         return ua_variant_newindex(L, parent->data, key, 3);
+    }
     if(parent->type == &UA_TYPES[UA_TYPES_DATAVALUE])
         return ua_datavalue_newindex(L, parent->data, key, 3);
 
-    const UA_DataType *membertype;
-    size_t *arraylen;
-    void *member = ua_getmember(parent->data, parent->type, key, &membertype, &arraylen);
-    if(!member)
+    const ua_member *m = ua_findmember(L, parent->type, 2);
+    if(!m)
         return luaL_error(L, "Index not found");
+    const UA_DataType *membertype = m->type;
+    void *member = (void*)((uintptr_t)parent->data + m->offset);
 
-    if(arraylen) {
-        ua_array *array = ua_getarray(L, 3);
-        if(!array)
-            return luaL_error(L, "The value is not an array");
-        if(membertype != array->type)
-            return luaL_error(L, "Types don't match");
-        UA_Array_delete(*(void**)member, *arraylen, membertype);
-        UA_Array_copy(*array->data, *array->length, member, membertype);
-        *arraylen = *array->length;
+    if(m->isArray) {
+        ua_fromlua_array(L, 3, member, membertype);
         return 0;
     }
-    
-    ua_data *data = ua_getdata(L, 3, membertype);
-    UA_deleteMembers(member, membertype);
-    UA_copy(data->data, member, membertype);
+    ua_fromlua(L, 3, member, membertype);
     return 0;
 }
 
@@ -1064,6 +1596,9 @@ const char * localizedtext_keys[] = {"locale", "text"};
 size_t variant_keysSize = 2;
 const char * variant_keys[] = {"value", "arrayDimensions"};
 
+size_t extensionobject_keysSize = 2;
+const char * extensionobject_keys[] = {"typeId", "body"};
+
 size_t datavalue_keysSize = 6;
 const char * datavalue_keys[] = {"value", "status", "sourceTimestamp", "sourcePicoseconds",
                                  "serverTimestamp", "serverPicoseconds"};
@@ -1088,12 +1623,13 @@ ua_iterate_builtin(lua_State *L, int dataindex, const char *key,
         i++; // the next index
     }
     lua_pushstring(L, keys[i]);
-    return 1 + ua_index_key(L, dataindex, keys[i]);
+    return 1 + ua_index_key(L, dataindex, lua_gettop(L), 0);
 }
 
 /* take (v, lastkey), return (key+1, v[key+1]) or return nothing */
 static int ua_iterate_atindex(lua_State *L, int dataindex) {
     ua_data *data = luaL_checkudata (L, dataindex, "open62541-data");
+    ua_checkscope(L, data->scope);
     const char *key = lua_tostring(L, dataindex+1);
     
     if(data->type == &UA_TYPES[UA_TYPES_NODEID])
@@ -1104,25 +1640,30 @@ static int ua_iterate_atindex(lua_State *L, int dataindex) {
         return ua_iterate_builtin(L, dataindex, key, localizedtext_keys, localizedtext_keysSize);
     else if(data->type == &UA_TYPES[UA_TYPES_VARIANT])
         return ua_iterate_builtin(L, dataindex, key, variant_keys, variant_keysSize);
+    else if(data->type == &UA_TYPES[UA_TYPES_EXTENSIONOBJECT])
+        return ua_iterate_builtin(L, dataindex, key, extensionobject_keys,
+                                  extensionobject_keysSize);
     else if(data->type == &UA_TYPES[UA_TYPES_DATAVALUE])
         return ua_iterate_builtin(L, dataindex, key, datavalue_keys, datavalue_keysSize);
     else if(data->type == &UA_TYPES[UA_TYPES_DIAGNOSTICINFO])
         return ua_iterate_builtin(L, dataindex, key, diagnosticinfo_keys, diagnosticinfo_keysSize);
     
-    int memberindex;
+    const ua_member *m;
     if(!key) {
-        memberindex = 0;
+        m = ua_members(L, data->type);
+        if(!m)
+            return 0;
     } else {
-        memberindex = find_memberindex(data->type, key);
-        if(memberindex < 0)
+        m = ua_findmember(L, data->type, dataindex+1);
+        if(!m)
             return luaL_error(L, "No valid index");
-        memberindex++;
+        if(m->index + 1 >= data->type->membersSize)
+            return 0;
+        m++;
     }
-    if(memberindex >= data->type->membersSize)
-        return 0;
 
-    lua_pushstring(L, data->type->members[memberindex].memberName);
-    ua_index_key(L, dataindex, data->type->members[memberindex].memberName);
+    lua_pushstring(L, m->name);
+    ua_index_member(L, dataindex, data, m);
     return 2;
 }
 
@@ -1147,243 +1688,511 @@ int ua_pairs(lua_State *L) {
 /* ToString */
 /************/
 
-static int ua_tostring_level(lua_State *L, size_t level);
-static int ua_array_tostring_level(lua_State *L, size_t level);
-
-/* use iterate over members. the data is at -1 */
-static int
-ua_tostring_structured(lua_State *L, size_t level) {
-    luaL_testudata(L, -1, "open62541-data");
-    lua_pushnil(L);
-    int k_index = lua_gettop(L);
-    int pushed = 0;
-    while(true) {
-        int ret = ua_iterate_atindex(L, k_index-1);
-        if(ret == 0)
-            break;
-        lua_insert(L, -2); // move the key to the top
-        lua_replace(L, k_index);
-        int v_index = lua_gettop(L);
+/* The printer walks the value in C and writes into a single luaL_Buffer.
+   Structures and arrays nested deeper than maxDepth are collapsed and arrays
+   print at most maxElements elements. Zero is unlimited. */
+typedef struct {
+    luaL_Buffer b;
+    size_t maxDepth;
+    size_t maxElements;
+} ua_printer;
+
+/* The defaults are shared by all threads */
+static struct {
+    struct spinlock lock;
+    size_t maxDepth;
+    size_t maxElements;
+} ua_tostring_defaults;
+
+static void ua_print_value(ua_printer *pr, const void *p, const UA_DataType *type, size_t level);
+static void ua_print_array(ua_printer *pr, const void *p, size_t len,
+                           const UA_DataType *type, size_t level);
+
+#define UA_PRINT_MAXNUMBER 400 /* enough for %f of DBL_MAX */
+
+#define ua_print_format(pr, fmt, ...) do {                              \
+        char *out = luaL_prepbuffsize(&(pr)->b, UA_PRINT_MAXNUMBER);    \
+        luaL_addsize(&(pr)->b, snprintf(out, UA_PRINT_MAXNUMBER, fmt, __VA_ARGS__)); \
+    } while(0)
+
+static void
+ua_print_indent(ua_printer *pr, size_t level) {
+    for(size_t j = 0; j < level; j++)
+        luaL_addstring(&pr->b, "  ");
+}
 
-        if(level > 0 || pushed != 0) {
-            lua_pushstring(L, "\n");
-            pushed++;
-        }
-        for(size_t j = 0; j < level; j++)
-            lua_pushstring(L, "  ");
-        lua_pushvalue(L, k_index);
-        lua_pushstring(L, " = ");
-        pushed += level + 2;
-
-        lua_pushvalue(L, v_index);
-        lua_remove(L, v_index);
-        v_index = lua_gettop(L);
-        if(lua_isnil(L, -1)) {
-            lua_pushstring(L, "nil");
-            pushed++;
-        } else if(luaL_testudata(L, -1, "open62541-data"))
-            pushed += ua_tostring_level(L, level+1);
-        else
-            pushed += ua_array_tostring_level(L, level+1);
-        lua_remove(L, v_index);
-        lua_concat(L, pushed);
-        pushed = 1;
-    }
-    lua_remove(L, k_index);
-    return 1;
+/* key = value. A NULL member is printed as nil. */
+static void
+ua_print_member(ua_printer *pr, size_t level, size_t *count, const char *key,
+                const void *p, const UA_DataType *type) {
+    if(level > 0 || *count > 0)
+        luaL_addchar(&pr->b, '\n');
+    (*count)++;
+    ua_print_indent(pr, level);
+    luaL_addstring(&pr->b, key);
+    luaL_addstring(&pr->b, " = ");
+    if(!p)
+        luaL_addstring(&pr->b, "nil");
+    else
+        ua_print_value(pr, p, type, level + 1);
 }
 
-static int
-ua_tostring_level(lua_State *L, size_t level) {
-    ua_data *d = luaL_testudata(L, -1, "open62541-data");
-    void *data = d->data;
-    const UA_DataType *type = d->type;
+static void
+ua_print_memberarray(ua_printer *pr, size_t level, size_t *count, const char *key,
+                     const void *p, size_t len, const UA_DataType *type) {
+    if(level > 0 || *count > 0)
+        luaL_addchar(&pr->b, '\n');
+    (*count)++;
+    ua_print_indent(pr, level);
+    luaL_addstring(&pr->b, key);
+    luaL_addstring(&pr->b, " = ");
+    ua_print_array(pr, p, len, type, level + 1);
+}
 
-    char out[37];
+static void
+ua_print_structure(ua_printer *pr, const void *p, const UA_DataType *type, size_t level) {
+    if(pr->maxDepth > 0 && level > pr->maxDepth) {
+        luaL_addstring(&pr->b, "ua.types.");
+        luaL_addstring(&pr->b, type->typeName);
+        luaL_addstring(&pr->b, "(...)");
+        return;
+    }
+    const UA_DataType *uint16 = &UA_TYPES[UA_TYPES_UINT16];
+    const UA_DataType *uint32 = &UA_TYPES[UA_TYPES_UINT32];
+    const UA_DataType *int32 = &UA_TYPES[UA_TYPES_INT32];
+    const UA_DataType *string = &UA_TYPES[UA_TYPES_STRING];
+    const UA_DataType *datetime = &UA_TYPES[UA_TYPES_DATETIME];
+    size_t count = 0;
     switch(type->typeIndex) {
-    case UA_TYPES_BOOLEAN:
-        if(*(UA_Boolean*)data)
-            lua_pushstring(L, "true");
+    case UA_TYPES_NODEID: {
+        const UA_NodeId *id = p;
+        ua_print_member(pr, level, &count, "namespaceIndex", &id->namespaceIndex, uint16);
+        if(id->identifierType == UA_NODEIDTYPE_NUMERIC)
+            ua_print_member(pr, level, &count, "identifier", &id->identifier.numeric, uint32);
+        else if(id->identifierType == UA_NODEIDTYPE_GUID)
+            ua_print_member(pr, level, &count, "identifier", &id->identifier.guid,
+                            &UA_TYPES[UA_TYPES_GUID]);
         else
-            lua_pushstring(L, "false");
-        return 1;
-    case UA_TYPES_SBYTE:
-        snprintf(out, 40, "%hhi", *(UA_SByte*)data);
-        lua_pushstring(L, out);
-        return 1;
-    case UA_TYPES_BYTE:
-        snprintf(out, 40, "%hhu", *(UA_Byte*)data);
-        lua_pushstring(L, out);
-        return 1;
-    case UA_TYPES_INT16:
-        snprintf(out, 40, "%hi", *(UA_Int16*)data);
-        lua_pushstring(L, out);
-        return 1;
-    case UA_TYPES_UINT16:
-        snprintf(out, 40, "%hu", *(UA_UInt16*)data);
-        lua_pushstring(L, out);
-        return 1;
+            ua_print_member(pr, level, &count, "identifier", &id->identifier.string, string);
+        return;
+    }
+    case UA_TYPES_EXPANDEDNODEID: {
+        const UA_ExpandedNodeId *id = p;
+        ua_print_member(pr, level, &count, "nodeId", &id->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+        ua_print_member(pr, level, &count, "namespaceUri", &id->namespaceUri, string);
+        ua_print_member(pr, level, &count, "serverIndex", &id->serverIndex, uint32);
+        return;
+    }
+    case UA_TYPES_LOCALIZEDTEXT: {
+        const UA_LocalizedText *lt = p;
+        ua_print_member(pr, level, &count, "locale", &lt->locale, string);
+        ua_print_member(pr, level, &count, "text", &lt->text, string);
+        return;
+    }
+    case UA_TYPES_VARIANT: {
+        /* a variant that stays encoded on errors is printed as such */
+        UA_Variant_decodeLazy((UA_Variant*)(uintptr_t)p);
+        const UA_Variant *v = p;
+        if(!v->type)
+            ua_print_member(pr, level, &count, "value", NULL, NULL);
+        else if(UA_Variant_isScalar(v))
+            ua_print_member(pr, level, &count, "value", v->data, v->type);
+        else
+            ua_print_memberarray(pr, level, &count, "value", v->data, v->arrayLength, v->type);
+        ua_print_memberarray(pr, level, &count, "arrayDimensions", v->arrayDimensions,
+                             v->arrayDimensionsSize, uint32);
+        return;
+    }
+    case UA_TYPES_DATAVALUE: {
+        const UA_DataValue *v = p;
+        ua_print_member(pr, level, &count, "value", v->hasValue ? &v->value : NULL,
+                        &UA_TYPES[UA_TYPES_VARIANT]);
+        ua_print_member(pr, level, &count, "status", v->hasStatus ? &v->status : NULL,
+                        &UA_TYPES[UA_TYPES_STATUSCODE]);
+        ua_print_member(pr, level, &count, "sourceTimestamp",
+                        v->hasSourceTimestamp ? &v->sourceTimestamp : NULL, datetime);
+        ua_print_member(pr, level, &count, "sourcePicoseconds",
+                        v->hasSourcePicoseconds ? &v->sourcePicoseconds : NULL, uint16);
+        ua_print_member(pr, level, &count, "serverTimestamp",
+                        v->hasServerTimestamp ? &v->serverTimestamp : NULL, datetime);
+        ua_print_member(pr, level, &count, "serverPicoseconds",
+                        v->hasServerPicoseconds ? &v->serverPicoseconds : NULL, uint16);
+        return;
+    }
+    case UA_TYPES_DIAGNOSTICINFO: {
+        const UA_DiagnosticInfo *di = p;
+        ua_print_member(pr, level, &count, "symbolicId",
+                        di->hasSymbolicId ? &di->symbolicId : NULL, int32);
+        ua_print_member(pr, level, &count, "namespaceUri",
+                        di->hasNamespaceUri ? &di->namespaceUri : NULL, int32);
+        ua_print_member(pr, level, &count, "localizedText",
+                        di->hasLocalizedText ? &di->localizedText : NULL, int32);
+        ua_print_member(pr, level, &count, "locale",
+                        di->hasLocale ? &di->locale : NULL, int32);
+        ua_print_member(pr, level, &count, "additionalInfo",
+                        di->hasAdditionalInfo ? &di->additionalInfo : NULL, string);
+        ua_print_member(pr, level, &count, "innerStatusCode",
+                        di->hasInnerStatusCode ? &di->innerStatusCode : NULL,
+                        &UA_TYPES[UA_TYPES_STATUSCODE]);
+        ua_print_member(pr, level, &count, "innerDiagnosticInfo",
+                        di->hasInnerDiagnosticInfo ? di->innerDiagnosticInfo : NULL,
+                        &UA_TYPES[UA_TYPES_DIAGNOSTICINFO]);
+        return;
+    }
+    default:
+        break;
+    }
+
+    const ua_member *members = ua_members(pr->b.L, type);
+    if(!members)
+        return;
+    for(size_t i = 0; i < type->membersSize; i++) {
+        const ua_member *m = &members[i];
+        const void *member = (const void*)((uintptr_t)p + m->offset);
+        if(m->isArray)
+            ua_print_memberarray(pr, level, &count, m->name,
+                                 *(void * const *)((uintptr_t)member + sizeof(size_t)),
+                                 *(const size_t*)member, m->type);
+        else
+            ua_print_member(pr, level, &count, m->name, member, m->type);
+    }
+}
+
+static void
+ua_print_value(ua_printer *pr, const void *p, const UA_DataType *type, size_t level) {
+    switch(type->typeIndex) {
+    case UA_TYPES_BOOLEAN:
+        luaL_addstring(&pr->b, *(const UA_Boolean*)p ? "true" : "false");
+        return;
+    case UA_TYPES_SBYTE:
+        ua_print_format(pr, "%hhi", *(const UA_SByte*)p);
+        return;
+    case UA_TYPES_BYTE:
+        ua_print_format(pr, "%hhu", *(const UA_Byte*)p);
+        return;
+    case UA_TYPES_INT16:
+        ua_print_format(pr, "%hi", *(const UA_Int16*)p);
+        return;
+    case UA_TYPES_UINT16:
+        ua_print_format(pr, "%hu", *(const UA_UInt16*)p);
+        return;
     case UA_TYPES_INT32:
-        snprintf(out, 40, "%i", *(UA_Int32*)data);
-        lua_pushstring(L, out);
-        return 1;
+        ua_print_format(pr, "%i", *(const UA_Int32*)p);
+        return;
     case UA_TYPES_UINT32:
-        snprintf(out, 40, "%u", *(UA_UInt32*)data);
-        lua_pushstring(L, out);
-        return 1;
+        ua_print_format(pr, "%u", *(const UA_UInt32*)p);
+        return;
     case UA_TYPES_INT64:
-        snprintf(out, 40, "%li", *(UA_Int64*)data);
-        lua_pushstring(L, out);
-        return 1;
+        ua_print_format(pr, "%li", *(const UA_Int64*)p);
+        return;
     case UA_TYPES_UINT64:
-        snprintf(out, 40, "%lu", *(UA_UInt64*)data);
-        lua_pushstring(L, out);
-        return 1;
+        ua_print_format(pr, "%lu", *(const UA_UInt64*)p);
+        return;
     case UA_TYPES_STATUSCODE:
-        snprintf(out, 40, "0x%08x", *(UA_StatusCode*)data);
-        lua_pushstring(L, out);
-        return 1;
+        ua_print_format(pr, "0x%08x", *(const UA_StatusCode*)p);
+        return;
     case UA_TYPES_FLOAT:
-        snprintf(out, 40, "%f", *(UA_Float*)data);
-        lua_pushstring(L, out);
-        return 1;
+        ua_print_format(pr, "%f", *(const UA_Float*)p);
+        return;
     case UA_TYPES_DOUBLE:
-        snprintf(out, 40, "%lf", *(UA_Double*)data);
-        lua_pushstring(L, out);
-        return 1;
+        ua_print_format(pr, "%lf", *(const UA_Double*)p);
+        return;
     case UA_TYPES_GUID: {
-        UA_Guid *id = (UA_Guid*)data;
+        const UA_Guid *id = p;
+        char *out = luaL_prepbuffsize(&pr->b, 37);
         snprintf(out, 37, "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
                  id->data1, id->data2, id->data3, id->data4[0], id->data4[1],
                  id->data4[2], id->data4[3], id->data4[4], id->data4[5], id->data4[6], id->data4[7]);
-        lua_pushstring(L, out);
-        return 1;
+        luaL_addsize(&pr->b, 36);
+        return;
     }
     case UA_TYPES_DATETIME: {
-        UA_String str = UA_DateTime_toString(*(UA_DateTime*)data);
-        lua_pushlstring(L, (char*)str.data, str.length);
-        UA_String_deleteMembers(&str);
-        return 1;
+        UA_DateTimeStruct t = UA_DateTime_toStruct(*(const UA_DateTime*)p);
+        ua_print_format(pr, "%02u/%02u/%04u %02u:%02u:%02u.%03u.%03u.%03u",
+                        t.month, t.day, t.year, t.hour, t.min, t.sec,
+                        t.milliSec, t.microSec, t.nanoSec);
+        return;
     }
     case UA_TYPES_STRING:
     case UA_TYPES_BYTESTRING:
     case UA_TYPES_XMLELEMENT: {
-        UA_String *s = (UA_String*)data;
+        const UA_String *s = p;
         if(s->data == NULL) {
-            if(level == 0)
-                lua_pushfstring(L, "");
-            else
-                lua_pushfstring(L, "ua.types.%s()", type->typeName);
-            return 1;
-        } else {
-            if(level == 0) {
-                lua_pushlstring(L, (char*)s->data, s->length);
-                return 1;
-            } else {
-                lua_pushstring(L, "\"");
-                lua_pushlstring(L, (char*)s->data, s->length);
-                lua_pushstring(L, "\"");
-                lua_concat(L, 3);
-                return 1;
+            if(level > 0) {
+                luaL_addstring(&pr->b, "ua.types.");
+                luaL_addstring(&pr->b, type->typeName);
+                luaL_addstring(&pr->b, "()");
             }
+        } else if(level == 0) {
+            luaL_addlstring(&pr->b, (const char*)s->data, s->length);
+        } else {
+            luaL_addchar(&pr->b, '"');
+            luaL_addlstring(&pr->b, (const char*)s->data, s->length);
+            luaL_addchar(&pr->b, '"');
         }
+        return;
     }
     case UA_TYPES_EXTENSIONOBJECT:
-        lua_pushfstring(L, "ua.types.%s", type->typeName);
-        return 1;
-    case UA_TYPES_EXPANDEDNODEID:
-    case UA_TYPES_LOCALIZEDTEXT:
-    case UA_TYPES_DIAGNOSTICINFO:
-    case UA_TYPES_QUALIFIEDNAME:
-    case UA_TYPES_NODEID:
-    case UA_TYPES_VARIANT:
-    case UA_TYPES_DATAVALUE:
+        luaL_addstring(&pr->b, "ua.types.");
+        luaL_addstring(&pr->b, type->typeName);
+        return;
     default:
-        return ua_tostring_structured(L, level);
+        ua_print_structure(pr, p, type, level);
+        return;
+    }
+}
+
+static void
+ua_print_array(ua_printer *pr, const void *p, size_t len,
+               const UA_DataType *type, size_t level) {
+    if(len > 0 || p)
+        ua_print_format(pr, "ua.Array(ua.types.%s,%d):", type->typeName, (int)len);
+    else
+        ua_print_format(pr, "ua.Array(ua.types.%s,-1):", type->typeName);
+    if(len > 0 && pr->maxDepth > 0 && level > pr->maxDepth) {
+        luaL_addstring(&pr->b, " ...");
+        return;
+    }
+    size_t n = len;
+    if(pr->maxElements > 0 && n > pr->maxElements)
+        n = pr->maxElements;
+    uintptr_t e = (uintptr_t)p;
+    for(size_t i = 0; i < n; i++) {
+        luaL_addchar(&pr->b, '\n');
+        ua_print_indent(pr, level);
+        ua_print_format(pr, "%d = ", (int)i + 1);
+        ua_print_value(pr, (const void*)e, type, level + 1);
+        e += type->memSize;
+    }
+    if(n < len) {
+        luaL_addchar(&pr->b, '\n');
+        ua_print_indent(pr, level);
+        ua_print_format(pr, "... (%d more)", (int)(len - n));
     }
-    return luaL_error(L, "Cannot convert the value to a string");
+}
+
+static void
+ua_printer_init(lua_State *L, ua_printer *pr, int depthindex) {
+    SPIN_LOCK(&ua_tostring_defaults);
+    size_t maxDepth = ua_tostring_defaults.maxDepth;
+    size_t maxElements = ua_tostring_defaults.maxElements;
+    SPIN_UNLOCK(&ua_tostring_defaults);
+    pr->maxDepth = (size_t)luaL_optinteger(L, depthindex, (lua_Integer)maxDepth);
+    pr->maxElements = (size_t)luaL_optinteger(L, depthindex + 1, (lua_Integer)maxElements);
+    luaL_buffinit(L, &pr->b);
 }
 
 int ua_tostring(lua_State *L) {
-    return ua_tostring_level(L, 0);
+    ua_data *d = luaL_checkudata(L, 1, "open62541-data");
+    ua_checkscope(L, d->scope);
+    ua_arena_use(ua_arena_find(d->scope)); /* variants are decoded lazily */
+    ua_printer pr;
+    ua_printer_init(L, &pr, 2);
+    ua_print_value(&pr, d->data, d->type, 0);
+    luaL_pushresult(&pr.b);
+    return 1;
+}
+
+/* ua.tostring(v [, maxDepth [, maxElements]]) prints the value or array with
+   the given limits instead of the defaults */
+int ua_tostring_limited(lua_State *L) {
+    if(luaL_testudata(L, 1, "open62541-array"))
+        return ua_array_tostring(L);
+    return ua_tostring(L);
+}
+
+/* ua.tostringLimits([maxDepth [, maxElements]]) sets the default limits of
+   tostring and returns the previous ones */
+int ua_tostring_limits(lua_State *L) {
+    UA_Boolean setDepth = !lua_isnoneornil(L, 1);
+    UA_Boolean setElements = !lua_isnoneornil(L, 2);
+    size_t maxDepth = setDepth ? (size_t)luaL_checkinteger(L, 1) : 0;
+    size_t maxElements = setElements ? (size_t)luaL_checkinteger(L, 2) : 0;
+    SPIN_LOCK(&ua_tostring_defaults);
+    lua_Integer oldDepth = (lua_Integer)ua_tostring_defaults.maxDepth;
+    lua_Integer oldElements = (lua_Integer)ua_tostring_defaults.maxElements;
+    if(setDepth)
+        ua_tostring_defaults.maxDepth = maxDepth;
+    if(setElements)
+        ua_tostring_defaults.maxElements = maxElements;
+    SPIN_UNLOCK(&ua_tostring_defaults);
+    lua_pushinteger(L, oldDepth);
+    lua_pushinteger(L, oldElements);
+    return 2;
 }
 
 /******************/
 /* Array Handling */
 /******************/
 
-static int
-ua_array_tostring_level(lua_State *L, size_t level) {
-    ua_array *array = luaL_checkudata (L, -1, "open62541-array");
-    size_t len = *array->length;
-    const UA_DataType *type = array->type;
-    
-    int pushed = 1;
-    if(len > 0)
-        lua_pushfstring(L, "ua.Array(ua.types.%s,%d):", type->typeName, (int)len);
-    else {
-        if(*array->data)
-            lua_pushfstring(L, "ua.Array(ua.types.%s,0):", type->typeName);
-        else
-            lua_pushfstring(L, "ua.Array(ua.types.%s,-1):", type->typeName);
-    }
-    uintptr_t p = (uintptr_t)*array->data;
-    for(int i = 0; i < len; i++) {
-        lua_pushstring(L, "\n");
-        for(size_t j = 0; j < level; j++)
-            lua_pushstring(L, "  ");
-        lua_pushfstring(L, "%d = ", i+1);
-        pushed += level + 2;
-
-        /* fake data element */
-        ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-        data->type = type;
-        data->data = (void*)p;
-        luaL_setmetatable(L, "open62541-data");
-        int vi = lua_gettop(L);
-        pushed += ua_tostring_level(L, level+1);
-        data->data = NULL;
-        lua_remove(L, vi);
-
-        p += type->memSize;
-        lua_concat(L, pushed);
-        pushed = 1;
-    }
-    return 1;
+static ua_array *
+ua_checkarray(lua_State *L, int index) {
+    ua_array *array = luaL_checkudata(L, index, "open62541-array");
+    ua_checkscope(L, array->scope);
+    return array;
 }
 
 int ua_array_tostring(lua_State *L) {
-    return ua_array_tostring_level(L, 0);
+    ua_array *array = ua_checkarray(L, 1);
+    ua_arena_use(ua_arena_find(array->scope)); /* variants are decoded lazily */
+    ua_printer pr;
+    ua_printer_init(L, &pr, 2);
+    ua_print_array(&pr, *array->data, *array->length, array->type, 0);
+    luaL_pushresult(&pr.b);
+    return 1;
 }
 
-int ua_array_new(lua_State *L) {
+/* Get the datatype from the type table at the index */
+static const UA_DataType *
+ua_checktype(lua_State *L, int index) {
     lua_getfield(L, LUA_REGISTRYINDEX, "open62541-type");
-    if(!lua_getmetatable(L, 1) || !lua_rawequal(L, -1, -2))
-        return luaL_error(L, "The first argument is not a type");
-    lua_rawgeti(L, 1, 1);
+    if(!lua_getmetatable(L, index) || !lua_rawequal(L, -1, -2)) {
+        luaL_error(L, "Argument %d is not a type", index);
+        return NULL;
+    }
+    lua_rawgeti(L, index, 1);
     const UA_DataType *type = lua_touserdata(L, -1);
+    lua_pop(L, 3);
+    return type;
+}
 
-    if(!lua_isnumber(L, 2))
-        return luaL_error(L, "The second argument is not a valid array size");
-
-    int size = lua_tointeger(L, 2);
+ua_array *
+ua_newarray(lua_State *L, const UA_DataType *type) {
+    ua_memory_step(L);
     ua_array *array = lua_newuserdata(L, sizeof(ua_array));
     array->type = type;
     array->data = &array->local_data;
     array->length = &array->local_length;
-    if(size < 0) {
-        array->local_length = 0;
-        array->local_data = NULL;
-    } else {
-        array->local_length = size;
-        array->local_data = UA_Array_new(size, type);
-    }
+    array->local_length = 0;
+    array->local_data = NULL;
+    array->capacity = 0;
+    array->scope = ua_arena_id(ua_arena_current());
     luaL_setmetatable(L, "open62541-array");
+    return array;
+}
+
+static ua_array *
+ua_array_push(lua_State *L, const UA_DataType *type, size_t size) {
+    ua_array *array = ua_newarray(L, type);
+    array->local_length = size;
+    array->local_data = UA_Array_new(size, type);
+    array->capacity = size;
+    return array;
+}
+
+int ua_array_new(lua_State *L) {
+    const UA_DataType *type = ua_checktype(L, 1);
+    ua_arena_use(ua_arena_innermost());
+    ua_memory_check(L);
+
+    if(!lua_isnumber(L, 2))
+        return luaL_error(L, "The second argument is not a valid array size");
+
+    int size = lua_tointeger(L, 2);
+    if(size < 0)
+        ua_newarray(L, type);
+    else
+        ua_array_push(L, type, size);
     return 1;
 }
 
+int ua_array_gc(lua_State *L) {
+    ua_array *array = luaL_checkudata(L, 1, "open62541-array");
+    if(array->scope != 0 && !ua_arena_find(array->scope))
+        return 0;
+    if(array->data == &array->local_data) {
+        UA_Array_delete(array->local_data, array->local_length, array->type);
+        array->local_data = NULL;
+        array->local_length = 0;
+    }
+    return 0;
+}
+
+/* Arrays that carry their own data grow geometrically. Arrays that point into
+   a member of a ua_data value grow to the exact size, as their capacity is not
+   known when the member is changed elsewhere. */
+static size_t
+ua_array_capacity(const ua_array *array) {
+    if(array->data == &array->local_data && array->local_data > UA_EMPTY_ARRAY_SENTINEL)
+        return array->capacity;
+    return *array->length;
+}
+
+static void
+ua_array_grow(lua_State *L, ua_array *array, size_t size) {
+    size_t capacity = ua_array_capacity(array);
+    if(size <= capacity)
+        return;
+    UA_Boolean local = (array->data == &array->local_data);
+    if(local) {
+        size_t newcapacity = capacity * 2;
+        if(newcapacity < 8)
+            newcapacity = 8;
+        if(newcapacity > size)
+            size = newcapacity;
+    }
+    void *old = *array->data;
+    if(old == UA_EMPTY_ARRAY_SENTINEL)
+        old = NULL;
+    void *data = ua_realloc(old, size * array->type->memSize);
+    if(!data) {
+        luaL_error(L, "Out of memory");
+        return;
+    }
+    *array->data = data;
+    if(local)
+        array->capacity = size;
+}
+
+/* Open a gap of n initialized elements at pos */
+static void *
+ua_array_opengap(lua_State *L, ua_array *array, size_t pos, size_t n) {
+    size_t len = *array->length;
+    size_t memSize = array->type->memSize;
+    ua_array_grow(L, array, len + n);
+    uintptr_t base = (uintptr_t)*array->data;
+    memmove((void*)(base + (pos + n) * memSize), (void*)(base + pos * memSize),
+            (len - pos) * memSize);
+    memset((void*)(base + pos * memSize), 0, n * memSize);
+    *array->length = len + n;
+    return (void*)(base + pos * memSize);
+}
+
+/* Remove n elements starting at pos */
+static void
+ua_array_closegap(ua_array *array, size_t pos, size_t n) {
+    size_t len = *array->length;
+    size_t memSize = array->type->memSize;
+    uintptr_t base = (uintptr_t)*array->data;
+    if(!array->type->fixedSize) {
+        for(size_t i = pos; i < pos + n; i++)
+            UA_deleteMembers((void*)(base + i * memSize), array->type);
+    }
+    if(len == n && array->data != &array->local_data) {
+        ua_free(*array->data);
+        *array->data = UA_EMPTY_ARRAY_SENTINEL;
+        *array->length = 0;
+        return;
+    }
+    memmove((void*)(base + pos * memSize), (void*)(base + (pos + n) * memSize),
+            (len - pos - n) * memSize);
+    *array->length = len - n;
+}
+
+/* ua.Array is a table with a __call metamethod */
+int ua_array_call(lua_State *L) {
+    lua_remove(L, 1);
+    return ua_array_new(L);
+}
+
+/* The table with the array methods is the first upvalue */
 int ua_array_index(lua_State *L) {
-    ua_array *array = luaL_checkudata (L, 1, "open62541-array");
+    ua_array *array = ua_checkarray(L, 1);
+    if(lua_type(L, 2) == LUA_TSTRING) {
+        lua_pushvalue(L, 2);
+        lua_rawget(L, lua_upvalueindex(1));
+        return 1;
+    }
     if(!lua_isnumber(L, 2))
         return luaL_error(L, "Arrays can only be indexed numerically");
     int index = lua_tointeger(L, 2);
@@ -1394,61 +2203,18 @@ int ua_array_index(lua_State *L) {
     ptr += index * array->type->memSize;
 
     /* convert to a native type */
-    switch(array->type->typeIndex) {
-    case UA_TYPES_BOOLEAN:
-        lua_pushboolean(L, *(UA_Boolean*)ptr);
-        return 1;
-    case UA_TYPES_SBYTE:
-        lua_pushinteger(L, *(UA_SByte*)ptr);
-        return 1;
-    case UA_TYPES_BYTE:
-        lua_pushinteger(L, *(UA_Byte*)ptr);
-        return 1;
-    case UA_TYPES_INT16:
-        lua_pushinteger(L, *(UA_Int16*)ptr);
-        return 1;
-    case UA_TYPES_UINT16:
-        lua_pushinteger(L, *(UA_UInt16*)ptr);
-        return 1;
-    case UA_TYPES_UINT32:
-        lua_pushinteger(L, *(UA_UInt32*)ptr);
-        return 1;
-    case UA_TYPES_INT32:
-    case UA_TYPES_STATUSCODE:
-        lua_pushinteger(L, *(UA_Int32*)ptr);
-        return 1;
-    case UA_TYPES_INT64:
-        lua_pushinteger(L, *(UA_Int64*)ptr);
-        return 1;
-    case UA_TYPES_UINT64:
-        lua_pushinteger(L, *(UA_UInt64*)ptr);
+    if(ua_pushnative(L, (void*)ptr, array->type))
         return 1;
-    case UA_TYPES_FLOAT:
-        lua_pushnumber(L, *(UA_Float*)ptr);
-        return 1;
-    case UA_TYPES_DOUBLE:
-        lua_pushnumber(L, *(UA_Double*)ptr);
-        return 1;
-    case UA_TYPES_STRING:
-    case UA_TYPES_BYTESTRING:
-    case UA_TYPES_XMLELEMENT:
-        lua_pushlstring(L, (char*)((UA_String*)ptr)->data, ((UA_String*)ptr)->length);
-        return 1;
-    default:
-        break;
-    }
 
     /* return a copy */
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = array->type;
-    data->data = UA_new(array->type);
-    UA_copy((void*)ptr, data->data, array->type);
-    luaL_setmetatable(L, "open62541-data");
+    ua_pushcopy(L, (void*)ptr, array->type);
     return 1;
 }
 
 int ua_array_newindex(lua_State *L) {
-    ua_array *array = luaL_checkudata (L, 1, "open62541-array");
+    ua_array *array = ua_checkarray(L, 1);
+    ua_arena_use(ua_arena_find(array->scope));
+    ua_memory_check(L);
     if(!array)
         return luaL_error(L, "Not an array");
     if(!lua_isnumber(L, 2))
@@ -1459,18 +2225,7 @@ int ua_array_newindex(lua_State *L) {
     if(lua_isnil(L, 3)) {
         if(index < 0 || index >= *array->length)
             return luaL_error(L, "Cannot remove an entry out of the range");
-        if(*array->length == 1) {
-            UA_Array_delete(*array->data, 1, array->type);
-            *array->data = UA_EMPTY_ARRAY_SENTINEL;
-            *array->length = 0;
-            return 0;
-        }
-        uintptr_t arr = (uintptr_t)*array->data;
-        UA_deleteMembers((void*)(arr + (array->type->memSize*index)), array->type);
-        for(size_t i = index+1; i < *array->length; i++)
-            memcpy((void*)(arr + (array->type->memSize*(i-1))),
-                   (void*)(arr + (array->type->memSize*i)), array->type->memSize);
-        *array->length -= 1;
+        ua_array_closegap(array, index, 1);
         return 0;
     }
 
@@ -1478,15 +2233,8 @@ int ua_array_newindex(lua_State *L) {
 
     /* insert an entry */
     if(index == *array->length) {
-        size_t newsize = *array->length + 1;
-        if(*array->data == UA_EMPTY_ARRAY_SENTINEL) 
-            *array->data = malloc(array->type->memSize);
-        else
-            *array->data = realloc(*array->data, newsize * array->type->memSize);
-        *array->length = newsize;
-		uintptr_t ptr = (uintptr_t)*array->data;
-        ptr += (newsize-1) * array->type->memSize;
-        UA_copy(data->data, (void*)ptr, array->type);
+        void *ptr = ua_array_opengap(L, array, index, 1);
+        UA_copy(data->data, ptr, array->type);
         return 0;
     }
 
@@ -1500,7 +2248,7 @@ int ua_array_newindex(lua_State *L) {
 }
 
 int ua_array_len(lua_State *L) {
-    ua_array *array = luaL_checkudata (L, 1, "open62541-array");
+    ua_array *array = ua_checkarray(L, 1);
     if(*array->length <= 0)
         lua_pushinteger(L, 0);
     else
@@ -1510,7 +2258,7 @@ int ua_array_len(lua_State *L) {
 
 static int
 ua_array_iterate(lua_State *L) {
-    ua_array *array = luaL_checkudata (L, 1, "open62541-array");
+    ua_array *array = ua_checkarray(L, 1);
     if(!array)
         return luaL_error(L, "Not a open62541 datatype");
     if(!lua_isnumber(L, 2))
@@ -1519,18 +2267,14 @@ ua_array_iterate(lua_State *L) {
     if(index < 0 || index >= (int)*array->length)
         return 0;
     lua_pushnumber(L, index+1);
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->type = array->type;
-    data->data = UA_new(array->type);
 	uintptr_t ptr = (uintptr_t)*array->data;
     ptr += (uintptr_t)(index * array->type->memSize);
-    UA_copy((void*)ptr, data->data, array->type);
-    luaL_setmetatable(L, "open62541-data");
+    ua_pushcopy(L, (void*)ptr, array->type);
     return 2;
 }
         
 int ua_array_pairs(lua_State *L) {
-    ua_array *array = luaL_checkudata (L, 1, "open62541-array");
+    ua_array *array = ua_checkarray(L, 1);
     if(!array)
         return luaL_error(L, "Not a open62541 datatype");
     lua_pushcfunction(L, ua_array_iterate);
@@ -1539,6 +2283,706 @@ int ua_array_pairs(lua_State *L) {
     return 3;
 }
 
+/**************************/
+/* Bulk Array Operations */
+/**************************/
+
+/* The numeric types with a native Lua representation. The elements are
+   transferred in typed loops without going through the metamethods. */
+#define UA_NUMERIC_TYPES(X)                     \
+    X(UA_TYPES_BOOLEAN, UA_Boolean, boolean)    \
+    X(UA_TYPES_SBYTE, UA_SByte, integer)        \
+    X(UA_TYPES_BYTE, UA_Byte, integer)          \
+    X(UA_TYPES_INT16, UA_Int16, integer)        \
+    X(UA_TYPES_UINT16, UA_UInt16, integer)      \
+    X(UA_TYPES_INT32, UA_Int32, integer)        \
+    X(UA_TYPES_UINT32, UA_UInt32, integer)      \
+    X(UA_TYPES_INT64, UA_Int64, integer)        \
+    X(UA_TYPES_UINT64, UA_UInt64, integer)      \
+    X(UA_TYPES_STATUSCODE, UA_Int32, integer)   \
+    X(UA_TYPES_FLOAT, UA_Float, number)         \
+    X(UA_TYPES_DOUBLE, UA_Double, number)
+
+static lua_Integer
+ua_tointeger_at(lua_State *L, int index, size_t pos) {
+    int isnum;
+    lua_Integer i = lua_tointegerx(L, index, &isnum);
+    if(isnum)
+        return i;
+    lua_Number n = lua_tonumberx(L, index, &isnum);
+    if(!isnum)
+        luaL_error(L, "Element %d is not a number", (int)pos);
+    /* truncate, but only values that fit; NaN fails both comparisons */
+    if(!(n >= (lua_Number)LUA_MININTEGER && n < -(lua_Number)LUA_MININTEGER))
+        luaL_error(L, "Element %d is out of the integer range", (int)pos);
+    return (lua_Integer)n;
+}
+
+static lua_Number
+ua_tonumber_at(lua_State *L, int index, size_t pos) {
+    int isnum;
+    lua_Number n = lua_tonumberx(L, index, &isnum);
+    if(!isnum)
+        luaL_error(L, "Element %d is not a number", (int)pos);
+    return n;
+}
+
+static int
+ua_toboolean_at(lua_State *L, int index, size_t pos) {
+    if(lua_isboolean(L, index))
+        return lua_toboolean(L, index);
+    return ua_tonumber_at(L, index, pos) != 0;
+}
+
+/* Write the entries [first, first+n) of the Lua table at tindex to dst */
+static void
+ua_array_readtable(lua_State *L, int tindex, size_t first,
+                   void *dst, size_t n, const UA_DataType *type) {
+    switch(type->typeIndex) {
+#define UA_READTABLE_CASE(INDEX, CTYPE, KIND)                           \
+    case INDEX: {                                                       \
+        CTYPE *p = dst;                                                 \
+        for(size_t k = 0; k < n; k++) {                                 \
+            lua_rawgeti(L, tindex, first + k);                          \
+            p[k] = (CTYPE)ua_to##KIND##_at(L, -1, first + k);           \
+            lua_pop(L, 1);                                              \
+        }                                                               \
+        return;                                                         \
+    }
+    UA_NUMERIC_TYPES(UA_READTABLE_CASE)
+#undef UA_READTABLE_CASE
+    default:
+        break;
+    }
+
+    uintptr_t p = (uintptr_t)dst;
+    for(size_t k = 0; k < n; k++) {
+        lua_rawgeti(L, tindex, first + k);
+        ua_fromlua(L, -1, (void*)p, type);
+        lua_pop(L, 1);
+        p += type->memSize;
+    }
+}
+
+/* arr:totable([i [, j]]) returns the elements i to j in a new Lua table */
+int ua_array_totable(lua_State *L) {
+    ua_array *array = ua_checkarray(L, 1);
+    lua_Integer len = (lua_Integer)*array->length;
+    lua_Integer i = luaL_optinteger(L, 2, 1);
+    lua_Integer j = luaL_optinteger(L, 3, len);
+    luaL_argcheck(L, i >= 1, 2, "index out of range");
+    luaL_argcheck(L, j <= len, 3, "index out of range");
+    if(j < i) {
+        lua_newtable(L);
+        return 1;
+    }
+    lua_createtable(L, (int)(j - i + 1), 0);
+    switch(array->type->typeIndex) {
+#define UA_TOTABLE_CASE(INDEX, CTYPE, KIND)                             \
+    case INDEX: {                                                       \
+        const CTYPE *p = (const CTYPE*)*array->data;                    \
+        for(lua_Integer k = i; k <= j; k++) {                           \
+            lua_push##KIND(L, p[k-1]);                                  \
+            lua_rawseti(L, -2, k - i + 1);                              \
+        }                                                               \
+        return 1;                                                       \
+    }
+    UA_NUMERIC_TYPES(UA_TOTABLE_CASE)
+#undef UA_TOTABLE_CASE
+    default:
+        break;
+    }
+
+    const UA_DataType *type = array->type;
+    for(lua_Integer k = i; k <= j; k++) {
+        /* reload the pointer, the array may be changed by the gc of copies */
+        void *p = (void*)((uintptr_t)*array->data + (size_t)(k-1) * type->memSize);
+        if(!ua_pushnative(L, p, type))
+            ua_pushcopy(L, p, type);
+        lua_rawseti(L, -2, k - i + 1);
+    }
+    return 1;
+}
+
+/* ua.Array.fromtable(type, t) */
+int ua_array_fromtable(lua_State *L) {
+    const UA_DataType *type = ua_checktype(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    ua_arena_use(ua_arena_innermost());
+    ua_memory_check(L);
+    size_t len = lua_rawlen(L, 2);
+    ua_array *array = ua_array_push(L, type, len);
+    if(len > 0)
+        ua_array_readtable(L, 2, 1, array->local_data, len, type);
+    return 1;
+}
+
+/* arr:fill(v) sets all elements to v */
+int ua_array_fill(lua_State *L) {
+    ua_array *array = ua_checkarray(L, 1);
+    ua_arena_use(ua_arena_find(array->scope));
+    ua_memory_check(L);
+    const UA_DataType *type = array->type;
+    ua_data *data = ua_getdata(L, 2, type);
+    size_t len = *array->length;
+    if(len == 0)
+        return 0;
+    if(!type->fixedSize) {
+        uintptr_t p = (uintptr_t)*array->data;
+        for(size_t k = 0; k < len; k++) {
+            UA_deleteMembers((void*)p, type);
+            UA_copy(data->data, (void*)p, type);
+            p += type->memSize;
+        }
+        return 0;
+    }
+    switch(type->memSize) {
+    case 1:
+        memset(*array->data, *(UA_Byte*)data->data, len);
+        break;
+    case 2: {
+        UA_UInt16 v = *(UA_UInt16*)data->data, *p = *array->data;
+        for(size_t k = 0; k < len; k++)
+            p[k] = v;
+        break;
+    }
+    case 4: {
+        UA_UInt32 v = *(UA_UInt32*)data->data, *p = *array->data;
+        for(size_t k = 0; k < len; k++)
+            p[k] = v;
+        break;
+    }
+    case 8: {
+        UA_UInt64 v = *(UA_UInt64*)data->data, *p = *array->data;
+        for(size_t k = 0; k < len; k++)
+            p[k] = v;
+        break;
+    }
+    default: {
+        uintptr_t p = (uintptr_t)*array->data;
+        for(size_t k = 0; k < len; k++) {
+            memcpy((void*)p, data->data, type->memSize);
+            p += type->memSize;
+        }
+    }
+    }
+    return 0;
+}
+
+/* arr:copyfrom(other [, offset]) overwrites the elements starting at offset
+   with the content of the other array (or Lua table) */
+int ua_array_copyfrom(lua_State *L) {
+    ua_array *array = ua_checkarray(L, 1);
+    ua_arena_use(ua_arena_find(array->scope));
+    ua_memory_check(L);
+    const UA_DataType *type = array->type;
+    lua_Integer offset = luaL_optinteger(L, 3, 1);
+    luaL_argcheck(L, offset >= 1, 3, "offset out of range");
+    size_t pos = (size_t)offset - 1;
+    if(lua_istable(L, 2)) {
+        size_t n = lua_rawlen(L, 2);
+        if(pos + n > *array->length)
+            return luaL_error(L, "copyfrom exceeds the array length");
+        if(n > 0)
+            ua_array_readtable(L, 2, 1, (void*)((uintptr_t)*array->data + pos * type->memSize),
+                               n, type);
+        return 0;
+    }
+    ua_array *other = ua_checkarray(L, 2);
+    if(other->type != type)
+        return luaL_error(L, "Types don't match");
+    size_t n = *other->length;
+    if(pos + n > *array->length)
+        return luaL_error(L, "copyfrom exceeds the array length");
+    if(n == 0)
+        return 0;
+    void *dst = (void*)((uintptr_t)*array->data + pos * type->memSize);
+    if(type->fixedSize) {
+        memmove(dst, *other->data, n * type->memSize);
+        return 0;
+    }
+    if(*other->data == *array->data)
+        return luaL_error(L, "Cannot copy an array of non-fixed-size types onto itself");
+    uintptr_t d = (uintptr_t)dst, o = (uintptr_t)*other->data;
+    for(size_t k = 0; k < n; k++) {
+        UA_deleteMembers((void*)d, type);
+        UA_copy((void*)o, (void*)d, type);
+        d += type->memSize;
+        o += type->memSize;
+    }
+    return 0;
+}
+
+/* Insert the value (or all elements of an array or Lua table) at pos */
+static void
+ua_array_insertat(lua_State *L, ua_array *array, size_t pos, int index) {
+    const UA_DataType *type = array->type;
+    if(lua_istable(L, index)) {
+        size_t n = lua_rawlen(L, index);
+        if(n == 0)
+            return;
+        void *dst = ua_array_opengap(L, array, pos, n);
+        ua_array_readtable(L, index, 1, dst, n, type);
+        return;
+    }
+    ua_array *other = luaL_testudata(L, index, "open62541-array");
+    if(other) {
+        ua_checkscope(L, other->scope);
+        if(other->type != type)
+            luaL_error(L, "Types don't match");
+        size_t n = *other->length;
+        if(n == 0)
+            return;
+        /* Empty arrays share NULL or the sentinel as their data pointer */
+        if(other == array || (*array->data > UA_EMPTY_ARRAY_SENTINEL &&
+                              *other->data == *array->data))
+            luaL_error(L, "Cannot insert an array into itself");
+        void *dst = ua_array_opengap(L, array, pos, n);
+        if(type->fixedSize) {
+            memcpy(dst, *other->data, n * type->memSize);
+            return;
+        }
+        uintptr_t d = (uintptr_t)dst, o = (uintptr_t)*other->data;
+        for(size_t k = 0; k < n; k++) {
+            UA_copy((void*)o, (void*)d, type);
+            d += type->memSize;
+            o += type->memSize;
+        }
+        return;
+    }
+    void *dst = ua_array_opengap(L, array, pos, 1);
+    ua_fromlua(L, index, dst, type);
+}
+
+/* arr:append(v, ...) appends the values at the end */
+int ua_array_append(lua_State *L) {
+    ua_array *array = ua_checkarray(L, 1);
+    ua_arena_use(ua_arena_find(array->scope));
+    ua_memory_check(L);
+    int top = lua_gettop(L);
+    ua_array_grow(L, array, *array->length + (top - 1));
+    for(int i = 2; i <= top; i++) {
+        void *dst = ua_array_opengap(L, array, *array->length, 1);
+        ua_fromlua(L, i, dst, array->type);
+    }
+    return 0;
+}
+
+/* arr:insert([pos,] v) inserts the value at pos (default: at the end). If v is
+   an array or a Lua table, all its elements are inserted. */
+int ua_array_insert(lua_State *L) {
+    ua_array *array = ua_checkarray(L, 1);
+    ua_arena_use(ua_arena_find(array->scope));
+    ua_memory_check(L);
+    size_t len = *array->length;
+    if(lua_gettop(L) < 3) {
+        ua_array_insertat(L, array, len, 2);
+        return 0;
+    }
+    lua_Integer pos = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, pos >= 1 && (size_t)pos <= len + 1, 2, "position out of range");
+    ua_array_insertat(L, array, (size_t)pos - 1, 3);
+    return 0;
+}
+
+/* arr:remove(i [, j]) removes the elements i to j */
+int ua_array_remove(lua_State *L) {
+    ua_array *array = ua_checkarray(L, 1);
+    lua_Integer len = (lua_Integer)*array->length;
+    lua_Integer i = luaL_checkinteger(L, 2);
+    lua_Integer j = luaL_optinteger(L, 3, i);
+    luaL_argcheck(L, i >= 1 && i <= len, 2, "index out of range");
+    luaL_argcheck(L, j >= i && j <= len, 3, "index out of range");
+    ua_array_closegap(array, (size_t)i - 1, (size_t)(j - i + 1));
+    return 0;
+}
+
+/* arr:reserve(n) preallocates space for n elements */
+int ua_array_reserve(lua_State *L) {
+    ua_array *array = ua_checkarray(L, 1);
+    ua_arena_use(ua_arena_find(array->scope));
+    ua_memory_check(L);
+    lua_Integer n = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, n >= 0, 2, "size out of range");
+    if(array->data != &array->local_data || (size_t)n <= ua_array_capacity(array))
+        return 0;
+    void *old = array->local_data;
+    if(old == UA_EMPTY_ARRAY_SENTINEL)
+        old = NULL;
+    void *data = ua_realloc(old, (size_t)n * array->type->memSize);
+    if(!data)
+        return luaL_error(L, "Out of memory");
+    array->local_data = data;
+    array->capacity = (size_t)n;
+    return 0;
+}
+
+/***********************/
+/* Conversion from Lua */
+/***********************/
+
+/* The service requests can be written directly from plain Lua values and
+   tables. Nothing is boxed in between: every value is converted straight into
+   its place in the destination structure. */
+
+static void
+ua_string_fromlua(lua_State *L, int index, UA_String *str) {
+    size_t len = 0;
+    const char *s = lua_tolstring(L, index, &len);
+    if(!s)
+        luaL_error(L, "Cannot convert to a string");
+    UA_String_deleteMembers(str);
+    str->data = ua_malloc(len);
+    str->length = len;
+    memcpy(str->data, s, len);
+}
+
+/* Decimal digits without sign or whitespace, up to max */
+static const char *
+ua_parse_decimal(const char *s, unsigned long max, unsigned long *out) {
+    if(!isdigit((unsigned char)*s))
+        return NULL;
+    char *end;
+    errno = 0;
+    *out = strtoul(s, &end, 10);
+    if(errno == ERANGE || *out > max)
+        return NULL;
+    return end;
+}
+
+/* NodeId in the text format "ns=1;i=42", "ns=1;s=name" or "ns=1;g=guid" */
+static void
+ua_nodeid_fromstring(lua_State *L, int index, UA_NodeId *id) {
+    const char *s = lua_tostring(L, index);
+    unsigned long ns = 0;
+    if(strncmp(s, "ns=", 3) == 0) {
+        const char *end = ua_parse_decimal(s + 3, UA_UINT16_MAX, &ns);
+        if(!end)
+            luaL_error(L, "NodeId namespace index out of range");
+        if(*end != ';')
+            luaL_error(L, "NodeId strings are of the form \"ns=1;s=name\"");
+        s = end + 1;
+    }
+    if(s[0] == '\0' || s[1] != '=')
+        luaL_error(L, "NodeId strings are of the form \"ns=1;s=name\"");
+    unsigned long numeric = 0;
+    if(s[0] == 'i') {
+        const char *end = ua_parse_decimal(s + 2, UA_UINT32_MAX, &numeric);
+        if(!end || *end != '\0')
+            luaL_error(L, "NodeId identifier \"%s\" is not a valid UInt32", s + 2);
+    }
+    UA_NodeId_deleteMembers(id);
+    UA_NodeId_init(id);
+    id->namespaceIndex = (UA_UInt16)ns;
+    switch(s[0]) {
+    case 'i':
+        id->identifierType = UA_NODEIDTYPE_NUMERIC;
+        id->identifier.numeric = (UA_UInt32)numeric;
+        break;
+    case 's':
+        id->identifierType = UA_NODEIDTYPE_STRING;
+        id->identifier.string = UA_String_fromChars(s + 2);
+        break;
+    case 'g':
+        lua_pushstring(L, s + 2);
+        parse_guid(L, -1, &id->identifier.guid);
+        lua_pop(L, 1);
+        id->identifierType = UA_NODEIDTYPE_GUID;
+        break;
+    default:
+        luaL_error(L, "NodeId strings are of the form \"ns=1;s=name\"");
+    }
+}
+
+static lua_Integer
+ua_checkinteger_field(lua_State *L, const char *field) {
+    int isnum;
+    lua_Integer i = lua_tointegerx(L, -1, &isnum);
+    if(!isnum)
+        luaL_error(L, "The field %s is not an integer", field);
+    return i;
+}
+
+/* NodeId from {ns=, i=|s=|g=|b=} or {namespaceIndex=, identifier=} */
+static void
+ua_nodeid_fromtable(lua_State *L, int index, UA_NodeId *id) {
+    UA_NodeId_deleteMembers(id);
+    UA_NodeId_init(id);
+    if(lua_getfield(L, index, "ns") == LUA_TNIL) {
+        lua_pop(L, 1);
+        lua_getfield(L, index, "namespaceIndex");
+    }
+    if(!lua_isnil(L, -1))
+        id->namespaceIndex = (UA_UInt16)ua_checkinteger_field(L, "ns");
+    lua_pop(L, 1);
+
+    if(lua_getfield(L, index, "i") != LUA_TNIL) {
+        id->identifierType = UA_NODEIDTYPE_NUMERIC;
+        id->identifier.numeric = (UA_UInt32)ua_checkinteger_field(L, "i");
+    } else if(lua_pop(L, 1), lua_getfield(L, index, "s") != LUA_TNIL) {
+        id->identifierType = UA_NODEIDTYPE_STRING;
+        ua_string_fromlua(L, -1, &id->identifier.string);
+    } else if(lua_pop(L, 1), lua_getfield(L, index, "g") != LUA_TNIL) {
+        id->identifierType = UA_NODEIDTYPE_GUID;
+        parse_guid(L, -1, &id->identifier.guid);
+    } else if(lua_pop(L, 1), lua_getfield(L, index, "b") != LUA_TNIL) {
+        id->identifierType = UA_NODEIDTYPE_BYTESTRING;
+        ua_string_fromlua(L, -1, &id->identifier.byteString);
+    } else if(lua_pop(L, 1), lua_getfield(L, index, "identifier") != LUA_TNIL) {
+        ua_nodeid_newindex(L, id, "identifier", lua_gettop(L));
+    }
+    lua_pop(L, 1);
+}
+
+/* Builtin types with a fixed set of keys are filled with their newindex */
+static void
+ua_builtin_fromtable(lua_State *L, int index, void *dst, const UA_DataType *type) {
+    const char **keys;
+    size_t keysSize;
+    switch(type->typeIndex) {
+    case UA_TYPES_EXPANDEDNODEID:
+        keys = expandednodeid_keys;
+        keysSize = expandednodeid_keysSize;
+        break;
+    case UA_TYPES_LOCALIZEDTEXT:
+        keys = localizedtext_keys;
+        keysSize = localizedtext_keysSize;
+        break;
+    case UA_TYPES_VARIANT:
+        keys = variant_keys;
+        keysSize = variant_keysSize;
+        break;
+    case UA_TYPES_DATAVALUE:
+        keys = datavalue_keys;
+        keysSize = datavalue_keysSize;
+        break;
+    default:
+        luaL_error(L, "Cannot convert a table to ua.types.%s", type->typeName);
+        return;
+    }
+    UA_deleteMembers(dst, type);
+    UA_init(dst, type);
+    UA_Boolean inlineNodeId = (type->typeIndex == UA_TYPES_EXPANDEDNODEID);
+    int top = lua_gettop(L);
+    for(size_t i = 0; i < keysSize; i++) {
+        if(lua_getfield(L, index, keys[i]) != LUA_TNIL) {
+            int value = lua_gettop(L);
+            switch(type->typeIndex) {
+            case UA_TYPES_EXPANDEDNODEID:
+                if(i == 0) {
+                    ua_fromlua(L, value, dst, &UA_TYPES[UA_TYPES_NODEID]);
+                    inlineNodeId = false;
+                } else
+                    ua_expandednodeid_newindex(L, dst, keys[i], value);
+                break;
+            case UA_TYPES_LOCALIZEDTEXT:
+                ua_localizedtext_newindex(L, dst, keys[i], value);
+                break;
+            case UA_TYPES_VARIANT:
+                ua_variant_newindex(L, dst, keys[i], value);
+                break;
+            default:
+                ua_datavalue_newindex(L, dst, keys[i], value);
+                break;
+            }
+        }
+        lua_settop(L, top);
+    }
+    /* the NodeId fields can be given inline */
+    if(inlineNodeId)
+        ua_nodeid_fromtable(L, index, &((UA_ExpandedNodeId*)dst)->nodeId);
+}
+
+/* Structures from a table with the member names as keys. Missing members
+   keep their initial value. A ReadValueId, WriteValue or BrowseDescription
+   can also be given as the NodeId alone. */
+static void
+ua_structure_fromtable(lua_State *L, int index, void *dst, const UA_DataType *type) {
+    const ua_member *members = ua_members(L, type);
+    if(!members)
+        luaL_error(L, "Cannot convert a table to ua.types.%s", type->typeName);
+    UA_deleteMembers(dst, type);
+    UA_init(dst, type);
+    if(type == &UA_TYPES[UA_TYPES_READVALUEID])
+        ((UA_ReadValueId*)dst)->attributeId = UA_ATTRIBUTEID_VALUE;
+    else if(type == &UA_TYPES[UA_TYPES_WRITEVALUE])
+        ((UA_WriteValue*)dst)->attributeId = UA_ATTRIBUTEID_VALUE;
+    else if(type == &UA_TYPES[UA_TYPES_BROWSEDESCRIPTION])
+        ((UA_BrowseDescription*)dst)->resultMask = UA_BROWSERESULTMASK_ALL;
+    for(size_t i = 0; i < type->membersSize; i++) {
+        const ua_member *m = &members[i];
+        if(lua_getfield(L, index, m->name) != LUA_TNIL) {
+            void *member = (void*)((uintptr_t)dst + m->offset);
+            if(m->isArray)
+                ua_fromlua_array(L, -1, member, m->type);
+            else
+                ua_fromlua(L, -1, member, m->type);
+        }
+        lua_pop(L, 1);
+    }
+}
+
+static UA_Boolean
+ua_nodeid_shorthand(lua_State *L, int index, const UA_DataType *type) {
+    if(type != &UA_TYPES[UA_TYPES_READVALUEID] &&
+       type != &UA_TYPES[UA_TYPES_WRITEVALUE] &&
+       type != &UA_TYPES[UA_TYPES_BROWSEDESCRIPTION])
+        return false;
+    switch(lua_type(L, index)) {
+    case LUA_TNUMBER:
+    case LUA_TSTRING:
+        return true;
+    case LUA_TTABLE: {
+        UA_Boolean shorthand = (lua_getfield(L, index, "nodeId") == LUA_TNIL);
+        lua_pop(L, 1);
+        return shorthand;
+    }
+    default: {
+        ua_data *data = luaL_testudata(L, index, "open62541-data");
+        return data && data->type == &UA_TYPES[UA_TYPES_NODEID];
+    }
+    }
+}
+
+void
+ua_fromlua(lua_State *L, int index, void *dst, const UA_DataType *type) {
+    index = lua_absindex(L, index);
+    int ltype = lua_type(L, index);
+
+    if(ltype == LUA_TNUMBER ||
+       (ltype == LUA_TBOOLEAN && type == &UA_TYPES[UA_TYPES_BOOLEAN])) {
+        switch(type->typeIndex) {
+#define UA_FROMLUA_CASE(INDEX, CTYPE, KIND)                     \
+        case INDEX:                                             \
+            *(CTYPE*)dst = (CTYPE)ua_to##KIND##_at(L, index, 1); \
+            return;
+        UA_NUMERIC_TYPES(UA_FROMLUA_CASE)
+#undef UA_FROMLUA_CASE
+        case UA_TYPES_DATETIME:
+            *(UA_DateTime*)dst = ua_tointeger_at(L, index, 1);
+            return;
+        case UA_TYPES_NODEID: {
+            UA_UInt32 numeric = ua_nodeid_numeric(L, index);
+            UA_NodeId_deleteMembers(dst);
+            *(UA_NodeId*)dst = UA_NODEID_NUMERIC(0, numeric);
+            return;
+        }
+        default:
+            break;
+        }
+    } else if(ltype == LUA_TSTRING) {
+        switch(type->typeIndex) {
+        case UA_TYPES_STRING:
+        case UA_TYPES_BYTESTRING:
+        case UA_TYPES_XMLELEMENT:
+            ua_string_fromlua(L, index, dst);
+            return;
+        case UA_TYPES_GUID:
+            parse_guid(L, index, dst);
+            return;
+        case UA_TYPES_NODEID:
+            ua_nodeid_fromstring(L, index, dst);
+            return;
+        case UA_TYPES_QUALIFIEDNAME:
+            ((UA_QualifiedName*)dst)->namespaceIndex = 0;
+            ua_string_fromlua(L, index, &((UA_QualifiedName*)dst)->name);
+            return;
+        case UA_TYPES_LOCALIZEDTEXT:
+            ua_string_fromlua(L, index, &((UA_LocalizedText*)dst)->text);
+            return;
+        default:
+            break;
+        }
+    } else if(ltype == LUA_TTABLE) {
+        if(type == &UA_TYPES[UA_TYPES_NODEID]) {
+            ua_nodeid_fromtable(L, index, dst);
+            return;
+        }
+        /* sequences become variant arrays */
+        if(type == &UA_TYPES[UA_TYPES_VARIANT] && lua_rawlen(L, index) > 0) {
+            int top = lua_gettop(L);
+            ua_variant_newindex(L, dst, "value", index);
+            lua_settop(L, top);
+            return;
+        }
+        if(!ua_nodeid_shorthand(L, index, type)) {
+            if(type->builtin && type != &UA_TYPES[UA_TYPES_QUALIFIEDNAME])
+                ua_builtin_fromtable(L, index, dst, type);
+            else
+                ua_structure_fromtable(L, index, dst, type);
+            return;
+        }
+    }
+
+    if(ua_nodeid_shorthand(L, index, type)) {
+        UA_deleteMembers(dst, type);
+        UA_init(dst, type);
+        /* the nodeId is the first member in all three types */
+        ua_fromlua(L, index, dst, &UA_TYPES[UA_TYPES_NODEID]);
+        if(type == &UA_TYPES[UA_TYPES_BROWSEDESCRIPTION])
+            ((UA_BrowseDescription*)dst)->resultMask = UA_BROWSERESULTMASK_ALL;
+        else if(type == &UA_TYPES[UA_TYPES_READVALUEID])
+            ((UA_ReadValueId*)dst)->attributeId = UA_ATTRIBUTEID_VALUE;
+        else
+            ((UA_WriteValue*)dst)->attributeId = UA_ATTRIBUTEID_VALUE;
+        return;
+    }
+
+    /* native values inside a variant or datavalue */
+    if(ltype != LUA_TUSERDATA || !luaL_testudata(L, index, "open62541-data") ||
+       ((ua_data*)lua_touserdata(L, index))->type != type) {
+        int top = lua_gettop(L);
+        if(type == &UA_TYPES[UA_TYPES_VARIANT]) {
+            ua_variant_newindex(L, dst, "value", index);
+            lua_settop(L, top);
+            return;
+        }
+        if(type == &UA_TYPES[UA_TYPES_DATAVALUE]) {
+            ua_datavalue_newindex(L, dst, "value", index);
+            lua_settop(L, top);
+            return;
+        }
+    }
+
+    ua_data *data = ua_getdata(L, index, type);
+    if(data->data == dst)
+        return;
+    UA_deleteMembers(dst, type);
+    UA_copy(data->data, dst, type);
+}
+
+void
+ua_fromlua_array(lua_State *L, int index, void *member, const UA_DataType *type) {
+    size_t *length = member;
+    void **data = (void**)((uintptr_t)member + sizeof(size_t));
+    ua_array *array = luaL_testudata(L, index, "open62541-array");
+    if(array) {
+        ua_checkscope(L, array->scope);
+        if(array->type != type)
+            luaL_error(L, "Cannot convert an array of ua.types.%s to ua.types.%s",
+                       array->type->typeName, type->typeName);
+        void *copy;
+        if(UA_Array_copy(*array->data, *array->length, &copy, type) != UA_STATUSCODE_GOOD)
+            luaL_error(L, "Out of memory");
+        UA_Array_delete(*data, *length, type);
+        *data = copy;
+        *length = *array->length;
+        return;
+    }
+    if(!lua_istable(L, index))
+        luaL_error(L, "Cannot convert to an array of ua.types.%s", type->typeName);
+    index = lua_absindex(L, index);
+    size_t n = lua_rawlen(L, index);
+    UA_Array_delete(*data, *length, type);
+    *length = 0;
+    *data = UA_Array_new(n, type);
+    if(!*data)
+        luaL_error(L, "Out of memory");
+    *length = n;
+    /* the elements are initialized. the array is valid when an element fails. */
+    ua_array_readtable(L, index, 1, *data, n, type);
+}
+
 /******************************/
 /* De- and encode from binary */
 /******************************/
@@ -1547,45 +2991,311 @@ int ua_array_pairs(lua_State *L) {
 UA_StatusCode UA_encodeBinary(const void *src, const UA_DataType *type, UA_ByteString *dst, size_t *offset);
 UA_StatusCode UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst, const UA_DataType *type);
 size_t UA_calcSizeBinary(void *p, const UA_DataType *type);
+UA_StatusCode UA_encodeBinaryGrow(const void *src, const UA_DataType *type, UA_ByteString *dst, size_t *offset);
+
+/* The binary functions take ua values, arrays and the Lua values that
+   ua_getdata converts. Arrays are encoded with an Int32 length prefix like
+   array members, unless they are a sequence of values for
+   ua.encodeBinaryMany. */
+typedef struct {
+    const UA_DataType *type;
+    void *data;
+    size_t length;
+    UA_Boolean isArray;
+} ua_binary_value;
 
+/* luaL_error has no hex format */
+static int
+ua_binary_error(lua_State *L, const char *what, const UA_DataType *type,
+                UA_StatusCode retval) {
+    char status[16];
+    snprintf(status, sizeof(status), "0x%08x", retval);
+    return luaL_error(L, "%s ua.types.%s failed with status %s",
+                      what, type->typeName, status);
+}
+
+/* May push the converted value on the stack */
+static void
+ua_binary_getvalue(lua_State *L, int index, ua_binary_value *v) {
+    ua_array *array = luaL_testudata(L, index, "open62541-array");
+    if(array) {
+        ua_getarray(L, index); /* checks the scope */
+        v->type = array->type;
+        v->data = *array->data;
+        v->length = *array->length;
+        v->isArray = true;
+        return;
+    }
+    ua_data *data = ua_getdata(L, index, NULL);
+    v->type = data->type;
+    v->data = data->data;
+    v->length = 1;
+    v->isArray = false;
+}
+
+/* Encodes in a single pass into dst that grows as needed (the length is the
+   capacity) */
+static UA_StatusCode
+ua_binary_encode(const ua_binary_value *v, UA_Boolean prefix,
+                 UA_ByteString *dst, size_t *offset) {
+    if(!v->isArray)
+        return UA_encodeBinaryGrow(v->data, v->type, dst, offset);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(prefix) {
+        UA_Int32 length = -1;
+        if(v->length > 0)
+            length = (UA_Int32)v->length;
+        else if(v->data == UA_EMPTY_ARRAY_SENTINEL)
+            length = 0;
+        retval = UA_encodeBinaryGrow(&length, &UA_TYPES[UA_TYPES_INT32], dst, offset);
+    }
+    uintptr_t ptr = (uintptr_t)v->data;
+    for(size_t i = 0; i < v->length && retval == UA_STATUSCODE_GOOD; i++) {
+        retval = UA_encodeBinaryGrow((void*)ptr, v->type, dst, offset);
+        ptr += v->type->memSize;
+    }
+    return retval;
+}
+
+/* ua.encodeBinary and ua.encodeBinaryMany encode into a scratch buffer of the
+   thread that is kept between the calls, so that repeated large values are
+   encoded in one pass. A buffer that grew beyond LIBUA_SCRATCH_KEEP is
+   released after LIBUA_SCRATCH_IDLE encodings in a row that were small. */
+static LIBUA_THREAD_LOCAL UA_ByteString ua_binary_scratch;
+static LIBUA_THREAD_LOCAL size_t ua_binary_scratch_idle;
+#define LIBUA_SCRATCH_KEEP 65536
+#define LIBUA_SCRATCH_IDLE 64
+
+static void
+ua_binary_pushscratch(lua_State *L, size_t length) {
+    lua_pushlstring(L, (const char*)ua_binary_scratch.data, length);
+    if(ua_binary_scratch.length <= LIBUA_SCRATCH_KEEP)
+        return;
+    if(length > LIBUA_SCRATCH_KEEP) {
+        ua_binary_scratch_idle = 0;
+        return;
+    }
+    if(++ua_binary_scratch_idle < LIBUA_SCRATCH_IDLE)
+        return;
+    ua_free(ua_binary_scratch.data);
+    UA_ByteString_init(&ua_binary_scratch);
+    ua_binary_scratch_idle = 0;
+}
+
+/* ua.encodeBinary(v) returns the binary encoding as a string */
 int ua_encodebinary(lua_State *L) {
-    ua_data *data = ua_getdata(L, 1, NULL);
-    size_t length = UA_calcSizeBinary(data->data, data->type);
-    if(length == 0)
-        return 0;
-    UA_ByteString dst;
-    dst.data = malloc(length);
-    dst.length = length;
+    ua_arena_use(NULL);
+    ua_binary_value v;
+    ua_binary_getvalue(L, 1, &v);
     size_t offset = 0;
-    UA_StatusCode retval = UA_encodeBinary(data->data, data->type, &dst, &offset);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_ByteString_deleteMembers(&dst);
-        return 0;
+    UA_StatusCode retval = ua_binary_encode(&v, true, &ua_binary_scratch, &offset);
+    if(retval != UA_STATUSCODE_GOOD)
+        return ua_binary_error(L, "Encoding", v.type, retval);
+    ua_binary_pushscratch(L, offset);
+    return 1;
+}
+
+/* ua.encodeBinaryMany(values) concatenates the encodings of the values in a
+   Lua sequence or the elements of an array into one string */
+int ua_encodebinary_many(lua_State *L) {
+    ua_arena_use(NULL);
+    int top = lua_gettop(L);
+    ua_binary_value v;
+    size_t offset = 0;
+    if(luaL_testudata(L, 1, "open62541-array")) {
+        ua_binary_getvalue(L, 1, &v);
+        UA_StatusCode retval = ua_binary_encode(&v, false, &ua_binary_scratch, &offset);
+        if(retval != UA_STATUSCODE_GOOD)
+            return ua_binary_error(L, "Encoding", v.type, retval);
+        ua_binary_pushscratch(L, offset);
+        return 1;
+    }
+
+    luaL_checktype(L, 1, LUA_TTABLE);
+    lua_Integer count = luaL_len(L, 1);
+    for(lua_Integer i = 1; i <= count; i++) {
+        lua_rawgeti(L, 1, i);
+        ua_binary_getvalue(L, top + 1, &v);
+        UA_StatusCode retval = ua_binary_encode(&v, true, &ua_binary_scratch, &offset);
+        if(retval != UA_STATUSCODE_GOOD)
+            return ua_binary_error(L, "Encoding", v.type, retval);
+        lua_settop(L, top);
     }
-    lua_pushlstring(L, (char*)dst.data, offset);
-    UA_ByteString_deleteMembers(&dst);
+    ua_binary_pushscratch(L, offset);
     return 1;
 }
 
-/* takes a binary string and try to decode it into the given type */
-int ua_decodebinary(lua_State *L) {
-    ua_data *string = ua_getdata(L, 1, &UA_TYPES[UA_TYPES_BYTESTRING]);
-    lua_getfield(L, LUA_REGISTRYINDEX, "open62541-type");
-    if(!lua_getmetatable(L, 2) || !lua_rawequal(L, -1, -2))
-        return luaL_error(L, "The first argument is not a type");
-    lua_rawgeti(L, 2, 1);
-    const UA_DataType *type = lua_touserdata(L, -1);
+/* Lazy Decoding */
+/*****************/
 
-    ua_data *data = lua_newuserdata(L, sizeof(ua_data));
-    data->data = UA_new(type);
-    data->type = type;
-    luaL_setmetatable(L, "open62541-data");
+/* The setting is shared by all threads */
+static struct {
+    struct spinlock lock;
+    UA_Boolean enabled;
+} ua_lazy;
+
+/* ua.lazyDecoding([on]) keeps the variants and extension objects in client
+   responses and ua.decodeBinary results encoded until they are indexed. The
+   previous setting is returned. */
+int ua_lazydecoding(lua_State *L) {
+    SPIN_LOCK(&ua_lazy);
+    UA_Boolean old = ua_lazy.enabled;
+    if(!lua_isnone(L, 1))
+        ua_lazy.enabled = lua_toboolean(L, 1);
+    SPIN_UNLOCK(&ua_lazy);
+    lua_pushboolean(L, old);
+    return 1;
+}
+
+UA_Boolean ua_lazydecoding_enabled(void) {
+    SPIN_LOCK(&ua_lazy);
+    UA_Boolean enabled = ua_lazy.enabled;
+    SPIN_UNLOCK(&ua_lazy);
+    return enabled;
+}
+
+void ua_variant_decodelazy(lua_State *L, UA_Variant *v, UA_UInt32 scope) {
+    if(v->type != &UA_ENCODEDVARIANT)
+        return;
+    ua_arena *current = ua_arena_current();
+    ua_arena_use(ua_arena_find(scope));
+    UA_StatusCode retval = UA_Variant_decodeLazy(v);
+    ua_arena_use(current);
+    if(retval != UA_STATUSCODE_GOOD)
+        ua_binary_error(L, "Decoding", &UA_TYPES[UA_TYPES_VARIANT], retval);
+}
+
+/* ua.decodeBinary(type, str [, pos]) decodes a value starting at the 1-based
+   position pos of the string and returns the value and the position after
+   it. The older form ua.decodeBinary(str, type) returns only the value or nil
+   if decoding fails. */
+int ua_decodebinary(lua_State *L) {
+    ua_arena_use(ua_arena_innermost());
+    ua_memory_check(L);
+    UA_Boolean legacy = lua_type(L, 1) != LUA_TTABLE;
+    int typeindex = legacy ? 2 : 1;
+    int strindex = legacy ? 1 : 2;
+    const UA_DataType *type = ua_checktype(L, typeindex);
+
+    UA_ByteString src;
+    if(lua_type(L, strindex) == LUA_TSTRING) {
+        src.data = (UA_Byte*)(uintptr_t)lua_tolstring(L, strindex, &src.length);
+    } else {
+        ua_data *string = ua_getdata(L, strindex, &UA_TYPES[UA_TYPES_BYTESTRING]);
+        src = *(UA_ByteString*)string->data;
+    }
 
     size_t offset = 0;
-    UA_StatusCode ret = UA_decodeBinary(string->data, &offset, data->data, type);
+    if(!legacy) {
+        lua_Integer pos = luaL_optinteger(L, 3, 1);
+        luaL_argcheck(L, pos >= 1 && (size_t)pos <= src.length + 1, 3,
+                      "position out of range");
+        offset = (size_t)pos - 1;
+    }
+
+    ua_data *data = ua_newdata(L, type);
+    UA_Boolean lazy = UA_setLazyDecoding(ua_lazydecoding_enabled());
+    UA_StatusCode ret = UA_decodeBinary(&src, &offset, data->data, type);
+    UA_setLazyDecoding(lazy);
     if(ret != UA_STATUSCODE_GOOD) {
-        printf("statuscode 0x%08x\n", ret);
-        return 0;
+        if(legacy)
+            return 0;
+        return ua_binary_error(L, "Decoding", type, ret);
     }
+    if(legacy)
+        return 1;
+    lua_pushinteger(L, (lua_Integer)offset + 1);
+    return 2;
+}
+
+/* Encoder */
+/***********/
+
+/* ua.Encoder([size]) keeps a scratch buffer across calls. Records are
+   appended with write and taken out with result. The buffer grows while
+   encoding and is reused for the next records. */
+typedef struct {
+    UA_ByteString buf; /* the length is the capacity */
+    size_t offset; /* bytes written */
+} ua_encoder;
+
+static ua_encoder *
+ua_checkencoder(lua_State *L, int index) {
+    return luaL_checkudata(L, index, "open62541-encoder");
+}
+
+int ua_encoder_new(lua_State *L) {
+    ua_arena_use(NULL);
+    lua_Integer size = luaL_optinteger(L, 1, 0);
+    luaL_argcheck(L, size >= 0, 1, "negative size");
+    ua_encoder *e = lua_newuserdata(L, sizeof(ua_encoder));
+    UA_ByteString_init(&e->buf);
+    e->offset = 0;
+    luaL_setmetatable(L, "open62541-encoder");
+    if(size > 0) {
+        e->buf.data = ua_malloc((size_t)size);
+        if(!e->buf.data)
+            return luaL_error(L, "Out of memory");
+        e->buf.length = (size_t)size;
+        ua_memory_check(L);
+    }
+    return 1;
+}
+
+int ua_encoder_gc(lua_State *L) {
+    ua_encoder *e = ua_checkencoder(L, 1);
+    ua_arena_use(NULL);
+    ua_free(e->buf.data);
+    UA_ByteString_init(&e->buf);
+    e->offset = 0;
+    return 0;
+}
+
+int ua_encoder_len(lua_State *L) {
+    ua_encoder *e = ua_checkencoder(L, 1);
+    lua_pushinteger(L, (lua_Integer)e->offset);
     return 1;
 }
+
+/* enc:write(v, ...) appends the encoding of the values and returns enc */
+int ua_encoder_write(lua_State *L) {
+    ua_encoder *e = ua_checkencoder(L, 1);
+    ua_arena_use(NULL);
+    int top = lua_gettop(L);
+    for(int i = 2; i <= top; i++) {
+        ua_binary_value v;
+        ua_binary_getvalue(L, i, &v);
+        size_t start = e->offset;
+        UA_StatusCode retval = ua_binary_encode(&v, true, &e->buf, &e->offset);
+        if(retval != UA_STATUSCODE_GOOD) {
+            e->offset = start;
+            return ua_binary_error(L, "Encoding", v.type, retval);
+        }
+        ua_memory_check(L);
+        lua_settop(L, top);
+    }
+    lua_settop(L, 1);
+    return 1;
+}
+
+/* enc:result() returns the written bytes and empties the encoder */
+int ua_encoder_result(lua_State *L) {
+    ua_encoder *e = ua_checkencoder(L, 1);
+    lua_pushlstring(L, (const char*)e->buf.data, e->offset);
+    e->offset = 0;
+    return 1;
+}
+
+int ua_encoder_reset(lua_State *L) {
+    ua_encoder *e = ua_checkencoder(L, 1);
+    e->offset = 0;
+    return 0;
+}
+
+/* enc:encode(v, ...) is enc:reset():write(v, ...):result() */
+int ua_encoder_encode(lua_State *L) {
+    ua_encoder *e = ua_checkencoder(L, 1);
+    e->offset = 0;
+    ua_encoder_write(L);
+    return ua_encoder_result(L);
+}
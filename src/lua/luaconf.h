@@ -782,7 +782,18 @@
 ** without modifying the main part of the file.
 */
 
-
+/*
+@@ lua_lock/lua_unlock guard the Lua core with a global mutex in the
+** uascript interpreter. The ua server then calls into Lua from its
+** background thread while the main script runs.
+*/
+#if defined(UASCRIPT_GLOBAL_LOCK)
+struct lua_State;
+LUAI_FUNC void uascript_lock (struct lua_State *L);
+LUAI_FUNC void uascript_unlock (struct lua_State *L);
+#define lua_lock(L)	uascript_lock(L)
+#define lua_unlock(L)	uascript_unlock(L)
+#endif
 
 
 
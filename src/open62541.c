@@ -787,18 +787,24 @@ int __secs_to_tm(long long t, struct tm *tm);
 # include <malloc.h>
 #endif
 
-#ifndef UA_free
-# define UA_free(ptr) free(ptr)
-#endif
-#ifndef UA_malloc
-# define UA_malloc(size) malloc(size)
-#endif
-#ifndef UA_calloc
-# define UA_calloc(num, size) calloc(num, size)
-#endif
-#ifndef UA_realloc
-# define UA_realloc(ptr, size) realloc(ptr, size)
-#endif
+/* All allocations go through the allocator of the Lua binding
+   (libua_alloc.c). It implements the scope arenas and the optional slabs. */
+void * ua_malloc(size_t size);
+void * ua_calloc(size_t num, size_t size);
+void * ua_realloc(void *ptr, size_t size);
+void ua_free(void *ptr);
+#define UA_free(ptr) ua_free(ptr)
+#define UA_malloc(size) ua_malloc(size)
+#define UA_calloc(num, size) ua_calloc(num, size)
+#define UA_realloc(ptr, size) ua_realloc(ptr, size)
+
+/* Decoded messages that are used only once are allocated from an arena and
+   released at once */
+typedef struct ua_arena ua_arena;
+ua_arena * ua_arena_current(void);
+void ua_arena_use(ua_arena *arena);
+ua_arena * ua_arena_push_message(void);
+void ua_arena_pop(ua_arena *arena);
 
 #ifndef NO_ALLOCA
 # ifdef __GNUC__
@@ -818,16 +824,15 @@ int __secs_to_tm(long long t, struct tm *tm);
 /* Thread Local Storage */
 /************************/
 
-#ifdef UA_ENABLE_MULTITHREADING
-# ifdef __GNUC__
-#  define UA_THREAD_LOCAL __thread
-# elif defined(_MSC_VER)
-#  define UA_THREAD_LOCAL __declspec(thread)
-# else
-#  error No thread local storage keyword defined for this compiler
-# endif
+/* The codec passes state (the current type, the lazy mode) in thread-local
+ * variables. They are needed also without UA_ENABLE_MULTITHREADING, as a
+ * background server encodes and decodes while the script does the same. */
+#ifdef __GNUC__
+# define UA_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+# define UA_THREAD_LOCAL __declspec(thread)
 #else
-# define UA_THREAD_LOCAL
+# error No thread local storage keyword defined for this compiler
 #endif
 
 /********************/
@@ -902,6 +907,11 @@ UA_StatusCode UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *ds
 
 size_t UA_calcSizeBinary(void *p, const UA_DataType *type);
 
+/* Encodes into a buffer that is grown with UA_realloc when it is too small.
+   dst->length is the capacity and the encoding ends at *offset. */
+UA_StatusCode UA_encodeBinaryGrow(const void *src, const UA_DataType *type, UA_ByteString *dst,
+                                  size_t *offset) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 
 /*********************************** amalgamated original file "/home/jpfr/software/open62541/build/src_generated/ua_types_generated_encoding_binary.h" ***********************************/
 
@@ -2346,6 +2356,15 @@ struct UA_Server {
     /* Jobs with a repetition interval */
     LIST_HEAD(RepeatedJobsList, RepeatedJobs) repeatedJobs;
     
+#ifdef UA_ENABLE_METHODCALLS
+    /* Call requests with methods that complete asynchronously */
+    LIST_HEAD(AsyncCallsList, UA_AsyncCall) asyncCalls;
+    UA_UInt32 lastAsyncCallId;
+    struct UA_AsyncCall *deferredCall; /* of the request in Service_Call */
+    UA_CallResponse *callResponse; /* set while Service_Call runs */
+    size_t callIndex;
+#endif
+
 #ifdef UA_ENABLE_MULTITHREADING
     /* Dispatch queue head for the worker threads (the tail should not be in the same cache line) */
 	struct cds_wfcq_head dispatchQueue_head;
@@ -2380,6 +2399,16 @@ UA_StatusCode UA_Server_delayedCallback(UA_Server *server, UA_ServerCallback cal
 UA_StatusCode UA_Server_delayedFree(UA_Server *server, void *data);
 void UA_Server_deleteAllRepeatedJobs(UA_Server *server);
 
+#ifdef UA_ENABLE_METHODCALLS
+/* Keeps a Call request with deferred methods. Returns false if the request is
+   answered right away. */
+UA_Boolean UA_Server_parkAsyncCall(UA_Server *server, UA_UInt32 requestId,
+                                   UA_CallRequest *request, UA_CallResponse *response);
+/* Answers the parked requests whose timeout has passed */
+void UA_Server_processAsyncCalls(UA_Server *server, UA_DateTime now);
+void UA_Server_deleteAllAsyncCalls(UA_Server *server);
+#endif
+
 
 /*********************************** amalgamated original file "/home/jpfr/software/open62541/src/server/ua_services.h" ***********************************/
 
@@ -3585,7 +3614,13 @@ static const UA_copySignature copyJumpTable[UA_BUILTIN_TYPES_COUNT + 1] = {
     (UA_copySignature)copyNoInit // all others
 };
 
+/* Types with fixedSize contain no pointers (also in their members). They are
+   copied with a single memcpy and need no deleteMembers. */
 static UA_StatusCode copyNoInit(const void *src, void *dst, const UA_DataType *type) {
+    if(type->fixedSize) {
+        memcpy(dst, src, type->memSize);
+        return UA_STATUSCODE_GOOD;
+    }
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     uintptr_t ptrs = (uintptr_t)src;
     uintptr_t ptrd = (uintptr_t)dst;
@@ -3597,8 +3632,12 @@ static UA_StatusCode copyNoInit(const void *src, void *dst, const UA_DataType *t
         if(!member->isArray) {
             ptrs += member->padding;
             ptrd += member->padding;
-            size_t fi = memberType->builtin ? memberType->typeIndex : UA_BUILTIN_TYPES_COUNT;
-            retval |= copyJumpTable[fi]((const void*)ptrs, (void*)ptrd, memberType);
+            if(memberType->fixedSize) {
+                memcpy((void*)ptrd, (const void*)ptrs, memberType->memSize);
+            } else {
+                size_t fi = memberType->builtin ? memberType->typeIndex : UA_BUILTIN_TYPES_COUNT;
+                retval |= copyJumpTable[fi]((const void*)ptrs, (void*)ptrd, memberType);
+            }
             ptrs += memberType->memSize;
             ptrd += memberType->memSize;
         } else {
@@ -3622,7 +3661,8 @@ static UA_StatusCode copyNoInit(const void *src, void *dst, const UA_DataType *t
 }
 
 UA_StatusCode UA_copy(const void *src, void *dst, const UA_DataType *type) {
-    memset(dst, 0, type->memSize);
+    if(!type->fixedSize)
+        memset(dst, 0, type->memSize);
     return copyNoInit(src, dst, type);
 }
 
@@ -3659,6 +3699,8 @@ static const UA_deleteMembersSignature deleteMembersJumpTable[UA_BUILTIN_TYPES_C
 };
 
 void UA_deleteMembers(void *p, const UA_DataType *type) {
+    if(type->fixedSize)
+        return;
     uintptr_t ptr = (uintptr_t)p;
     UA_Byte membersSize = type->membersSize;
     for(size_t i = 0; i < membersSize; i++) {
@@ -3667,8 +3709,10 @@ void UA_deleteMembers(void *p, const UA_DataType *type) {
         const UA_DataType *memberType = &typelists[!member->namespaceZero][member->memberTypeIndex];
         if(!member->isArray) {
             ptr += member->padding;
-            size_t fi = memberType->builtin ? memberType->typeIndex : UA_BUILTIN_TYPES_COUNT;
-            deleteMembersJumpTable[fi]((void*)ptr, memberType);
+            if(!memberType->fixedSize) {
+                size_t fi = memberType->builtin ? memberType->typeIndex : UA_BUILTIN_TYPES_COUNT;
+                deleteMembersJumpTable[fi]((void*)ptr, memberType);
+            }
             ptr += memberType->memSize;
         } else {
             ptr += member->padding;
@@ -3712,21 +3756,24 @@ UA_Array_copy(const void *src, size_t src_size, void **dst, const UA_DataType *t
     if(src_size > MAX_ARRAY_SIZE || type->memSize * src_size > MAX_ARRAY_SIZE)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    /* calloc, so we don't have to check retval in every iteration of copying */
-    *dst = UA_calloc(src_size, type->memSize);
-    if(!*dst)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-
     if(type->fixedSize) {
+        *dst = UA_malloc(type->memSize * src_size);
+        if(!*dst)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
         memcpy(*dst, src, type->memSize * src_size);
         return UA_STATUSCODE_GOOD;
     }
 
+    /* calloc, so we don't have to check retval in every iteration of copying */
+    *dst = UA_calloc(src_size, type->memSize);
+    if(!*dst)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
     uintptr_t ptrs = (uintptr_t)src;
     uintptr_t ptrd = (uintptr_t)*dst;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     for(size_t i = 0; i < src_size; i++) {
-        retval |= UA_copy((void*)ptrs, (void*)ptrd, type);
+        retval |= copyNoInit((void*)ptrs, (void*)ptrd, type);
         ptrs += type->memSize;
         ptrd += type->memSize;
     }
@@ -4014,6 +4061,80 @@ Double_encodeBinary(UA_Double const *src, bufpos pos, bufend end) {
 /* Array Handling */
 /******************/
 
+/* Arrays of pointer-free builtins (zeroCopyable) are de- and encoded in bulk
+   with a single bounds check. On little-endian architectures, the wire format
+   is the memory layout. Otherwise, the bytes of every element are swapped in
+   a loop that the compiler can vectorize. */
+#if !defined(UA_NON_LITTLEENDIAN_ARCHITECTURE) && defined(__BYTE_ORDER__) && \
+    defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+# define UA_NON_LITTLEENDIAN_ARCHITECTURE
+#endif
+
+static UA_Boolean
+Array_isBulk(const UA_DataType *contenttype) {
+    if(!contenttype->zeroCopyable)
+        return UA_FALSE;
+#ifdef UA_MIXED_ENDIAN
+    if(contenttype == &UA_TYPES[UA_TYPES_FLOAT] || contenttype == &UA_TYPES[UA_TYPES_DOUBLE])
+        return UA_FALSE;
+#endif
+#ifdef UA_NON_LITTLEENDIAN_ARCHITECTURE
+    /* structures would need to be swapped per member */
+    if(!contenttype->builtin)
+        return UA_FALSE;
+#endif
+    return UA_TRUE;
+}
+
+static void
+Array_copyBulk(UA_Byte *UA_RESTRICT dst, const UA_Byte *UA_RESTRICT src,
+               size_t length, size_t memSize) {
+#ifndef UA_NON_LITTLEENDIAN_ARCHITECTURE
+    memcpy(dst, src, memSize * length);
+#else
+    switch(memSize) {
+    case 2:
+        for(size_t i = 0; i < length; i++) {
+            dst[2*i] = src[2*i+1];
+            dst[2*i+1] = src[2*i];
+        }
+        break;
+    case 4:
+        for(size_t i = 0; i < length; i++) {
+            UA_UInt32 v;
+            memcpy(&v, &src[4*i], 4);
+            v = (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+            memcpy(&dst[4*i], &v, 4);
+        }
+        break;
+    case 8:
+        for(size_t i = 0; i < length; i++) {
+            UA_UInt64 v;
+            memcpy(&v, &src[8*i], 8);
+            v = ((v & 0x00000000000000ffULL) << 56) | ((v & 0x000000000000ff00ULL) << 40) |
+                ((v & 0x0000000000ff0000ULL) << 24) | ((v & 0x00000000ff000000ULL) << 8) |
+                ((v & 0x000000ff00000000ULL) >> 8) | ((v & 0x0000ff0000000000ULL) >> 24) |
+                ((v & 0x00ff000000000000ULL) >> 40) | ((v & 0xff00000000000000ULL) >> 56);
+            memcpy(&dst[8*i], &v, 8);
+        }
+        break;
+    default:
+        memcpy(dst, src, memSize * length);
+    }
+#endif
+}
+
+static UA_StatusCode
+Array_encodeBulk(const void *src, size_t length, const UA_DataType *contenttype,
+                 bufpos pos, bufend end) {
+    size_t size = contenttype->memSize * length;
+    if(*pos + size > end)
+        return UA_STATUSCODE_BADENCODINGERROR;
+    Array_copyBulk(*pos, src, length, contenttype->memSize);
+    (*pos) += size;
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 Array_encodeBinary(const void *src, size_t length, const UA_DataType *contenttype, bufpos pos, bufend end) {
     UA_Int32 signed_length = -1;
@@ -4027,15 +4148,8 @@ Array_encodeBinary(const void *src, size_t length, const UA_DataType *contenttyp
     if(retval != UA_STATUSCODE_GOOD || length == 0)
         return retval;
 
-#ifndef UA_NON_LITTLEENDIAN_ARCHITECTURE
-    if(contenttype->zeroCopyable) {
-        if(end < *pos + (contenttype->memSize * length))
-            return UA_STATUSCODE_BADENCODINGERROR;
-        memcpy(*pos, src, contenttype->memSize * length);
-        (*pos) += contenttype->memSize * length;
-        return retval;
-    }
-#endif
+    if(Array_isBulk(contenttype))
+        return Array_encodeBulk(src, length, contenttype, pos, end);
 
     uintptr_t ptr = (uintptr_t)src;
     size_t encode_index = contenttype->builtin ? contenttype->typeIndex : UA_BUILTIN_TYPES_COUNT;
@@ -4067,20 +4181,23 @@ Array_decodeBinary(bufpos pos, bufend end, UA_Int32 signed_length, void *UA_REST
     if(*pos + ((contenttype->memSize * length) / 32) > end)
         return UA_STATUSCODE_BADDECODINGERROR;
 
-    *dst = UA_calloc(1, contenttype->memSize * length);
-    if(!*dst)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-
-#ifndef UA_NON_LITTLEENDIAN_ARCHITECTURE
-    if(contenttype->zeroCopyable) {
-        if(end < *pos + (contenttype->memSize * length))
+    if(Array_isBulk(contenttype)) {
+        /* every byte is overwritten, no need to zero the memory */
+        size_t size = contenttype->memSize * length;
+        if(*pos + size > end)
             return UA_STATUSCODE_BADDECODINGERROR;
-        memcpy(*dst, *pos, contenttype->memSize * length);
-        (*pos) += contenttype->memSize * length;
+        *dst = UA_malloc(size);
+        if(!*dst)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        Array_copyBulk(*dst, *pos, length, contenttype->memSize);
+        (*pos) += size;
         *out_length = length;
         return UA_STATUSCODE_GOOD;
     }
-#endif
+
+    *dst = UA_calloc(1, contenttype->memSize * length);
+    if(!*dst)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
 
     uintptr_t ptr = (uintptr_t)*dst;
     size_t decode_index = contenttype->builtin ? contenttype->typeIndex : UA_BUILTIN_TYPES_COUNT;
@@ -4358,6 +4475,299 @@ LocalizedText_decodeBinary(bufpos pos, bufend end, UA_LocalizedText *dst) {
     return retval;
 }
 
+/* Lazy Decoding */
+/* In lazy mode, variants and the bodies of extension objects are kept
+   encoded. They are decoded later with UA_Variant_decodeLazy and
+   UA_ExtensionObject_decodeLazy. */
+static UA_THREAD_LOCAL UA_Boolean lazyDecoding = UA_FALSE;
+
+UA_Boolean UA_setLazyDecoding(UA_Boolean lazy) {
+    UA_Boolean old = lazyDecoding;
+    lazyDecoding = lazy;
+    return old;
+}
+
+/* The data of a variant that is kept encoded is a UA_ByteString with the
+   complete encoding of the variant (starting with the encoding byte) */
+const UA_DataType UA_ENCODEDVARIANT = {.typeName = "EncodedVariant", .typeId = {.namespaceIndex = 0, .identifierType = UA_NODEIDTYPE_NUMERIC, .identifier.numeric = 0}, .memSize = sizeof(UA_ByteString), .builtin = UA_FALSE, .fixedSize = UA_FALSE, .zeroCopyable = UA_FALSE, .typeIndex = UA_TYPES_COUNT, .membersSize = 1,
+	.members=(UA_DataTypeMember[]){
+	{.memberName = "encoding", .memberTypeIndex = UA_TYPES_BYTESTRING, .namespaceZero = UA_TRUE, .padding = 0, .isArray = UA_FALSE }, }};
+
+/* Codec Programs */
+/* The members of structures are flattened once into a list of operations with
+ * absolute offsets. Nested structures are inlined and neighbouring members
+ * whose memory layout is the wire format are merged into one copy. The binary
+ * codec runs the program instead of interpreting the member descriptions. */
+enum {
+    CODEC_END,
+    CODEC_COPY, /* length bytes at offset */
+    CODEC_CALL, /* the jump table entry for the type at offset */
+    CODEC_ARRAY /* array of the type with the length field at offset */
+};
+
+typedef struct {
+    UA_Byte op;
+    UA_Byte index;    /* jump table index of CODEC_CALL */
+    UA_UInt16 length; /* bytes of CODEC_COPY */
+    UA_UInt32 offset;
+    const UA_DataType *type;
+} CodecOp;
+
+/* QualifiedName is builtin, but en- and decoded from its members */
+static UA_Boolean
+isFlattened(const UA_DataType *t) {
+    return !t->builtin || t == &UA_TYPES[UA_TYPES_QUALIFIEDNAME];
+}
+
+static size_t
+countCodecOps(const UA_DataType *t) {
+    const UA_DataType *typelists[2] = { UA_TYPES, &t[-t->typeIndex] };
+    size_t count = 0;
+    for(size_t i = 0; i < t->membersSize; i++) {
+        const UA_DataTypeMember *member = &t->members[i];
+        const UA_DataType *mt = &typelists[!member->namespaceZero][member->memberTypeIndex];
+        if(!member->isArray && isFlattened(mt))
+            count += countCodecOps(mt);
+        else
+            count++;
+    }
+    return count;
+}
+
+static CodecOp *
+compileCodecOps(const UA_DataType *t, size_t offset, const CodecOp *start, CodecOp *op) {
+    const UA_DataType *typelists[2] = { UA_TYPES, &t[-t->typeIndex] };
+    for(size_t i = 0; i < t->membersSize; i++) {
+        const UA_DataTypeMember *member = &t->members[i];
+        const UA_DataType *mt = &typelists[!member->namespaceZero][member->memberTypeIndex];
+        offset += member->padding;
+        if(member->isArray) {
+            op->op = CODEC_ARRAY;
+            op->offset = (UA_UInt32)offset;
+            op->type = mt;
+            op++;
+            offset += sizeof(size_t) + sizeof(void*);
+            continue;
+        }
+        if(isFlattened(mt)) {
+            op = compileCodecOps(mt, offset, start, op);
+#ifndef UA_NON_LITTLEENDIAN_ARCHITECTURE
+        } else if(Array_isBulk(mt)) {
+            if(op > start && op[-1].op == CODEC_COPY && op[-1].offset + op[-1].length == offset &&
+               op[-1].length + mt->memSize <= UA_UINT16_MAX) {
+                op[-1].length = (UA_UInt16)(op[-1].length + mt->memSize);
+            } else {
+                op->op = CODEC_COPY;
+                op->offset = (UA_UInt32)offset;
+                op->length = mt->memSize;
+                op++;
+            }
+#endif
+        } else {
+            op->op = CODEC_CALL;
+            op->index = (UA_Byte)mt->typeIndex;
+            op->offset = (UA_UInt32)offset;
+            op->type = mt;
+            op++;
+        }
+        offset += mt->memSize;
+    }
+    return op;
+}
+
+/* Returns NULL for builtin types or if out of memory. The interpreter is used
+ * then. */
+static CodecOp *
+compileCodecProgram(const UA_DataType *t) {
+    if(!isFlattened(t))
+        return NULL;
+    CodecOp *program = calloc(countCodecOps(t) + 1, sizeof(CodecOp));
+    if(!program)
+        return NULL;
+    CodecOp *end = compileCodecOps(t, 0, program, program);
+    end->op = CODEC_END;
+    return program;
+}
+
+/* Data Type Registry */
+/* The types of extension object bodies are found by the NodeId of their binary
+ * encoding. The ns0 types are indexed by UA_initDataTypeRegistry when the
+ * module is loaded; the lazy initialization on first use is only a fallback
+ * for programs that skip it. Types registered at runtime are also indexed by
+ * their address to find the encoding id when they are encoded. Every entry
+ * holds the compiled codec program of the type. Both indexes use open
+ * addressing with linear probing and hold the position in the entry list plus
+ * one (zero is empty).
+ * The registry is not synchronized. Types are registered before values are
+ * exchanged between threads. The memory is not taken from UA_malloc, so that
+ * registrations inside an arena scope persist. */
+typedef struct {
+    UA_NodeId encodingId;
+    const UA_DataType *type;
+    const CodecOp *program;
+} TypeEntry;
+
+static TypeEntry *typeEntries;
+static size_t typeEntriesSize;
+static size_t typeEntriesCount;
+static UA_UInt32 *typesByEncoding;
+static UA_UInt32 *typesByAddress;
+static size_t typeIndexSize; /* power of two */
+
+static hash_t
+hashAddress(const UA_DataType *t) {
+    return (hash_t)(((uintptr_t)t >> 3) * 2654435761u);
+}
+
+static UA_UInt32 *
+findEncodingSlot(const UA_NodeId *encodingId) {
+    size_t mask = typeIndexSize - 1;
+    for(size_t i = hash(encodingId) & mask;; i = (i + 1) & mask) {
+        UA_UInt32 e = typesByEncoding[i];
+        if(e == 0 || UA_NodeId_equal(&typeEntries[e-1].encodingId, encodingId))
+            return &typesByEncoding[i];
+    }
+}
+
+static UA_UInt32 *
+findAddressSlot(const UA_DataType *t) {
+    size_t mask = typeIndexSize - 1;
+    for(size_t i = hashAddress(t) & mask;; i = (i + 1) & mask) {
+        UA_UInt32 e = typesByAddress[i];
+        if(e == 0 || typeEntries[e-1].type == t)
+            return &typesByAddress[i];
+    }
+}
+
+/* Keep the load of the indexes below one half */
+static UA_StatusCode
+growTypeIndexes(void) {
+    size_t size = typeIndexSize ? typeIndexSize * 2 : 512;
+    UA_UInt32 *byEncoding = calloc(size, sizeof(UA_UInt32));
+    UA_UInt32 *byAddress = calloc(size, sizeof(UA_UInt32));
+    if(!byEncoding || !byAddress) {
+        free(byEncoding);
+        free(byAddress);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    free(typesByEncoding);
+    free(typesByAddress);
+    typesByEncoding = byEncoding;
+    typesByAddress = byAddress;
+    typeIndexSize = size;
+    /* later registrations of the same id or type replace earlier ones */
+    for(size_t i = 0; i < typeEntriesCount; i++) {
+        *findEncodingSlot(&typeEntries[i].encodingId) = (UA_UInt32)(i + 1);
+        *findAddressSlot(typeEntries[i].type) = (UA_UInt32)(i + 1);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+addTypeEntry(const UA_DataType *t, const UA_NodeId *encodingId) {
+    if(typeEntriesCount == typeEntriesSize) {
+        size_t size = typeEntriesSize ? typeEntriesSize * 2 : 256;
+        TypeEntry *entries = realloc(typeEntries, size * sizeof(TypeEntry));
+        if(!entries)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        typeEntries = entries;
+        typeEntriesSize = size;
+    }
+    if((typeEntriesCount + 1) * 2 > typeIndexSize) {
+        UA_StatusCode retval = growTypeIndexes();
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+    size_t i = typeEntriesCount++;
+    typeEntries[i].encodingId = *encodingId;
+    typeEntries[i].type = t;
+    typeEntries[i].program = compileCodecProgram(t);
+    *findEncodingSlot(encodingId) = (UA_UInt32)(i + 1);
+    *findAddressSlot(t) = (UA_UInt32)(i + 1);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_initDataTypeRegistry(void) {
+    if(typeIndexSize > 0)
+        return UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        UA_NodeId encodingId = UA_TYPES[i].typeId;
+        encodingId.identifier.numeric += UA_ENCODINGOFFSET_BINARY;
+        UA_StatusCode retval = addTypeEntry(&UA_TYPES[i], &encodingId);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_registerDataType(const UA_DataType *t, const UA_NodeId *binaryEncodingId) {
+    UA_StatusCode retval = UA_initDataTypeRegistry();
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    /* The entry keeps its own copy of the encoding id. Ids in the entry list
+     * are never released, as the list only grows. */
+    UA_NodeId encodingId = *binaryEncodingId;
+    UA_Byte *copy = NULL;
+    if(encodingId.identifierType == UA_NODEIDTYPE_STRING ||
+       encodingId.identifierType == UA_NODEIDTYPE_BYTESTRING) {
+        const UA_ByteString *s = &binaryEncodingId->identifier.byteString;
+        if(s->length > 0) {
+            copy = malloc(s->length);
+            if(!copy)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            memcpy(copy, s->data, s->length);
+        }
+        encodingId.identifier.byteString.data = copy;
+    }
+    retval = addTypeEntry(t, &encodingId);
+    if(retval != UA_STATUSCODE_GOOD)
+        free(copy);
+    return retval;
+}
+
+const UA_DataType *
+UA_findDataTypeByBinaryEncoding(const UA_NodeId *binaryEncodingId) {
+    if(UA_initDataTypeRegistry() != UA_STATUSCODE_GOOD)
+        return NULL;
+    UA_UInt32 e = *findEncodingSlot(binaryEncodingId);
+    return e ? typeEntries[e-1].type : NULL;
+}
+
+/* The ns0 types are the first entries */
+static const CodecOp *
+findCodecProgram(const UA_DataType *t) {
+    if(typeIndexSize == 0)
+        return NULL;
+    if(t >= UA_TYPES && t < &UA_TYPES[UA_TYPES_COUNT])
+        return typeEntries[t - UA_TYPES].program;
+    UA_UInt32 e = *findAddressSlot(t);
+    return e ? typeEntries[e-1].program : NULL;
+}
+
+/* The returned id is a shallow copy from the registry */
+static UA_StatusCode
+getBinaryEncodingId(const UA_DataType *t, UA_NodeId *encodingId) {
+    if(t >= UA_TYPES && t < &UA_TYPES[UA_TYPES_COUNT]) {
+        *encodingId = t->typeId;
+        encodingId->identifier.numeric += UA_ENCODINGOFFSET_BINARY;
+        return UA_STATUSCODE_GOOD;
+    }
+    if(typeIndexSize > 0) {
+        UA_UInt32 e = *findAddressSlot(t);
+        if(e) {
+            *encodingId = typeEntries[e-1].encodingId;
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+    if(t->typeId.identifierType != UA_NODEIDTYPE_NUMERIC)
+        return UA_STATUSCODE_BADENCODINGERROR;
+    *encodingId = t->typeId;
+    encodingId->identifier.numeric += UA_ENCODINGOFFSET_BINARY;
+    return UA_STATUSCODE_GOOD;
+}
+
 /* ExtensionObject */
 static UA_StatusCode
 ExtensionObject_encodeBinary(UA_ExtensionObject const *src, bufpos pos, bufend end) {
@@ -4366,10 +4776,9 @@ ExtensionObject_encodeBinary(UA_ExtensionObject const *src, bufpos pos, bufend e
     if(encoding > UA_EXTENSIONOBJECT_ENCODED_XML) {
         if(!src->content.decoded.type || !src->content.decoded.data)
             return UA_STATUSCODE_BADENCODINGERROR;
-        UA_NodeId typeId = src->content.decoded.type->typeId;
-        if(typeId.identifierType != UA_NODEIDTYPE_NUMERIC)
+        UA_NodeId typeId;
+        if(getBinaryEncodingId(src->content.decoded.type, &typeId) != UA_STATUSCODE_GOOD)
             return UA_STATUSCODE_BADENCODINGERROR;
-        typeId.identifier.numeric += UA_ENCODINGOFFSET_BINARY;
         encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
         retval = NodeId_encodeBinary(&typeId, pos, end);
         retval |= Byte_encodeBinary(&encoding, pos, end);
@@ -4397,16 +4806,6 @@ ExtensionObject_encodeBinary(UA_ExtensionObject const *src, bufpos pos, bufend e
     return retval;
 }
 
-static UA_StatusCode findDataType(const UA_NodeId *typeId, const UA_DataType **findtype) {
-    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
-        if(UA_NodeId_equal(typeId, &UA_TYPES[i].typeId)) {
-            *findtype = &UA_TYPES[i];
-            return UA_STATUSCODE_GOOD;
-        }
-    }
-    return UA_STATUSCODE_BADNODEIDUNKNOWN;
-}
-
 static UA_StatusCode
 ExtensionObject_decodeBinary(bufpos pos, bufend end, UA_ExtensionObject *dst) {
     UA_Byte encoding = 0;
@@ -4414,8 +4813,6 @@ ExtensionObject_decodeBinary(bufpos pos, bufend end, UA_ExtensionObject *dst) {
     UA_NodeId_init(&typeId);
     UA_StatusCode retval = NodeId_decodeBinary(pos, end, &typeId);
     retval |= Byte_decodeBinary(pos, end, &encoding);
-    if(typeId.namespaceIndex != 0 || typeId.identifierType != UA_NODEIDTYPE_NUMERIC)
-        retval = UA_STATUSCODE_BADDECODINGERROR;
     if(retval != UA_STATUSCODE_GOOD) {
         UA_NodeId_deleteMembers(&typeId);
         return retval;
@@ -4432,9 +4829,10 @@ ExtensionObject_decodeBinary(bufpos pos, bufend end, UA_ExtensionObject *dst) {
     } else {
         /* try to decode the content */
         type = NULL;
-        typeId.identifier.numeric -= UA_ENCODINGOFFSET_BINARY;
-        findDataType(&typeId, &type);
+        if(!lazyDecoding)
+            type = UA_findDataTypeByBinaryEncoding(&typeId);
         if(type) {
+            UA_NodeId_deleteMembers(&typeId);
             /* UA_Int32 length = 0; */
             /* retval |= Int32_decodeBinary(pos, end, &length); */
             /* if(retval != UA_STATUSCODE_GOOD) */
@@ -4449,6 +4847,7 @@ ExtensionObject_decodeBinary(bufpos pos, bufend end, UA_ExtensionObject *dst) {
             } else
                 retval = UA_STATUSCODE_BADOUTOFMEMORY;
         } else {
+            /* keep the encoding id, so that the body is encoded again as is */
             retval = ByteString_decodeBinary(pos, end, &dst->content.encoded.body);
             dst->encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
             dst->content.encoded.typeId = typeId;
@@ -4468,8 +4867,166 @@ enum UA_VARIANT_ENCODINGMASKTYPE {
     UA_VARIANT_ENCODINGMASKTYPE_ARRAY       = (0x01 << 7)  // bit 7
 };
 
+/* The lazy decoding moves over the encoded value without decoding it to find
+   its end. 0 for the builtin types without a fixed encoding size. */
+static const UA_Byte fixedBinarySize[UA_BUILTIN_TYPES_COUNT] = {
+    1, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8, /* Boolean to Double */
+    0, 8, 16, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0 };
+
+static UA_StatusCode skipBinary(bufpos pos, bufend end, size_t typeIndex);
+
+static UA_StatusCode
+skipBytes(bufpos pos, bufend end, size_t length) {
+    if((size_t)(end - *pos) < length)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    (*pos) += length;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+skipString(bufpos pos, bufend end) {
+    UA_Int32 length = 0;
+    UA_StatusCode retval = Int32_decodeBinary(pos, end, &length);
+    if(retval != UA_STATUSCODE_GOOD || length <= 0)
+        return retval;
+    return skipBytes(pos, end, (size_t)length);
+}
+
+/* The flags of the ExpandedNodeId are in the upper bits */
+static UA_StatusCode
+skipNodeId(bufpos pos, bufend end, UA_Byte *encodingByte) {
+    UA_StatusCode retval = Byte_decodeBinary(pos, end, encodingByte);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    switch(*encodingByte & 0x3F) {
+    case UA_NODEIDTYPE_NUMERIC_TWOBYTE:
+        return skipBytes(pos, end, 1);
+    case UA_NODEIDTYPE_NUMERIC_FOURBYTE:
+        return skipBytes(pos, end, 3);
+    case UA_NODEIDTYPE_NUMERIC_COMPLETE:
+        return skipBytes(pos, end, 6);
+    case UA_NODEIDTYPE_GUID:
+        return skipBytes(pos, end, 18);
+    case UA_NODEIDTYPE_STRING:
+    case UA_NODEIDTYPE_BYTESTRING:
+        retval = skipBytes(pos, end, 2);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+        return skipString(pos, end);
+    default:
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+}
+
+static UA_StatusCode
+skipVariant(bufpos pos, bufend end) {
+    UA_Byte encodingByte;
+    UA_StatusCode retval = Byte_decodeBinary(pos, end, &encodingByte);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    size_t typeIndex = (size_t)((encodingByte & UA_VARIANT_ENCODINGMASKTYPE_TYPEID_MASK) - 1);
+    if(typeIndex > 24)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    if(!(encodingByte & UA_VARIANT_ENCODINGMASKTYPE_ARRAY))
+        return skipBinary(pos, end, typeIndex);
+
+    UA_Int32 length = 0;
+    retval = Int32_decodeBinary(pos, end, &length);
+    if(length > 0 && (size_t)length > (size_t)(end - *pos))
+        return UA_STATUSCODE_BADDECODINGERROR; /* every element has at least one byte */
+    if(length > 0 && fixedBinarySize[typeIndex] > 0)
+        retval |= skipBytes(pos, end, (size_t)length * fixedBinarySize[typeIndex]);
+    else {
+        for(UA_Int32 i = 0; i < length && retval == UA_STATUSCODE_GOOD; i++)
+            retval = skipBinary(pos, end, typeIndex);
+    }
+    if(retval == UA_STATUSCODE_GOOD && (encodingByte & UA_VARIANT_ENCODINGMASKTYPE_DIMENSIONS)) {
+        retval = Int32_decodeBinary(pos, end, &length);
+        if(retval == UA_STATUSCODE_GOOD && length > 0)
+            retval = skipBytes(pos, end, (size_t)length * 4);
+    }
+    return retval;
+}
+
+static UA_StatusCode
+skipBinary(bufpos pos, bufend end, size_t typeIndex) {
+    if(fixedBinarySize[typeIndex] > 0)
+        return skipBytes(pos, end, fixedBinarySize[typeIndex]);
+    UA_Byte mask = 0;
+    UA_StatusCode retval;
+    switch(typeIndex) {
+    case UA_TYPES_STRING:
+    case UA_TYPES_BYTESTRING:
+    case UA_TYPES_XMLELEMENT:
+        return skipString(pos, end);
+    case UA_TYPES_NODEID:
+        return skipNodeId(pos, end, &mask);
+    case UA_TYPES_EXPANDEDNODEID:
+        retval = skipNodeId(pos, end, &mask);
+        if(retval == UA_STATUSCODE_GOOD && (mask & UA_EXPANDEDNODEID_NAMESPACEURI_FLAG))
+            retval = skipString(pos, end);
+        if(retval == UA_STATUSCODE_GOOD && (mask & UA_EXPANDEDNODEID_SERVERINDEX_FLAG))
+            retval = skipBytes(pos, end, 4);
+        return retval;
+    case UA_TYPES_QUALIFIEDNAME:
+        retval = skipBytes(pos, end, 2);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+        return skipString(pos, end);
+    case UA_TYPES_LOCALIZEDTEXT:
+        retval = Byte_decodeBinary(pos, end, &mask);
+        if(retval == UA_STATUSCODE_GOOD && (mask & UA_LOCALIZEDTEXT_ENCODINGMASKTYPE_LOCALE))
+            retval = skipString(pos, end);
+        if(retval == UA_STATUSCODE_GOOD && (mask & UA_LOCALIZEDTEXT_ENCODINGMASKTYPE_TEXT))
+            retval = skipString(pos, end);
+        return retval;
+    case UA_TYPES_EXTENSIONOBJECT:
+        retval = skipNodeId(pos, end, &mask);
+        if(retval == UA_STATUSCODE_GOOD)
+            retval = Byte_decodeBinary(pos, end, &mask);
+        if(retval == UA_STATUSCODE_GOOD && mask != UA_EXTENSIONOBJECT_ENCODED_NOBODY)
+            retval = skipString(pos, end);
+        return retval;
+    case UA_TYPES_DATAVALUE:
+        /* the mask has the layout of the bitfield in UA_DataValue */
+        retval = Byte_decodeBinary(pos, end, &mask);
+        if(retval == UA_STATUSCODE_GOOD && (mask & 0x01))
+            retval = skipVariant(pos, end);
+        if(retval == UA_STATUSCODE_GOOD)
+            retval = skipBytes(pos, end, ((mask & 0x02) ? 4 : 0) + ((mask & 0x04) ? 8 : 0) +
+                               ((mask & 0x08) ? 8 : 0) + ((mask & 0x10) ? 2 : 0) +
+                               ((mask & 0x20) ? 2 : 0));
+        return retval;
+    case UA_TYPES_VARIANT:
+        return skipVariant(pos, end);
+    case UA_TYPES_DIAGNOSTICINFO:
+        /* the mask has the layout of the bitfield in UA_DiagnosticInfo */
+        retval = Byte_decodeBinary(pos, end, &mask);
+        if(retval == UA_STATUSCODE_GOOD)
+            retval = skipBytes(pos, end, ((mask & 0x01) ? 4 : 0) + ((mask & 0x02) ? 4 : 0) +
+                               ((mask & 0x04) ? 4 : 0) + ((mask & 0x08) ? 4 : 0));
+        if(retval == UA_STATUSCODE_GOOD && (mask & 0x10))
+            retval = skipString(pos, end);
+        if(retval == UA_STATUSCODE_GOOD && (mask & 0x20))
+            retval = skipBytes(pos, end, 4);
+        if(retval == UA_STATUSCODE_GOOD && (mask & 0x40))
+            retval = skipBinary(pos, end, UA_TYPES_DIAGNOSTICINFO);
+        return retval;
+    default:
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+}
+
 static UA_StatusCode
 Variant_encodeBinary(UA_Variant const *src, bufpos pos, bufend end) {
+    if(src->type == &UA_ENCODEDVARIANT) {
+        const UA_ByteString *encoded = src->data;
+        if((size_t)(end - *pos) < encoded->length)
+            return UA_STATUSCODE_BADENCODINGERROR;
+        memcpy(*pos, encoded->data, encoded->length);
+        (*pos) += encoded->length;
+        return UA_STATUSCODE_GOOD;
+    }
     if(!src->type)
         return UA_STATUSCODE_BADINTERNALERROR;
     const UA_Boolean isArray = src->arrayLength > 0 || src->data <= UA_EMPTY_ARRAY_SENTINEL;
@@ -4493,10 +5050,8 @@ Variant_encodeBinary(UA_Variant const *src, bufpos pos, bufend end) {
         encode_index = UA_BUILTIN_TYPES_COUNT;
         /* wrap the datatype in an extensionobject */
         encodingByte |= UA_VARIANT_ENCODINGMASKTYPE_TYPEID_MASK & (UA_Byte) 22;
-        typeId = src->type->typeId;
-        if(typeId.identifierType != UA_NODEIDTYPE_NUMERIC)
+        if(getBinaryEncodingId(src->type, &typeId) != UA_STATUSCODE_GOOD)
             return UA_STATUSCODE_BADINTERNALERROR;
-        typeId.identifier.numeric += UA_ENCODINGOFFSET_BINARY;
     }
     UA_StatusCode retval = Byte_encodeBinary(&encodingByte, pos, end);
 
@@ -4514,6 +5069,11 @@ Variant_encodeBinary(UA_Variant const *src, bufpos pos, bufend end) {
         retval |= Int32_encodeBinary(&encodeLength, pos, end);
     }
 
+    if(isBuiltin && isArray && Array_isBulk(src->type)) {
+        retval |= Array_encodeBulk(src->data, length, src->type, pos, end);
+        length = 0;
+    }
+
     uintptr_t ptr = (uintptr_t)src->data;
     const UA_UInt16 memSize = src->type->memSize;
     for(size_t i = 0; i < length; i++) {
@@ -4542,8 +5102,8 @@ Variant_encodeBinary(UA_Variant const *src, bufpos pos, bufend end) {
     return retval;
 }
 
-/* The resulting variant always has the storagetype UA_VARIANT_DATA. Currently,
- we only support ns0 types (todo: attach typedescriptions to datatypenodes) */
+/* The resulting variant always has the storagetype UA_VARIANT_DATA. Structures
+ are decoded if their type is in the registry */
 static UA_StatusCode
 Variant_decodeBinary(bufpos pos, bufend end, UA_Variant *dst) {
     UA_Byte encodingByte;
@@ -4555,6 +5115,29 @@ Variant_decodeBinary(bufpos pos, bufend end, UA_Variant *dst) {
     if(typeIndex > 24) /* the type must be builtin (maybe wrapped in an extensionobject) */
         return UA_STATUSCODE_BADDECODINGERROR;
 
+    /* Scalars with a fixed size are decoded right away. That is cheaper than
+       keeping them encoded. */
+    if(lazyDecoding && (isArray || fixedBinarySize[typeIndex] == 0)) {
+        UA_Byte *start = *pos - 1;
+        retval = skipVariant(&start, end);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+        UA_ByteString *encoded = UA_malloc(sizeof(UA_ByteString));
+        if(!encoded)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        encoded->length = (size_t)(start - (*pos - 1));
+        encoded->data = UA_malloc(encoded->length);
+        if(!encoded->data) {
+            UA_free(encoded);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        memcpy(encoded->data, *pos - 1, encoded->length);
+        *pos = start;
+        dst->type = &UA_ENCODEDVARIANT;
+        dst->data = encoded;
+        return UA_STATUSCODE_GOOD;
+    }
+
     if(isArray) {
         /* an array */
         dst->type = &UA_TYPES[typeIndex];
@@ -4584,10 +5167,16 @@ Variant_decodeBinary(bufpos pos, bufend end, UA_Variant *dst) {
             return retval;
         }
 
-        /* search for the datatype. use extensionobject if nothing is found */
+        /* search for the datatype and decode the body after the length. use
+           extensionobject if nothing is found. */
         dst->type = &UA_TYPES[UA_TYPES_EXTENSIONOBJECT];
-        if(typeId.namespaceIndex == 0 && eo_encoding == UA_EXTENSIONOBJECT_ENCODED_BYTESTRING &&
-           findDataType(&typeId, &dst->type) == UA_STATUSCODE_GOOD)
+        if(eo_encoding == UA_EXTENSIONOBJECT_ENCODED_BYTESTRING) {
+            const UA_DataType *found = UA_findDataTypeByBinaryEncoding(&typeId);
+            UA_Int32 length;
+            if(found && Int32_decodeBinary(pos, end, &length) == UA_STATUSCODE_GOOD)
+                dst->type = found;
+        }
+        if(dst->type == &UA_TYPES[UA_TYPES_EXTENSIONOBJECT])
             *pos = old_pos;
         UA_NodeId_deleteMembers(&typeId);
 
@@ -4618,6 +5207,53 @@ Variant_decodeBinary(bufpos pos, bufend end, UA_Variant *dst) {
     return retval;
 }
 
+UA_StatusCode
+UA_Variant_decodeLazy(UA_Variant *v) {
+    if(v->type != &UA_ENCODEDVARIANT)
+        return UA_STATUSCODE_GOOD;
+    const UA_ByteString *encoded = v->data;
+    UA_Byte *pos = encoded->data;
+    UA_Variant decoded;
+    UA_Variant_init(&decoded);
+    UA_Boolean lazy = UA_setLazyDecoding(UA_FALSE);
+    UA_StatusCode retval = Variant_decodeBinary(&pos, &encoded->data[encoded->length], &decoded);
+    lazyDecoding = lazy;
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_Variant_deleteMembers(v);
+    *v = decoded;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_ExtensionObject_decodeLazy(UA_ExtensionObject *eo) {
+    if(eo->encoding != UA_EXTENSIONOBJECT_ENCODED_BYTESTRING)
+        return UA_STATUSCODE_GOOD;
+    const UA_DataType *datatype = UA_findDataTypeByBinaryEncoding(&eo->content.encoded.typeId);
+    if(!datatype)
+        return UA_STATUSCODE_GOOD; /* unknown types stay encoded */
+    void *data = UA_new(datatype);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_ByteString body = eo->content.encoded.body;
+    UA_Byte *pos = body.data;
+    size_t decode_index = datatype->builtin ? datatype->typeIndex : UA_BUILTIN_TYPES_COUNT;
+    UA_Boolean lazy = UA_setLazyDecoding(UA_FALSE);
+    type = datatype;
+    UA_StatusCode retval = decodeBinaryJumpTable[decode_index](&pos, &body.data[body.length], data);
+    lazyDecoding = lazy;
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_delete(data, datatype);
+        return retval;
+    }
+    UA_ByteString_deleteMembers(&body);
+    UA_NodeId_deleteMembers(&eo->content.encoded.typeId);
+    eo->encoding = UA_EXTENSIONOBJECT_DECODED;
+    eo->content.decoded.type = datatype;
+    eo->content.decoded.data = data;
+    return UA_STATUSCODE_GOOD;
+}
+
 /* DataValue */
 static UA_StatusCode
 DataValue_encodeBinary(UA_DataValue const *src, bufpos pos, bufend end) {
@@ -4723,8 +5359,37 @@ DiagnosticInfo_decodeBinary(bufpos pos, bufend end, UA_DiagnosticInfo *dst) {
 /* Structured Types */
 /********************/
 
+static UA_StatusCode
+encodeBinaryProgram(const CodecOp *op, const void *src, bufpos pos, bufend end) {
+    uintptr_t base = (uintptr_t)src;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(; op->op != CODEC_END && retval == UA_STATUSCODE_GOOD; op++) {
+        const void *ptr = (const void*)(base + op->offset);
+        switch(op->op) {
+        case CODEC_COPY:
+            if(*pos + op->length > end)
+                return UA_STATUSCODE_BADENCODINGERROR;
+            memcpy(*pos, ptr, op->length);
+            (*pos) += op->length;
+            break;
+        case CODEC_CALL:
+            type = op->type;
+            retval = encodeBinaryJumpTable[op->index](ptr, pos, end);
+            break;
+        default: /* CODEC_ARRAY */
+            retval = Array_encodeBinary(*(void *UA_RESTRICT const *)((uintptr_t)ptr + sizeof(size_t)),
+                                        *(const size_t*)ptr, op->type, pos, end);
+            break;
+        }
+    }
+    return retval;
+}
+
 static UA_StatusCode
 UA_encodeBinaryInternal(const void *src, bufpos pos, bufend end) {
+    const CodecOp *program = findCodecProgram(type);
+    if(program)
+        return encodeBinaryProgram(program, src, pos, end);
     uintptr_t ptr = (uintptr_t)src;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     UA_Byte membersSize = type->membersSize;
@@ -4788,12 +5453,86 @@ UA_StatusCode UA_encodeBinary(const void *src, const UA_DataType *localtype, UA_
     return retval;
 }
 
+/* The encoding is written in a single pass when the buffer is large enough.
+   The encoders take the buffer end by value and patch lengths behind them, so
+   the buffer cannot move during the pass. If it turns out too small, it is
+   grown to the exact size and the encoding is repeated once. */
+UA_StatusCode
+UA_encodeBinaryGrow(const void *src, const UA_DataType *localtype, UA_ByteString *dst, size_t *offset) {
+    size_t start = *offset;
+    if(dst->length - start < 64) {
+        size_t capacity = dst->length < 128 ? 256 : dst->length * 2;
+        UA_Byte *data = UA_realloc(dst->data, capacity);
+        if(!data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        dst->data = data;
+        dst->length = capacity;
+    }
+    UA_StatusCode retval = UA_encodeBinary(src, localtype, dst, offset);
+    if(retval == UA_STATUSCODE_GOOD)
+        return retval;
+    *offset = start;
+    size_t needed = start + UA_calcSizeBinary((void*)(uintptr_t)src, localtype);
+    if(needed <= dst->length)
+        return retval; /* the buffer was large enough, not a size problem */
+    size_t capacity = dst->length * 2;
+    if(capacity < needed)
+        capacity = needed;
+    UA_Byte *data = UA_realloc(dst->data, capacity);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    dst->data = data;
+    dst->length = capacity;
+    retval = UA_encodeBinary(src, localtype, dst, offset);
+    if(retval != UA_STATUSCODE_GOOD)
+        *offset = start;
+    return retval;
+}
+
+static UA_StatusCode
+decodeBinaryProgram(const CodecOp *op, bufpos pos, bufend end, void *dst) {
+    uintptr_t base = (uintptr_t)dst;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(; op->op != CODEC_END && retval == UA_STATUSCODE_GOOD; op++) {
+        void *ptr = (void*)(base + op->offset);
+        switch(op->op) {
+        case CODEC_COPY:
+            if(*pos + op->length > end)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            memcpy(ptr, *pos, op->length);
+            (*pos) += op->length;
+            break;
+        case CODEC_CALL:
+            type = op->type;
+            retval = decodeBinaryJumpTable[op->index](pos, end, ptr);
+            break;
+        default: { /* CODEC_ARRAY */
+            UA_Int32 slength = -1;
+            retval = Int32_decodeBinary(pos, end, &slength);
+            if(retval == UA_STATUSCODE_GOOD)
+                retval = Array_decodeBinary(pos, end, slength,
+                                            (void *UA_RESTRICT *UA_RESTRICT)((uintptr_t)ptr + sizeof(size_t)),
+                                            (size_t*)ptr, op->type);
+            break;
+        }
+        }
+    }
+    return retval;
+}
+
 static UA_StatusCode
 UA_decodeBinaryInternal(bufpos pos, bufend end, void *dst) {
+    const UA_DataType *localtype = type;
+    const CodecOp *program = findCodecProgram(localtype);
+    if(program) {
+        UA_StatusCode retval = decodeBinaryProgram(program, pos, end, dst);
+        if(retval != UA_STATUSCODE_GOOD)
+            UA_deleteMembers(dst, localtype);
+        return retval;
+    }
     uintptr_t ptr = (uintptr_t)dst;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     UA_Byte membersSize = type->membersSize;
-    const UA_DataType *localtype = type;
     const UA_DataType *typelists[2] = { UA_TYPES, &localtype[-localtype->typeIndex] };
     for(size_t i = 0; i < membersSize; i++) {
         const UA_DataTypeMember *member = &localtype->members[i];
@@ -4944,11 +5683,13 @@ ExtensionObject_calcSizeBinary(const UA_ExtensionObject *src, UA_DataType *_) {
     if(src->encoding > UA_EXTENSIONOBJECT_ENCODED_XML) {
         if(!src->content.decoded.type || !src->content.decoded.data)
             return 0;
-        if(src->content.decoded.type->typeId.identifierType != UA_NODEIDTYPE_NUMERIC)
+        UA_NodeId typeId;
+        if(getBinaryEncodingId(src->content.decoded.type, &typeId) != UA_STATUSCODE_GOOD)
             return 0;
-        s += NodeId_calcSizeBinary(&src->content.decoded.type->typeId, NULL);
+        s += NodeId_calcSizeBinary(&typeId, NULL);
         s += 4; // length
-        size_t encode_index = type->builtin ? type->typeIndex : UA_BUILTIN_TYPES_COUNT;
+        const UA_DataType *t = src->content.decoded.type;
+        size_t encode_index = t->builtin ? t->typeIndex : UA_BUILTIN_TYPES_COUNT;
         s += calcSizeBinaryJumpTable[encode_index](src->content.decoded.data, src->content.decoded.type);
     } else {
         s += NodeId_calcSizeBinary(&src->content.encoded.typeId, NULL);
@@ -4968,6 +5709,8 @@ ExtensionObject_calcSizeBinary(const UA_ExtensionObject *src, UA_DataType *_) {
 
 static size_t
 Variant_calcSizeBinary(UA_Variant const *src, UA_DataType *_) {
+    if(src->type == &UA_ENCODEDVARIANT)
+        return ((const UA_ByteString*)src->data)->length;
     size_t s = 1; // encoding byte
 
     if(!src->type)
@@ -4981,8 +5724,7 @@ Variant_calcSizeBinary(UA_Variant const *src, UA_DataType *_) {
     size_t encode_index = src->type->typeIndex;
     if(!isBuiltin) {
         encode_index = UA_BUILTIN_TYPES_COUNT;
-        typeId = src->type->typeId;
-        if(typeId.identifierType != UA_NODEIDTYPE_NUMERIC)
+        if(getBinaryEncodingId(src->type, &typeId) != UA_STATUSCODE_GOOD)
             return 0;
     }
 
@@ -6936,6 +7678,9 @@ __UA_Server_addNode(UA_Server *server, const UA_NodeClass nodeClass,
 void UA_Server_delete(UA_Server *server) {
     // Delete the timed work
     UA_Server_deleteAllRepeatedJobs(server);
+#ifdef UA_ENABLE_METHODCALLS
+    UA_Server_deleteAllAsyncCalls(server);
+#endif
 
     // Delete all internal data
     UA_SecureChannelManager_deleteMembers(&server->secureChannelManager);
@@ -7092,6 +7837,9 @@ UA_Server * UA_Server_new(const UA_ServerConfig config) {
     server->config = config;
     server->nodestore = UA_NodeStore_new();
     LIST_INIT(&server->repeatedJobs);
+#ifdef UA_ENABLE_METHODCALLS
+    LIST_INIT(&server->asyncCalls);
+#endif
 
 #ifdef UA_ENABLE_MULTITHREADING
     rcu_init();
@@ -8405,12 +9153,24 @@ processMSG(UA_Connection *connection, UA_Server *server, const UA_ByteString *ms
     }
 #endif
 
-    /* Decode the request */
+    /* Decode the request. Read and Write requests are decoded into a message
+       arena that is released at once after the response is sent. The services
+       copy what they keep and allocate from the heap. */
+    ua_arena *arena = NULL;
+    if(requestType == &UA_TYPES[UA_TYPES_READREQUEST] ||
+       requestType == &UA_TYPES[UA_TYPES_WRITEREQUEST])
+        arena = ua_arena_push_message();
     void *request = UA_alloca(requestType->memSize);
     size_t oldpos = *pos;
+    ua_arena *active = ua_arena_current();
+    if(arena)
+        ua_arena_use(arena);
     retval = UA_decodeBinary(&bytes, pos, request, requestType);
+    ua_arena_use(active);
     if(retval != UA_STATUSCODE_GOOD) {
         sendError(channel, &bytes, oldpos, sequenceHeader.requestId, retval);
+        if(arena)
+            ua_arena_pop(arena);
         return;
     }
 
@@ -8431,6 +9191,8 @@ processMSG(UA_Connection *connection, UA_Server *server, const UA_ByteString *ms
         UA_LOG_INFO(server->config.logger, UA_LOGCATEGORY_SERVER,
                     "Client tries to call a service with a non-activated session");
         sendError(channel, &bytes, *pos, sequenceHeader.requestId, UA_STATUSCODE_BADSESSIONNOTACTIVATED);
+        if(arena)
+            ua_arena_pop(arena);
         return;
     }
 #ifndef UA_ENABLE_NONSTANDARD_STATELESS
@@ -8439,6 +9201,8 @@ processMSG(UA_Connection *connection, UA_Server *server, const UA_ByteString *ms
         UA_LOG_INFO(server->config.logger, UA_LOGCATEGORY_SERVER,
                     "Client tries to call a service without a session");
         sendError(channel, &bytes, *pos, sequenceHeader.requestId, UA_STATUSCODE_BADSESSIONIDINVALID);
+        if(arena)
+            ua_arena_pop(arena);
         return;
     }
 #endif
@@ -8460,6 +9224,18 @@ processMSG(UA_Connection *connection, UA_Server *server, const UA_ByteString *ms
     init_response_header(request, response);
     service(server, session, request, response);
 
+#ifdef UA_ENABLE_METHODCALLS
+    /* Calls with deferred methods are answered later */
+    if(server->deferredCall &&
+       UA_Server_parkAsyncCall(server, sequenceHeader.requestId, request, response)) {
+        if(final_chunked_pos) {
+            *pos = final_chunked_pos;
+            UA_ByteString_deleteMembers(&bytes);
+        }
+        return;
+    }
+#endif
+
     /* Send the response */
     retval = UA_SecureChannel_sendBinaryMessage(channel, sequenceHeader.requestId,
                                                 response, responseType);
@@ -8474,8 +9250,11 @@ processMSG(UA_Connection *connection, UA_Server *server, const UA_ByteString *ms
         UA_ByteString_deleteMembers(&bytes);
     }
 
-    UA_deleteMembers(request, requestType);
     UA_deleteMembers(response, responseType);
+    if(arena)
+        ua_arena_pop(arena);
+    else
+        UA_deleteMembers(request, requestType);
     return;
 }
 
@@ -9337,6 +10116,9 @@ UA_UInt16 UA_Server_run_iterate(UA_Server *server, UA_Boolean waitInternal) {
     /* Process repeated work */
     UA_DateTime now = UA_DateTime_nowMonotonic();
     UA_DateTime nextRepeated = processRepeatedJobs(server, now);
+#ifdef UA_ENABLE_METHODCALLS
+    UA_Server_processAsyncCalls(server, now);
+#endif
 
     UA_UInt16 timeout = 0;
     if(waitInternal)
@@ -10333,6 +11115,104 @@ void Service_Read_single(UA_Server *server, UA_Session *session, const UA_Timest
     handleServerTimestamps(timestamps, v);
 }
 
+/* Reads the Value attribute of data source variables with a readBatch, one
+   call per readBatch and batchHandle. Returns the array of the read nodes
+   (NULL entries are read by Service_Read_single) or NULL if no node was
+   read. */
+static const UA_VariableNode **
+Service_Read_batches(UA_Server *server, const UA_TimestampsToReturn timestamps,
+                     const UA_ReadRequest *request, UA_DataValue *results) {
+    size_t size = request->nodesToReadSize;
+    const UA_VariableNode **nodes = NULL;
+    size_t candidates = 0;
+    for(size_t i = 0; i < size; i++) {
+        const UA_ReadValueId *id = &request->nodesToRead[i];
+        if(id->attributeId != UA_ATTRIBUTEID_VALUE)
+            continue;
+        if(id->dataEncoding.name.length > 0 && !UA_String_equal(&binEncoding, &id->dataEncoding.name))
+            continue;
+        const UA_Node *node = UA_NodeStore_get(server->nodestore, &id->nodeId);
+        if(!node || node->nodeClass != UA_NODECLASS_VARIABLE)
+            continue;
+        const UA_VariableNode *vn = (const UA_VariableNode*)node;
+        if(vn->valueSource != UA_VALUESOURCE_DATASOURCE || !vn->value.dataSource.readBatch)
+            continue;
+        if(!nodes) {
+            nodes = UA_calloc(size, sizeof(UA_VariableNode*));
+            if(!nodes)
+                return NULL;
+        }
+        nodes[i] = vn;
+        candidates++;
+    }
+    if(!nodes)
+        return NULL;
+
+    /* the arguments of a call, in one block */
+    size_t blockSize = candidates * (sizeof(UA_NodeId) + sizeof(UA_NumericRange) + sizeof(void*) +
+                                     sizeof(UA_NumericRange*) + sizeof(UA_DataValue*) + sizeof(size_t));
+    UA_NodeId *nodeIds = UA_malloc(blockSize);
+    if(!nodeIds) {
+        UA_free(nodes);
+        return NULL;
+    }
+    UA_NumericRange *rangeData = (UA_NumericRange*)&nodeIds[candidates];
+    void **handles = (void**)&rangeData[candidates];
+    const UA_NumericRange **ranges = (const UA_NumericRange**)&handles[candidates];
+    UA_DataValue **values = (UA_DataValue**)&ranges[candidates];
+    size_t *indices = (size_t*)&values[candidates];
+    UA_Boolean sourceTimeStamp = (timestamps == UA_TIMESTAMPSTORETURN_SOURCE ||
+                                  timestamps == UA_TIMESTAMPSTORETURN_BOTH);
+
+    /* nodes[i] is set to NULL if the item is read by Service_Read_single.
+       Items of the groups already read are above index i and marked in
+       results with hasValue or hasStatus. */
+    for(size_t i = 0; i < size; i++) {
+        if(!nodes[i] || results[i].hasValue || results[i].hasStatus)
+            continue;
+        const UA_DataSource source = nodes[i]->value.dataSource;
+        size_t n = 0;
+        for(size_t j = i; j < size; j++) {
+            if(!nodes[j] || nodes[j]->value.dataSource.readBatch != source.readBatch ||
+               nodes[j]->value.dataSource.batchHandle != source.batchHandle)
+                continue;
+            const UA_ReadValueId *id = &request->nodesToRead[j];
+            ranges[n] = NULL;
+            if(id->indexRange.length > 0) {
+                if(parse_numericrange(&id->indexRange, &rangeData[n]) != UA_STATUSCODE_GOOD) {
+                    nodes[j] = NULL; /* reports the error */
+                    continue;
+                }
+                ranges[n] = &rangeData[n];
+            }
+            handles[n] = nodes[j]->value.dataSource.handle;
+            nodeIds[n] = nodes[j]->nodeId;
+            values[n] = &results[j];
+            indices[n] = j;
+            n++;
+        }
+        if(n == 0)
+            continue;
+        UA_StatusCode retval = source.readBatch(source.batchHandle, n, handles, nodeIds,
+                                                sourceTimeStamp, ranges, values);
+        for(size_t k = 0; k < n; k++) {
+            if(retval != UA_STATUSCODE_GOOD) {
+                UA_DataValue_deleteMembers(values[k]);
+                values[k]->hasStatus = UA_TRUE;
+                values[k]->status = retval;
+            } else if(!values[k]->hasValue && !values[k]->hasStatus) {
+                values[k]->hasStatus = UA_TRUE;
+                values[k]->status = UA_STATUSCODE_BADINTERNALERROR;
+            }
+            handleServerTimestamps(timestamps, values[k]);
+            if(ranges[k])
+                UA_free(rangeData[k].dimensions);
+        }
+    }
+    UA_free(nodeIds);
+    return nodes;
+}
+
 void Service_Read(UA_Server *server, UA_Session *session, const UA_ReadRequest *request,
                   UA_ReadResponse *response) {
     UA_LOG_DEBUG(server->config.logger, UA_LOGCATEGORY_SESSION,
@@ -10382,13 +11262,18 @@ void Service_Read(UA_Server *server, UA_Session *session, const UA_ReadRequest *
     }
 #endif
 
+    const UA_VariableNode **batched =
+        Service_Read_batches(server, request->timestampsToReturn, request, response->results);
     for(size_t i = 0;i < size;i++) {
+        if(batched && batched[i])
+            continue;
 #ifdef UA_ENABLE_EXTERNAL_NAMESPACES
         if(!isExternal[i])
 #endif
             Service_Read_single(server, session, request->timestampsToReturn,
                                 &request->nodesToRead[i], &response->results[i]);
     }
+    UA_free(batched);
 
 #ifdef UA_ENABLE_NONSTANDARD_STATELESS
     /* Add an expiry header for caching */
@@ -12424,7 +13309,7 @@ static void UA_Client_deleteMembers(UA_Client* client) {
     UA_Client_NotificationsAckNumber *n, *tmp;
     LIST_FOREACH_SAFE(n, &client->pendingNotificationsAcks, listEntry, tmp) {
         LIST_REMOVE(n, listEntry);
-        free(n);
+        UA_free(n);
     }
     UA_Client_Subscription *sub, *tmps;
     LIST_FOREACH_SAFE(sub, &client->subscriptions, listEntry, tmps) {
@@ -12434,7 +13319,7 @@ static void UA_Client_deleteMembers(UA_Client* client) {
             UA_Client_Subscriptions_removeMonitoredItem(client, sub->SubscriptionID,
                                                         mon->MonitoredItemId);
         }
-        free(sub);
+        UA_free(sub);
     }
 #endif
 }
@@ -12968,6 +13853,11 @@ UA_StatusCode UA_Client_manuallyRenewSecureChannel(UA_Client *client) {
 
 void __UA_Client_Service(UA_Client *client, const void *r, const UA_DataType *requestType,
                          void *response, const UA_DataType *responseType) {
+    __UA_Client_ServiceArena(client, r, requestType, response, responseType, NULL);
+}
+
+void __UA_Client_ServiceArena(UA_Client *client, const void *r, const UA_DataType *requestType,
+                              void *response, const UA_DataType *responseType, ua_arena *arena) {
     /* Requests always begin witih a RequestHeader, therefore we can cast. */
     UA_RequestHeader *request = (void*)(uintptr_t)r;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
@@ -13039,12 +13929,21 @@ void __UA_Client_Service(UA_Client *client, const void *r, const UA_DataType *re
                          expectedNodeId.namespaceIndex, expectedNodeId.identifier.numeric,
                          responseId.namespaceIndex, responseId.identifier.numeric);
             respHeader->serviceResult = UA_STATUSCODE_BADINTERNALERROR;
-        } else
+        } else {
+            ua_arena *active = ua_arena_current();
+            if(arena)
+                ua_arena_use(arena);
             retval = UA_decodeBinary(&reply, &offset, respHeader, &UA_TYPES[UA_TYPES_SERVICEFAULT]);
+            ua_arena_use(active);
+        }
         goto finish;
     } 
     
+    ua_arena *active = ua_arena_current();
+    if(arena)
+        ua_arena_use(arena);
     retval = UA_decodeBinary(&reply, &offset, response, responseType);
+    ua_arena_use(active);
     if(retval == UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED)
         retval = UA_STATUSCODE_BADRESPONSETOOLARGE;
 
@@ -13424,7 +14323,7 @@ socket_write(UA_Connection *connection, UA_ByteString *buf) {
 
 static UA_StatusCode
 socket_recv(UA_Connection *connection, UA_ByteString *response, UA_UInt32 timeout) {
-    response->data = malloc(connection->localConf.recvBufferSize);
+    response->data = UA_malloc(connection->localConf.recvBufferSize);
     if(!response->data) {
         response->length = 0;
         return UA_STATUSCODE_BADOUTOFMEMORY; /* not enough memory retry */
@@ -13510,7 +14409,7 @@ static UA_StatusCode socket_set_nonblocking(UA_Int32 sockfd) {
 
 static void FreeConnectionCallback(UA_Server *server, void *ptr) {
     UA_Connection_deleteMembers((UA_Connection*)ptr);
-    free(ptr);
+    UA_free(ptr);
  }
 
 /***************************/
@@ -13616,7 +14515,7 @@ ServerNetworkLayerTCP_closeConnection(UA_Connection *connection) {
 /* call only from the single networking thread */
 static UA_StatusCode
 ServerNetworkLayerTCP_add(ServerNetworkLayerTCP *layer, UA_Int32 newsockfd) {
-    UA_Connection *c = malloc(sizeof(UA_Connection));
+    UA_Connection *c = UA_malloc(sizeof(UA_Connection));
     if(!c)
         return UA_STATUSCODE_BADINTERNALERROR;
 
@@ -13636,10 +14535,10 @@ ServerNetworkLayerTCP_add(ServerNetworkLayerTCP *layer, UA_Int32 newsockfd) {
     c->releaseRecvBuffer = ServerNetworkLayerReleaseRecvBuffer;
     c->state = UA_CONNECTION_OPENING;
     struct ConnectionMapping *nm;
-    nm = realloc(layer->mappings, sizeof(struct ConnectionMapping)*(layer->mappingsSize+1));
+    nm = UA_realloc(layer->mappings, sizeof(struct ConnectionMapping)*(layer->mappingsSize+1));
     if(!nm) {
         UA_LOG_ERROR(layer->logger, UA_LOGCATEGORY_NETWORK, "No memory for a new Connection");
-        free(c);
+        UA_free(c);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
     layer->mappings = nm;
@@ -13734,7 +14633,7 @@ ServerNetworkLayerTCP_getJobs(UA_ServerNetworkLayer *nl, UA_Job **jobs, UA_UInt1
     /* alloc enough space for a cleanup-connection and free-connection job per resulted socket */
     if(resultsize == 0)
         return 0;
-    UA_Job *js = malloc(sizeof(UA_Job) * (size_t)resultsize * 2);
+    UA_Job *js = UA_malloc(sizeof(UA_Job) * (size_t)resultsize * 2);
     if(!js)
         return 0;
 
@@ -13773,7 +14672,7 @@ ServerNetworkLayerTCP_getJobs(UA_ServerNetworkLayer *nl, UA_Job **jobs, UA_UInt1
     }
 
     if(j == 0) {
-    	free(js);
+    	UA_free(js);
     	js = NULL;
     }
 
@@ -13788,7 +14687,7 @@ ServerNetworkLayerTCP_stop(UA_ServerNetworkLayer *nl, UA_Job **jobs) {
                 "Shutting down the TCP network layer with %d open connection(s)", layer->mappingsSize);
     shutdown(layer->serversockfd,2);
     CLOSESOCKET(layer->serversockfd);
-    UA_Job *items = malloc(sizeof(UA_Job) * layer->mappingsSize * 2);
+    UA_Job *items = UA_malloc(sizeof(UA_Job) * layer->mappingsSize * 2);
     if(!items)
         return 0;
     for(size_t i = 0; i < layer->mappingsSize; i++) {
@@ -13809,8 +14708,8 @@ ServerNetworkLayerTCP_stop(UA_ServerNetworkLayer *nl, UA_Job **jobs) {
 /* run only when the server is stopped */
 static void ServerNetworkLayerTCP_deleteMembers(UA_ServerNetworkLayer *nl) {
     ServerNetworkLayerTCP *layer = nl->handle;
-    free(layer->mappings);
-    free(layer);
+    UA_free(layer->mappings);
+    UA_free(layer);
     UA_String_deleteMembers(&nl->discoveryUrl);
 }
 
@@ -13825,7 +14724,7 @@ UA_ServerNetworkLayerTCP(UA_ConnectionConfig conf, UA_UInt16 port) {
 
     UA_ServerNetworkLayer nl;
     memset(&nl, 0, sizeof(UA_ServerNetworkLayer));
-    ServerNetworkLayerTCP *layer = calloc(1,sizeof(ServerNetworkLayerTCP));
+    ServerNetworkLayerTCP *layer = UA_calloc(1,sizeof(ServerNetworkLayerTCP));
     if(!layer)
         return nl;
     
@@ -14297,6 +15196,18 @@ argConformsToDefinition(const UA_VariableNode *argRequirements, size_t argsSize,
     return retval;
 }
 
+/* Empty variants cannot be encoded. Failed calls return no outputs. */
+static void
+setCallMethodStatus(UA_CallMethodResult *result, UA_StatusCode status) {
+    result->statusCode = status;
+    if(status != UA_STATUSCODE_GOOD && status != UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY) {
+        UA_Array_delete(result->outputArguments, result->outputArgumentsSize,
+                        &UA_TYPES[UA_TYPES_VARIANT]);
+        result->outputArguments = NULL;
+        result->outputArgumentsSize = 0;
+    }
+}
+
 void
 Service_Call_single(UA_Server *server, UA_Session *session, const UA_CallMethodRequest *request,
                     UA_CallMethodResult *result) {
@@ -14372,9 +15283,11 @@ Service_Call_single(UA_Server *server, UA_Session *session, const UA_CallMethodR
         result->outputArguments = UA_Array_new(outputArguments->value.variant.value.arrayLength,
                                                &UA_TYPES[UA_TYPES_VARIANT]);
         result->outputArgumentsSize = outputArguments->value.variant.value.arrayLength;
-        result->statusCode = methodCalled->attachedMethod(methodCalled->methodHandle, withObject->nodeId,
-                                                          request->inputArgumentsSize, request->inputArguments,
-                                                          result->outputArgumentsSize, result->outputArguments);
+        UA_StatusCode retval =
+            methodCalled->attachedMethod(methodCalled->methodHandle, withObject->nodeId,
+                                         request->inputArgumentsSize, request->inputArguments,
+                                         result->outputArgumentsSize, result->outputArguments);
+        setCallMethodStatus(result, retval);
     }
     else
         result->statusCode = UA_STATUSCODE_BADNOTWRITABLE; // There is no NOTEXECUTABLE?
@@ -14397,8 +15310,170 @@ void Service_Call(UA_Server *server, UA_Session *session, const UA_CallRequest *
     }
     response->resultsSize = request->methodsToCallSize;
     
-    for(size_t i = 0; i < request->methodsToCallSize;i++)
+    server->callResponse = response;
+    for(size_t i = 0; i < request->methodsToCallSize;i++) {
+        server->callIndex = i;
         Service_Call_single(server, session, &request->methodsToCall[i], &response->results[i]);
+    }
+    server->callResponse = NULL;
+}
+
+/* Asynchronous method calls. The ids and deadlines of the deferred results
+   are kept with the parked request (id 0 once finished). The request and the
+   response are moved out of processMSG, the arrays with the inputs and
+   outputs stay in place. */
+typedef struct {
+    UA_UInt32 id;
+    UA_DateTime deadline;
+} UA_AsyncResult;
+
+typedef struct UA_AsyncCall {
+    LIST_ENTRY(UA_AsyncCall) pointers;
+    UA_UInt32 requestId;
+    size_t pending;
+    UA_AsyncResult *results;
+    UA_CallRequest request;
+    UA_CallResponse response;
+} UA_AsyncCall;
+
+UA_UInt32
+UA_Server_deferMethodCall(UA_Server *server, UA_UInt32 timeout) {
+    if(!server->callResponse)
+        return 0;
+    UA_AsyncCall *call = server->deferredCall;
+    if(!call) {
+        call = UA_calloc(1, sizeof(UA_AsyncCall));
+        if(!call)
+            return 0;
+        call->results = UA_calloc(server->callResponse->resultsSize, sizeof(UA_AsyncResult));
+        if(!call->results) {
+            UA_free(call);
+            return 0;
+        }
+        server->deferredCall = call;
+    }
+    UA_AsyncResult *result = &call->results[server->callIndex];
+    if(result->id == 0)
+        call->pending++;
+    do {
+        server->lastAsyncCallId++;
+    } while(server->lastAsyncCallId == 0);
+    result->id = server->lastAsyncCallId;
+    result->deadline = UA_DateTime_nowMonotonic() + (UA_DateTime)timeout * UA_MSEC_TO_DATETIME;
+    return result->id;
+}
+
+static UA_AsyncCall *
+findAsyncCall(UA_Server *server, UA_UInt32 id, size_t *index, UA_CallResponse **response) {
+    if(id == 0)
+        return NULL;
+    /* deferred by the request that is still being processed */
+    UA_AsyncCall *call = server->deferredCall;
+    if(call && server->callResponse) {
+        for(size_t i = 0; i < server->callResponse->resultsSize; i++) {
+            if(call->results[i].id == id) {
+                *index = i;
+                *response = server->callResponse;
+                return call;
+            }
+        }
+    }
+    LIST_FOREACH(call, &server->asyncCalls, pointers) {
+        for(size_t i = 0; i < call->response.resultsSize; i++) {
+            if(call->results[i].id == id) {
+                *index = i;
+                *response = &call->response;
+                return call;
+            }
+        }
+    }
+    return NULL;
+}
+
+UA_CallMethodResult *
+UA_Server_getDeferredMethodCall(UA_Server *server, UA_UInt32 id) {
+    size_t index;
+    UA_CallResponse *response;
+    if(!findAsyncCall(server, id, &index, &response))
+        return NULL;
+    return &response->results[index];
+}
+
+static void
+sendAsyncCall(UA_Server *server, UA_AsyncCall *call) {
+    LIST_REMOVE(call, pointers);
+    UA_Session *session =
+        UA_SessionManager_getSession(&server->sessionManager,
+                                     &call->request.requestHeader.authenticationToken);
+    if(session && session->channel)
+        UA_SecureChannel_sendBinaryMessage(session->channel, call->requestId, &call->response,
+                                           &UA_TYPES[UA_TYPES_CALLRESPONSE]);
+    UA_CallRequest_deleteMembers(&call->request);
+    UA_CallResponse_deleteMembers(&call->response);
+    UA_free(call->results);
+    UA_free(call);
+}
+
+void
+UA_Server_finishMethodCall(UA_Server *server, UA_UInt32 id, UA_StatusCode status) {
+    size_t index;
+    UA_CallResponse *response;
+    UA_AsyncCall *call = findAsyncCall(server, id, &index, &response);
+    if(!call)
+        return;
+    setCallMethodStatus(&response->results[index], status);
+    call->results[index].id = 0;
+    call->pending--;
+    if(call->pending == 0 && call != server->deferredCall)
+        sendAsyncCall(server, call);
+}
+
+UA_Boolean
+UA_Server_parkAsyncCall(UA_Server *server, UA_UInt32 requestId,
+                        UA_CallRequest *request, UA_CallResponse *response) {
+    UA_AsyncCall *call = server->deferredCall;
+    server->deferredCall = NULL;
+    if(call->pending == 0) {
+        UA_free(call->results);
+        UA_free(call);
+        return false;
+    }
+    call->requestId = requestId;
+    call->request = *request;
+    call->response = *response;
+    LIST_INSERT_HEAD(&server->asyncCalls, call, pointers);
+    return true;
+}
+
+void
+UA_Server_processAsyncCalls(UA_Server *server, UA_DateTime now) {
+    UA_AsyncCall *call = LIST_FIRST(&server->asyncCalls);
+    while(call) {
+        UA_AsyncCall *next = LIST_NEXT(call, pointers);
+        for(size_t i = 0; i < call->response.resultsSize; i++) {
+            UA_AsyncResult *result = &call->results[i];
+            if(result->id == 0 || result->deadline > now)
+                continue;
+            setCallMethodStatus(&call->response.results[i], UA_STATUSCODE_BADTIMEOUT);
+            result->id = 0;
+            call->pending--;
+        }
+        if(call->pending == 0)
+            sendAsyncCall(server, call);
+        call = next;
+    }
+}
+
+void
+UA_Server_deleteAllAsyncCalls(UA_Server *server) {
+    UA_AsyncCall *call;
+    while((call = LIST_FIRST(&server->asyncCalls))) {
+        LIST_REMOVE(call, pointers);
+        UA_CallRequest_deleteMembers(&call->request);
+        UA_CallResponse_deleteMembers(&call->response);
+        UA_free(call->results);
+        UA_free(call);
+    }
 }
 
 /*********************************** amalgamated original file "/home/jpfr/software/open62541/src/server/ua_nodestore.c" ***********************************/
@@ -15494,42 +16569,46 @@ void MonitoredItem_QueuePushDataValue(UA_Server *server, UA_MonitoredItem *monit
         monitoredItem->queueSize.currentValue--;
     }
   
-    // encode the data to find if its different to the previous
-    size_t binsize = UA_calcSizeBinary(&newvalue->value, &UA_TYPES[UA_TYPES_DATAVALUE]);
-    UA_StatusCode retval = UA_ByteString_allocBuffer(&newValueAsByteString, binsize);
+    // encode the data to find if its different to the previous. Most values
+    // fit into the stack buffer and unchanged values are then dropped without
+    // allocating.
+    UA_Byte stackBuffer[512];
+    newValueAsByteString.data = stackBuffer;
+    newValueAsByteString.length = sizeof(stackBuffer);
+    UA_StatusCode retval = UA_encodeBinary(&newvalue->value, &UA_TYPES[UA_TYPES_DATAVALUE],
+                                           &newValueAsByteString, &encodingOffset);
     if(retval != UA_STATUSCODE_GOOD) {
-        UA_DataValue_deleteMembers(&newvalue->value);
-        UA_free(newvalue);
-        return;
+        UA_ByteString_init(&newValueAsByteString);
+        encodingOffset = 0;
+        retval = UA_encodeBinaryGrow(&newvalue->value, &UA_TYPES[UA_TYPES_DATAVALUE],
+                                     &newValueAsByteString, &encodingOffset);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_ByteString_deleteMembers(&newValueAsByteString);
+            UA_DataValue_deleteMembers(&newvalue->value);
+            UA_free(newvalue);
+            return;
+        }
     }
-    
-    retval = UA_encodeBinary(&newvalue->value, &UA_TYPES[UA_TYPES_DATAVALUE], &newValueAsByteString, &encodingOffset);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_ByteString_deleteMembers(&newValueAsByteString);
+    UA_Boolean onStack = (newValueAsByteString.data == stackBuffer);
+    newValueAsByteString.length = encodingOffset;
+
+    if(monitoredItem->lastSampledValue.data &&
+       UA_String_equal(&newValueAsByteString, &monitoredItem->lastSampledValue) == UA_TRUE) {
         UA_DataValue_deleteMembers(&newvalue->value);
         UA_free(newvalue);
+        if(!onStack)
+            UA_ByteString_deleteMembers(&newValueAsByteString);
         return;
     }
-  
-    if(!monitoredItem->lastSampledValue.data) { 
+
+    UA_ByteString_deleteMembers(&monitoredItem->lastSampledValue);
+    if(onStack)
         UA_ByteString_copy(&newValueAsByteString, &monitoredItem->lastSampledValue);
-        TAILQ_INSERT_HEAD(&monitoredItem->queue, newvalue, listEntry);
-        monitoredItem->queueSize.currentValue++;
-        monitoredItem->lastSampled = UA_DateTime_now();
-        UA_free(newValueAsByteString.data);
-    } else {
-        if(UA_String_equal(&newValueAsByteString, &monitoredItem->lastSampledValue) == UA_TRUE) {
-            UA_DataValue_deleteMembers(&newvalue->value);
-            UA_free(newvalue);
-            UA_String_deleteMembers(&newValueAsByteString);
-            return;
-        }
-        UA_ByteString_deleteMembers(&monitoredItem->lastSampledValue);
+    else
         monitoredItem->lastSampledValue = newValueAsByteString;
-        TAILQ_INSERT_HEAD(&monitoredItem->queue, newvalue, listEntry);
-        monitoredItem->queueSize.currentValue++;
-        monitoredItem->lastSampled = UA_DateTime_now();
-    }
+    TAILQ_INSERT_HEAD(&monitoredItem->queue, newvalue, listEntry);
+    monitoredItem->queueSize.currentValue++;
+    monitoredItem->lastSampled = UA_DateTime_now();
 }
 
 /*********************************** amalgamated original file "/home/jpfr/software/open62541/src/server/ua_subscription_manager.c" ***********************************/
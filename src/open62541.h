@@ -1041,6 +1041,47 @@ UA_Array_copy(const void *src, size_t src_size, void **dst,
  */
 void UA_EXPORT UA_Array_delete(void *p, size_t size, const UA_DataType *type);
 
+/*****************/
+/* Lazy Decoding */
+/*****************/
+
+/* In lazy mode, the binary decoding keeps variants (except for scalars of a
+ * fixed size) and the bodies of extension objects encoded. Such a variant has
+ * the type UA_ENCODEDVARIANT and its data is a UA_ByteString with the complete
+ * encoding of the variant. It is encoded again as is. */
+extern UA_EXPORT const UA_DataType UA_ENCODEDVARIANT;
+
+/* Sets the lazy mode of the calling thread and returns the previous mode.
+ * Other threads, e.g. a server iterated in the background, are not affected. */
+UA_Boolean UA_EXPORT UA_setLazyDecoding(UA_Boolean lazy);
+
+/* Decode a value that was kept encoded in place. Values that are decoded
+ * already are left as they are. The variant is unchanged when an error is
+ * returned. */
+UA_StatusCode UA_EXPORT UA_Variant_decodeLazy(UA_Variant *v);
+UA_StatusCode UA_EXPORT UA_ExtensionObject_decodeLazy(UA_ExtensionObject *eo);
+
+/**********************/
+/* Data Type Registry */
+/**********************/
+
+/* Extension objects (also inside variants) are decoded if the NodeId of their
+ * binary encoding is in the registry. The ns0 types are always registered.
+ * Registered types are encoded with the given encoding id (which is copied).
+ * Registrations are permanent, so the type has to remain valid. The registry is
+ * not synchronized, register types before they are used from other threads. */
+UA_StatusCode UA_EXPORT
+UA_registerDataType(const UA_DataType *type, const UA_NodeId *binaryEncodingId);
+
+/* Indexes the ns0 types and compiles their codec programs. The ua module calls
+ * it when it is loaded. Otherwise it is done on first use, so call it before
+ * the codec is used from several threads. */
+UA_StatusCode UA_EXPORT UA_initDataTypeRegistry(void);
+
+/* Returns NULL if no type is registered for the encoding */
+const UA_DataType UA_EXPORT *
+UA_findDataTypeByBinaryEncoding(const UA_NodeId *binaryEncodingId);
+
 /**********************/
 /* Node Attribute Ids */
 /**********************/
@@ -4377,6 +4418,24 @@ typedef struct {
      */
     UA_StatusCode (*write)(void *handle, const UA_NodeId nodeid,
                            const UA_Variant *data, const UA_NumericRange *range);
+
+    /**
+     * Optional. Service_Read reads the Value attribute of all nodes whose data sources have
+     * the same readBatch and batchHandle with a single call. Other reads use the read member.
+     *
+     * @param batchHandle The batchHandle shared by the data sources
+     * @param size The number of read nodes
+     * @param handles The handles of the data sources
+     * @param nodeIds Ids of the read nodes
+     * @param includeSourceTimeStamp As for read
+     * @param ranges The index ranges of the nodes, NULL entries read the complete value
+     * @param values The (non-null) DataValues that are returned to the client
+     * @return Returns a status code that is set in all values if it is not good.
+     */
+    void *batchHandle;
+    UA_StatusCode (*readBatch)(void *batchHandle, size_t size, void * const *handles,
+                               const UA_NodeId *nodeIds, UA_Boolean includeSourceTimeStamp,
+                               const UA_NumericRange * const *ranges, UA_DataValue * const *values);
 } UA_DataSource;
 
 UA_StatusCode UA_EXPORT
@@ -4529,6 +4588,28 @@ UA_Server_addMethodNode(UA_Server *server, const UA_NodeId requestedNewNodeId,
                         size_t inputArgumentsSize, const UA_Argument* inputArguments, 
                         size_t outputArgumentsSize, const UA_Argument* outputArguments,
                         UA_NodeId *outNewNodeId);
+
+/**
+ * A method callback can defer its result. It calls UA_Server_deferMethodCall
+ * and returns UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY. The CallRequest is
+ * then parked and the CallResponse is sent when all deferred methods of the
+ * request are finished. Methods that are not finished within the timeout (in
+ * ms) return UA_STATUSCODE_BADTIMEOUT.
+ *
+ * @return The id of the deferred call or 0 if not called from a method callback.
+ */
+UA_UInt32 UA_EXPORT
+UA_Server_deferMethodCall(UA_Server *server, UA_UInt32 timeout);
+
+/** The result of a deferred call for the output arguments, or NULL if the call
+    was already answered (e.g. after a timeout). */
+UA_CallMethodResult UA_EXPORT *
+UA_Server_getDeferredMethodCall(UA_Server *server, UA_UInt32 id);
+
+/** Sets the status of a deferred call and sends the response once the request
+    has no more deferred calls. Unknown ids are ignored. */
+void UA_EXPORT
+UA_Server_finishMethodCall(UA_Server *server, UA_UInt32 id, UA_StatusCode status);
 #endif
 
 /*************************/
@@ -4911,6 +4992,13 @@ void UA_EXPORT
 __UA_Client_Service(UA_Client *client, const void *request, const UA_DataType *requestType,
                     void *response, const UA_DataType *responseType);
 
+/* The response is decoded into an arena of the allocator (libua_alloc.c) that
+   is released at once by the caller. Do not call UA_deleteMembers on it. */
+struct ua_arena;
+void UA_EXPORT
+__UA_Client_ServiceArena(UA_Client *client, const void *request, const UA_DataType *requestType,
+                         void *response, const UA_DataType *responseType, struct ua_arena *arena);
+
 /* NodeManagement Service Set */
 
 /**
@@ -17,6 +17,27 @@
 #include "libua.h"
 
 
+#if defined(UASCRIPT_GLOBAL_LOCK)
+#include <pthread.h>
+
+/*
+** The global lock of the Lua core (see luaconf.h). The core releases it
+** while C functions run, so that a ua server thread can call into Lua.
+*/
+static pthread_mutex_t uascript_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void uascript_lock (lua_State *L) {
+  (void)L;
+  pthread_mutex_lock(&uascript_mutex);
+}
+
+void uascript_unlock (lua_State *L) {
+  (void)L;
+  pthread_mutex_unlock(&uascript_mutex);
+}
+#endif
+
+
 #if !defined(LUA_PROMPT)
 #define LUA_PROMPT		"> "
 #define LUA_PROMPT2		">> "